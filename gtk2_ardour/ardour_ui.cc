@@ -1353,8 +1353,13 @@ ARDOUR_UI::update_peak_thread_work ()
 		const char* const bg = c > 2 ? " background=\"red\" foreground=\"white\"" : "";
 		snprintf (buf, sizeof (buf), "<span %s>%d</span>", bg, c);
 		peak_thread_work_label.set_markup (label + buf);
+
+		int done, total;
+		SourceFactory::peak_work_progress (done, total);
+		ArdourWidgets::set_tooltip (peak_thread_work_label, string_compose (_("Building peakfiles: %1 of %2 done"), done, total));
 	} else {
 		peak_thread_work_label.set_markup (X_(""));
+		ArdourWidgets::set_tooltip (peak_thread_work_label, X_(""));
 	}
 }
 
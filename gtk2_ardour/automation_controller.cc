@@ -124,7 +124,7 @@ AutomationController::AutomationController(boost::shared_ptr<AutomationControl>
 	_adjustment->signal_value_changed().connect(
 		sigc::mem_fun(*this, &AutomationController::value_adjusted));
 
-	ac->Changed.connect (_changed_connections, invalidator (*this), boost::bind (&AutomationController::display_effective_value, this), gui_context());
+	ac->Changed.connect_coalesced (_changed_connections, invalidator (*this), boost::bind (&AutomationController::display_effective_value, this), gui_context());
 	display_effective_value ();
 
 	if (ac->alist ()) {
@@ -2318,6 +2318,36 @@ RCOptionEditor::RCOptionEditor ()
 		procs->set_note (string_compose (_("This setting will only take effect when %1 is restarted."), PROGRAM_NAME));
 
 		add_option (_("General"), procs);
+
+		ComboOption<uint32_t>* spin = new ComboOption<uint32_t> (
+				"dsp-thread-spin-usecs",
+				_("Idle DSP threads wait for work"),
+				sigc::mem_fun (*_rc_config, &RCConfiguration::get_dsp_thread_spin_usecs),
+				sigc::mem_fun (*_rc_config, &RCConfiguration::set_dsp_thread_spin_usecs)
+				);
+
+		spin->add (0, _("sleeping"));
+		spin->add (10, _("polling up to 10 microseconds"));
+		spin->add (25, _("polling up to 25 microseconds"));
+		spin->add (50, _("polling up to 50 microseconds"));
+		spin->add (100, _("polling up to 100 microseconds"));
+		spin->add (250, _("polling up to 250 microseconds"));
+
+		Gtkmm2ext::UI::instance()->set_tip (spin->tip_widget(),
+				_("Polling for work reduces the wake-up latency of DSP threads at very small buffer sizes, at the cost of some CPU usage. Polling is limited to a quarter of the process cycle."));
+
+		add_option (_("General"), spin);
+
+		EntryOption* cpus = new EntryOption (
+				"dsp-thread-cpus",
+				_("Restrict DSP threads to CPU cores"),
+				sigc::mem_fun (*_rc_config, &RCConfiguration::get_dsp_thread_cpus),
+				sigc::mem_fun (*_rc_config, &RCConfiguration::set_dsp_thread_cpus)
+				);
+
+		cpus->set_note (string_compose (_("List of CPU cores, e.g. \"2-5,8\". Leave empty to use all cores.\nThis setting will only take effect when %1 is restarted."), PROGRAM_NAME));
+
+		add_option (_("General"), cpus);
 	}
 
 	/* Image cache size */
@@ -2423,6 +2453,16 @@ RCOptionEditor::RCOptionEditor ()
 		     sigc::mem_fun (*_rc_config, &RCConfiguration::set_verify_remove_last_capture)
 		     ));
 
+	bo = new BoolOption (
+		     "save-binary-midi-history",
+		     _("Save MIDI edit history in compact form"),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::get_save_binary_midi_history),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::set_save_binary_midi_history)
+		     );
+	add_option (_("General/Session"), bo);
+	Gtkmm2ext::UI::instance()->set_tip (bo->tip_widget(),
+			_("When enabled, MIDI note edits in the undo history are saved in a compact binary form, which is faster to save and load. Sessions saved this way cannot load their MIDI edit history in older versions of Ardour."));
+
 	add_option (_("General/Session"), new OptionEditorHeading (_("Session Management")));
 
 	add_option (_("General/Session"),
@@ -2985,6 +3025,41 @@ RCOptionEditor::RCOptionEditor ()
 
 	add_option (_("Audio"), new BufferingOptions (_rc_config));
 
+	ComboOption<uint32_t>* bt = new ComboOption<uint32_t> (
+			"butler-threads",
+			_("Disk I/O threads"),
+			sigc::mem_fun (*_rc_config, &RCConfiguration::get_butler_threads),
+			sigc::mem_fun (*_rc_config, &RCConfiguration::set_butler_threads)
+			);
+
+	bt->add (1, _("1"));
+	bt->add (2, _("2"));
+	bt->add (4, _("4"));
+	bt->add (8, _("8"));
+
+	Gtkmm2ext::UI::instance()->set_tip (bt->tip_widget(),
+			_("Number of threads that read and write track data. Tracks are grouped by the disk that holds their files. More threads can help with many tracks on fast (SSD/NVMe) or multiple disks."));
+	bt->set_note (_("This setting will only take effect when a session is loaded."));
+
+	add_option (_("Audio"), bt);
+
+	ComboOption<uint32_t>* lc = new ComboOption<uint32_t> (
+			"loop-cache-mbytes",
+			_("Loop and punch range cache"),
+			sigc::mem_fun (*_rc_config, &RCConfiguration::get_loop_cache_mbytes),
+			sigc::mem_fun (*_rc_config, &RCConfiguration::set_loop_cache_mbytes)
+			);
+
+	lc->add (0, _("off"));
+	lc->add (64, _("64 MB"));
+	lc->add (256, _("256 MB"));
+	lc->add (1024, _("1 GB"));
+
+	Gtkmm2ext::UI::instance()->set_tip (lc->tip_widget(),
+			_("Keep the audio that is played in the loop and punch ranges in memory, so that it does not have to be read from disk every time the range is repeated."));
+
+	add_option (_("Audio"), lc);
+
 	add_option (_("Audio"), new OptionEditorHeading (_("Denormals")));
 
 	add_option (_("Audio"),
@@ -3605,6 +3680,22 @@ RCOptionEditor::RCOptionEditor ()
 	Gtkmm2ext::UI::instance()->set_tip (lna->tip_widget(),
 					    _("Some Plugins expose an unreasonable amount of control-inputs. This option limits the number of parameters that can are listed as automatable without restricting the number of total controls.\n\nThis reduces lag in the GUI and shortens excessively long drop-down lists for plugins with a large number of control ports.\n\nNote: This only affects newly added plugins and is applied to plugin on session-reload. Already automated parameters are retained."));
 
+	ComboOption<uint32_t>* amb = new ComboOption<uint32_t> (
+		     "plugin-automation-min-block",
+		     _("Plugin automation resolution"),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::get_plugin_automation_min_block),
+		     sigc::mem_fun (*_rc_config, &RCConfiguration::set_plugin_automation_min_block)
+		     );
+	amb->add (0,   _("Sample accurate"));
+	amb->add (16,  _("16 samples"));
+	amb->add (32,  _("32 samples"));
+	amb->add (64,  _("64 samples"));
+	amb->add (128, _("128 samples"));
+	amb->add (256, _("256 samples"));
+	add_option (_("Plugins"), amb);
+	Gtkmm2ext::UI::instance()->set_tip (amb->tip_widget(),
+					    _("Plugins are run in several parts per process cycle, so that automation events are applied exactly at the sample they occur. This option sets the smallest part: automation events closer than this to the previous one are delayed, which reduces the overhead of plugins with dense automation."));
+
 #if (defined WINDOWS_VST_SUPPORT || defined MACVST_SUPPORT || defined LXVST_SUPPORT || defined VST3_SUPPORT)
 	add_option (_("Plugins/VST"), new OptionEditorHeading (_("VST")));
 #if 0
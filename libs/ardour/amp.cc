@@ -112,12 +112,23 @@ Amp::run (BufferSet& bufs, samplepos_t /*start_sample*/, samplepos_t /*end_sampl
 		const gain_t a = 156.825f / (gain_t)_session.nominal_sample_rate(); // 25 Hz LPF; see Amp::apply_gain for details
 		gain_t lpf = _current_gain;
 
-		for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
-			Sample* const sp = i->data();
-			lpf = _current_gain;
+		if (bufs.count().n_audio() > 0) {
+			/* The de-zipper is a serial recurrence: run it once, in place,
+			 * turning the automation curve into the per-sample gain that is
+			 * applied, then scale all channels with a plain (vectorizable)
+			 * multiply instead of repeating the filter for every channel.
+			 */
 			for (pframes_t nx = 0; nx < nframes; ++nx) {
-				sp[nx] *= lpf;
+				const gain_t g = lpf;
 				lpf += a * (gab[nx] - lpf);
+				gab[nx] = g;
+			}
+
+			for (BufferSet::audio_iterator i = bufs.audio_begin(); i != bufs.audio_end(); ++i) {
+				Sample* const sp = i->data();
+				for (pframes_t nx = 0; nx < nframes; ++nx) {
+					sp[nx] *= gab[nx];
+				}
 			}
 		}
 
@@ -44,6 +44,7 @@ public:
 	AudioPlaylist (boost::shared_ptr<const AudioPlaylist>, samplepos_t start, samplecnt_t cnt, std::string name, bool hidden = false);
 
 	samplecnt_t read (Sample *dst, Sample *mixdown, float *gain_buffer, samplepos_t start, samplecnt_t cnt, uint32_t chan_n=0);
+	void prefetch (samplepos_t start, samplecnt_t cnt);
 
 	bool destroy_region (boost::shared_ptr<Region>);
 
@@ -54,6 +55,21 @@ protected:
 	void pre_uncombine (std::vector<boost::shared_ptr<Region> >&, boost::shared_ptr<Region>);
 
 private:
+	struct Segment;
+	struct ReadPlan;
+
+	void plan_segments (RegionList const&, samplepos_t start, samplepos_t end, bool solo_selection, std::vector<Segment>&);
+	boost::shared_ptr<ReadPlan const> read_plan (samplepos_t start, samplepos_t end);
+
+	boost::shared_ptr<ReadPlan const> _read_plan;
+	Glib::Threads::Mutex              _read_plan_lock;
+
+	class ReadHits;
+	friend class ReadHits;
+
+	std::vector<uint32_t>             _read_hits;
+	Glib::Threads::Mutex              _read_hits_lock;
+
 	int set_state (const XMLNode&, int version);
 	void dump () const;
 	bool region_changed (const PBD::PropertyChange&, boost::shared_ptr<Region>);
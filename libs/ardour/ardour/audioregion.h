@@ -122,6 +122,8 @@ class LIBARDOUR_API AudioRegion : public Region
 	                                    samplepos_t position, samplecnt_t cnt,
 	                                    uint32_t chan_n=0) const;
 
+	void prefetch (samplepos_t position, samplecnt_t cnt) const;
+
 	virtual samplecnt_t read_raw_internal (Sample*, samplepos_t, samplecnt_t, int channel) const;
 
 	XMLNode& state ();
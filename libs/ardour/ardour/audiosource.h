@@ -61,6 +61,13 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	virtual samplecnt_t read (Sample *dst, samplepos_t start, samplecnt_t cnt, int channel=0) const;
 	virtual samplecnt_t write (Sample *src, samplecnt_t cnt);
 
+	/** Hint that start...start+cnt will be read soon, so that the OS can
+	 *  start reading it into the page cache while other sources are being
+	 *  read. This does not read any data itself, read() still has to be
+	 *  called (and may block if the OS ignored the hint).
+	 */
+	void prefetch (samplepos_t start, samplecnt_t cnt) const;
+
 	virtual float sample_rate () const = 0;
 
 	virtual void mark_streaming_write_completed (const Lock& lock);
@@ -100,10 +107,17 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	int prepare_for_peakfile_writes ();
 	void done_with_peakfile_writes (bool done = true);
 
+	/** Build the coarser peak levels from the complete peakfile.
+	 *  Called by the peak builder threads.
+	 */
+	int build_peak_levels ();
+
 	/** @return true if the each source sample s must be clamped to -1 < s < 1 */
 	virtual bool clamped_at_unity () const = 0;
 
   protected:
+	friend class SourceBlockCache;
+
 	static bool _build_missing_peakfiles;
 	static bool _build_peakfiles;
 
@@ -116,10 +130,14 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	bool force, bool intermediate_peaks_ready_signal);
 	void truncate_peakfile();
 
+	static samplecnt_t peak_level_fpp (uint32_t level);
+	static void remove_peak_levels (std::string const& peakpath);
+
 	mutable off_t _peak_byte_max; // modified in compute_and_write_peak()
 
 	virtual samplecnt_t read_unlocked (Sample *dst, samplepos_t start, samplecnt_t cnt) const = 0;
 	virtual samplecnt_t write_unlocked (Sample *dst, samplecnt_t cnt) = 0;
+	virtual void prefetch_unlocked (samplepos_t /*start*/, samplecnt_t /*cnt*/) const {}
 	virtual std::string construct_peak_filepath (const std::string& audio_path, const bool in_session = false, const bool old_peak_name = false) const = 0;
 
 	virtual int read_peaks_with_fpp (PeakData *peaks,
@@ -131,6 +149,12 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 				     samplecnt_t samples_per_peak);
 
   private:
+	std::string peak_level_path (samplecnt_t fpp) const;
+	bool peak_level_available (uint32_t level) const;
+	bool peak_level_complete (samplecnt_t fpp) const;
+	bool peak_levels_valid () const;
+	void queue_peak_levels ();
+
 	bool _peaks_built;
 	/** This mutex is used to protect both the _peaks_built
 	 *  variable and also the emission (and handling) of the
@@ -140,6 +164,7 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	 */
         mutable Glib::Threads::Mutex _peaks_ready_lock;
         Glib::Threads::Mutex _initialize_peaks_lock;
+	Glib::Threads::Mutex _peak_levels_lock;
 
 	int        _peakfile_fd;
 	samplecnt_t peak_leftover_cnt;
@@ -151,6 +176,8 @@ class LIBARDOUR_API AudioSource : virtual public Source,
 	mutable double _last_scale;
 	mutable off_t _last_map_off;
 	mutable size_t  _last_raw_map_length;
+	mutable samplecnt_t _last_fpp;
+	mutable volatile gint _peak_levels; ///< bit n set if level n is available, -1 if not known
 	mutable boost::scoped_array<PeakData> peak_cache;
 };
 
@@ -114,6 +114,11 @@ public:
 	XMLNode& get_state ();
 	int set_state (const XMLNode &, int version);
 
+	/** Like get_state(), but re-uses the XML of the previous call while
+	 *  the list has not changed. The caller owns the returned node.
+	 */
+	XMLNode& get_cached_state ();
+
 	Command* memento_command (XMLNode* before, XMLNode* after);
 
 	bool operator!= (const AutomationList &) const;
@@ -132,15 +137,23 @@ private:
 	XMLNode& serialize_events (bool need_lock);
 
 	void maybe_signal_changed ();
+	void events_changed () const;
+	void mark_state_dirty () const { g_atomic_int_set (&_state_dirty, 1); }
 
 	AutoState    _state;
 	gint         _touching;
 
 	PBD::ScopedConnection _writepass_connection;
+	PBD::ScopedConnection _interpolation_connection;
 
 	bool operator== (const AutomationList&) const { /* not called */ abort(); return false; }
 	XMLNode* _before; //used for undo of touch start/stop pairs.
 
+	XMLNode*             _state_cache;
+	PBD::ID              _state_cache_id; ///< id() when _state_cache was made
+	mutable gint         _state_dirty;
+	Glib::Threads::Mutex _state_cache_lock;
+
 };
 
 } // namespace
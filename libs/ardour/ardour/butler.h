@@ -23,13 +23,19 @@
 #ifndef __ardour_butler_h__
 #define __ardour_butler_h__
 
+#include <map>
+#include <vector>
+
 #include <pthread.h>
 
+#include <boost/weak_ptr.hpp>
 #include <glibmm/threads.h>
 
 #include "pbd/crossthread.h"
+#include "pbd/id.h"
 #include "pbd/ringbuffer.h"
 #include "pbd/pool.h"
+#include "pbd/semutils.h"
 #include "ardour/libardour_visibility.h"
 #include "ardour/types.h"
 #include "ardour/session_handle.h"
@@ -38,11 +44,18 @@
 
 namespace ARDOUR {
 
+class Track;
+
 /**
  *  One of the Butler's functions is to clean up (ie delete) unused CrossThreadPools.
  *  When a thread with a CrossThreadPool terminates, its CTP is added to pool_trash.
  *  When the Butler thread wakes up, we check this trash buffer for CTPs, and if they
  *  are empty they are deleted.
+ *
+ *  With butler-threads > 1, the Butler thread hands parts of the track refill
+ *  and flush work to helper threads, and waits for them before it continues.
+ *  Tracks are grouped by the device that holds their files, and all tracks
+ *  of a device are handled by the same thread.
  */
 
 class LIBARDOUR_API Butler : public SessionHandleRef
@@ -91,11 +104,37 @@ class LIBARDOUR_API Butler : public SessionHandleRef
 	PBD::RingBuffer<CrossThreadPool*> pool_trash;
 
 private:
+	struct Worker;
+
+	enum Job {
+		Refill,
+		Flush
+	};
+
 	void empty_pool_trash ();
 	void config_changed (std::string);
 
+	bool refill_tracks (RouteList const&);
 	bool flush_tracks_to_disk_normal (boost::shared_ptr<RouteList>, uint32_t& errors);
 
+	bool run_job (Job, RouteList const&, uint32_t& errors);
+	void do_job (Worker&);
+	void assign_tracks (std::vector<boost::shared_ptr<Track> >&);
+	samplecnt_t refill_buffer_samples () const;
+	uint64_t track_device (boost::shared_ptr<Track>) const;
+
+	void start_workers (uint32_t);
+	void stop_workers ();
+	static void* _worker_thread (void*);
+	void*         worker_thread (Worker*);
+
+	std::vector<Worker*> _workers; ///< [0] is the butler thread itself
+	PBD::Semaphore       _workers_done;
+
+	/* device of each track's files, rebuilt when the route list changes */
+	boost::weak_ptr<RouteList>   _device_routes;
+	std::map<PBD::ID, uint64_t>  _track_device;
+
 	/**
 	 * Add request to butler thread request queue
 	 */
@@ -79,9 +79,20 @@ public:
 	 */
 	int do_refill ();
 
+	/** As do_refill(), for additional butler threads which have their own working buffers */
+	int do_refill (Sample* sum_buffer, Sample* mixdown_buffer, gain_t* gain_buffer);
+
 	/** For contexts outside the normal butler refill loop (allocates temporary working buffers) */
 	int do_refill_with_alloc (bool partial_fill, bool reverse);
 
+	/* called by the Butler for all tracks before any of them are refilled,
+	 * to hint the OS at the data of the next do_refill() or seek(), so that
+	 * it can read ahead for all tracks concurrently. The refill itself still
+	 * uses synchronous reads.
+	 */
+	void prefetch ();
+	void prefetch_seek (samplepos_t sample);
+
 	bool pending_overwrite () const;
 
 	/* Working buffers for do_refill (butler thread) */
@@ -229,6 +240,8 @@ private:
 
 	int refill (Sample* sum_buffer, Sample* mixdown_buffer, float* gain_buffer, samplecnt_t fill_level, bool reversed);
 	int refill_audio (Sample* sum_buffer, Sample* mixdown_buffer, float* gain_buffer, samplecnt_t fill_level, bool reversed);
+	samplecnt_t refill_chunk_samples (samplecnt_t total_space) const;
+	void prefetch_audio (samplepos_t start, samplecnt_t cnt, bool reversed);
 
 	sampleoffset_t calculate_playback_distance (pframes_t);
 
@@ -32,6 +32,7 @@
 
 #include "pbd/mpmc_queue.h"
 #include "pbd/semutils.h"
+#include "pbd/work_stealing_deque.h"
 
 #include "ardour/audio_backend.h"
 #include "ardour/libardour_visibility.h"
@@ -52,12 +53,41 @@ typedef boost::shared_ptr<GraphNode> node_ptr_t;
 typedef std::list<node_ptr_t> node_list_t;
 typedef std::set<node_ptr_t>  node_set_t;
 
+/** Scheduler statistics of the most recently completed process cycle */
+struct LIBARDOUR_API GraphStats {
+	GraphStats ()
+		: n_nodes (0)
+		, n_threads (0)
+		, critical_path (0)
+		, critical_path_usec (0)
+		, local_runs (0)
+		, queue_runs (0)
+		, steals (0)
+		, failed_steals (0)
+		, idle_waits (0)
+		, spin_hits (0)
+		, spin_misses (0)
+	{}
+
+	uint32_t n_nodes;            ///< number of nodes in the graph
+	uint32_t n_threads;          ///< number of DSP threads executing the graph
+	uint32_t critical_path;      ///< longest chain of dependent nodes
+	float    critical_path_usec; ///< estimated processing time of the most expensive chain
+	uint32_t local_runs;         ///< nodes taken from the worker's own deque
+	uint32_t queue_runs;         ///< initial nodes taken from the shared queue
+	uint32_t steals;             ///< nodes stolen from another worker's deque
+	uint32_t failed_steals;      ///< steal attempts that lost a race
+	uint32_t idle_waits;         ///< number of times a worker went to sleep
+	uint32_t spin_hits;          ///< idle workers that found work while polling
+	uint32_t spin_misses;        ///< idle workers that stopped polling because of a timeout
+};
+
 class LIBARDOUR_API Graph : public SessionHandleRef
 {
 public:
 	Graph (Session& session);
 
-	void trigger (GraphNode* n);
+	void trigger (GraphNode* n, uint32_t tid);
 	void rechain (boost::shared_ptr<RouteList>, GraphEdges const&);
 	bool plot (std::string const& file_name) const;
 
@@ -73,25 +103,67 @@ public:
 	void process_one_route (Route* route);
 
 	void clear_other_chain ();
+	void update_priorities ();
+
+	/** @return true if the process thread asks for update_priorities() to be called */
+	bool priority_update_pending () const { return g_atomic_int_get (&_priority_update_pending) != 0; }
 
 	bool in_process_thread () const;
 
+	void stats (GraphStats&) const;
+
 protected:
 	virtual void session_going_away ();
 
 private:
 	void reset_thread_list ();
 	void drop_threads ();
-	void run_one ();
+	void run_one (uint32_t tid);
 	void main_thread ();
 	void prep ();
 	void dump (int chain) const;
+	bool find_work (uint32_t tid, GraphNode*&);
+	bool spin_for_work (uint32_t tid, GraphNode*&);
+	void set_thread_affinity (uint32_t tid);
+	void collect_stats ();
+	void compute_priorities (int chain);
+	bool costs_changed (int chain) const;
+
+	struct NodePriorityCmp;
 
 	node_list_t _nodes_rt[2];
 	node_list_t _init_trigger_list[2];
 
-	PBD::MPMCQueue<GraphNode*> _trigger_queue;      ///< nodes that can be processed
-	volatile guint             _trigger_queue_size; ///< number of entries in trigger-queue
+	/** Per DSP-thread state: nodes that were triggered by the given thread
+	 * are pushed to its own deque (their input buffers are likely still
+	 * in this CPU's cache), idle threads steal from other deques.
+	 */
+	struct Worker {
+		PBD::WorkStealingDeque<GraphNode*> deque;
+
+		uint32_t local_runs;
+		uint32_t queue_runs;
+		uint32_t steals;
+		uint32_t failed_steals;
+		uint32_t idle_waits;
+		uint32_t spin_hits;
+		uint32_t spin_misses;
+
+		/** current time limit for polling, adapts to the workload */
+		gint64 spin_usecs;
+
+		void reset_stats () {
+			local_runs = queue_runs = steals = failed_steals = idle_waits = spin_hits = spin_misses = 0;
+		}
+	};
+
+	std::vector<Worker*> _workers;
+
+	/** CPU cores that DSP threads are restricted to (if any) */
+	std::vector<int> _thread_cpus;
+
+	PBD::MPMCQueue<GraphNode*> _trigger_queue;      ///< initial nodes that can be processed
+	volatile guint             _trigger_queue_size; ///< number of entries in trigger-queue and all worker deques
 
 	/** Start worker threads */
 	PBD::Semaphore _execution_sem;
@@ -110,6 +182,20 @@ private:
 	guint _n_terminal_nodes[2];
 	bool  _graph_empty;
 
+	/** Maximum time that idle threads poll for work before going to sleep */
+	gint64 _max_spin_usecs;
+
+	/** Number of nodes and longest chain of dependent nodes (for each chain) */
+	guint _n_nodes[2];
+	guint _critical_path[2];
+	float _critical_path_cost[2];
+	GraphStats _stats;
+
+	/** Set periodically by the process thread, to re-evaluate
+	 * node priorities using the measured cost of each node */
+	volatile gint _priority_update_pending;
+	gint64        _last_priority_update;
+
 	/* number of background worker threads >= 0 */
 	volatile guint _n_workers;
 
@@ -27,6 +27,8 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <stdint.h>
+
 namespace ARDOUR
 {
 class Graph;
@@ -42,8 +44,14 @@ protected:
 	friend class Graph;
 	/** Nodes that we directly feed */
 	node_set_t _activation_set[2];
+	/** Nodes that we directly feed, in order of ascending priority */
+	std::vector<GraphNode*> _activation_list[2];
 	/** The number of nodes that we directly feed us (one count for each chain) */
 	gint _init_refcount[2];
+	/** Estimated time (in usec) needed to process this node and all nodes that depend on it */
+	float _priority[2];
+	/** The cost of this node that was used to calculate its priority */
+	float _planned_cost[2];
 };
 
 /** A node on our processing graph, ie a Route */
@@ -54,22 +62,33 @@ public:
 	virtual ~GraphNode ();
 
 	void prep (int chain);
-	void trigger ();
+	void trigger (uint32_t tid);
+
+	void run (int chain, uint32_t tid);
 
-	void
-	run (int chain)
-	{
-		process ();
-		finish (chain);
+	/** @return average time (in usec) that it took to process this node */
+	float cost () const {
+		CostBits c;
+		c.i = g_atomic_int_get (&_cost);
+		return c.f;
 	}
 
 private:
-	void finish (int chain);
+	void finish (int chain, uint32_t tid);
 	void process ();
 
 	boost::shared_ptr<Graph> _graph;
 
-	gint _refcount;
+	/* the cost is written by the process thread running this node and read
+	 * by other threads. Store the float's bits in a gint so that it can be
+	 * accessed atomically */
+	union CostBits {
+		gint  i;
+		float f;
+	};
+
+	gint          _refcount;
+	volatile gint _cost;
 };
 }
 
@@ -136,6 +136,8 @@ public:
 	typedef iterator_base< MidiBuffer, Evoral::Event<TimeType> >             iterator;
 	typedef iterator_base< const MidiBuffer, const Evoral::Event<TimeType> > const_iterator;
 
+	bool merge_in_place (const_iterator const & first, const_iterator const & last);
+
 	iterator begin() { return iterator(*this, 0); }
 	iterator end()   { return iterator(*this, _size); }
 
@@ -177,6 +179,8 @@ public:
 		return iterator (*this, i.offset);
 	}
 
+	iterator erase (const iterator& first, const iterator& last);
+
 	/**
 	 * returns true if the message with the second argument as its MIDI
 	 * status byte should preceed the message with the first argument as
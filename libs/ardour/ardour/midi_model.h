@@ -27,6 +27,7 @@
 #include <deque>
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include <boost/utility.hpp>
 #include <glibmm/threads.h>
@@ -129,15 +130,37 @@ public:
 
 		static Variant::Type value_type (Property prop);
 
+		/** A note property value, packed into 64 bits: ticks for
+		 * StartTime and Length, the integer value otherwise.
+		 */
+		class LIBARDOUR_API Value {
+		public:
+			Value () : _v (0) {}
+			Value (int32_t i) : _v (i) {}
+			Value (TimeType const & t) : _v (t.to_ticks ()) {}
+			Value (Variant const & v) : _v (v.type () == Variant::BEATS ? v.get_beats ().to_ticks () : v.get_int ()) {}
+
+			int32_t get_int () const { return (int32_t) _v; }
+			TimeType get_beats () const;
+			int64_t packed () const { return _v; }
+
+			static Value from_packed (int64_t v) { Value val; val._v = v; return val; }
+
+			bool operator== (Value const & other) const { return _v == other._v; }
+
+		private:
+			int64_t _v;
+		};
+
 		struct NoteChange {
 			NoteDiffCommand::Property property;
 			NotePtr note;
 			uint32_t note_id;
-			Variant old_value;
-			Variant new_value;
+			Value old_value;
+			Value new_value;
 		};
 
-		typedef std::list<NoteChange>                                    ChangeList;
+		typedef std::vector<NoteChange>                                  ChangeList;
 		typedef std::list< boost::shared_ptr< Evoral::Note<TimeType> > > NoteList;
 
 		const ChangeList& changes()       const { return _changes; }
@@ -156,6 +179,13 @@ public:
 
 		XMLNode &marshal_note(const NotePtr note);
 		NotePtr unmarshal_note(XMLNode *xml_note);
+
+		XMLNode& pack_changes (const char* name);
+		void unpack_changes (XMLNode const & node);
+		XMLNode& pack_notes (const char* name, NoteList const & notes);
+		void unpack_notes (XMLNode const & node, NoteList& notes);
+
+		void extend_range (TimeType& start, TimeType& end) const;
 	};
 
 	/* Currently this class only supports changes of sys-ex time, but could be expanded */
@@ -302,6 +332,14 @@ public:
 	PBD::Signal0<void> ContentsChanged;
 	PBD::Signal1<void, double> ContentsShifted;
 
+	/** Emit ContentsChanged for an edit that only affected [start, end] (model time) */
+	void contents_changed (TimeType const & start, TimeType const & end);
+
+	/** Get the range of the edit that ContentsChanged is currently signalling.
+	 * @return false if it is not known, i.e. anything in the model may have changed.
+	 */
+	bool edit_range (TimeType& start, TimeType& end) const;
+
 	boost::shared_ptr<const MidiSource> midi_source ();
 	void set_midi_source (boost::shared_ptr<MidiSource>);
 
@@ -351,6 +389,11 @@ private:
 	// We cannot use a boost::shared_ptr here to avoid a retain cycle
 	boost::weak_ptr<MidiSource> _midi_source;
 	InsertMergePolicy _insert_merge_policy;
+
+	/* only valid while contents_changed() emits ContentsChanged */
+	bool     _edit_range_valid;
+	TimeType _edit_start;
+	TimeType _edit_end;
 };
 
 } /* namespace ARDOUR */
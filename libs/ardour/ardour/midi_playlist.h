@@ -25,10 +25,16 @@
 
 #include <vector>
 #include <list>
+#include <map>
 
 #include <boost/utility.hpp>
 
+#include <glibmm/threads.h>
+
+#include "pbd/id.h"
+
 #include "evoral/Parameter.h"
+#include "evoral/Range.h"
 
 #include "ardour/ardour.h"
 #include "ardour/midi_cursor.h"
@@ -79,21 +85,51 @@ public:
 	bool destroy_region (boost::shared_ptr<Region>);
 	void _split_region (boost::shared_ptr<Region>, const MusicSample& position);
 
-	void set_note_mode (NoteMode m) { _note_mode = m; }
+	void set_note_mode (NoteMode m);
 
 	std::set<Evoral::Parameter> contained_automation();
 
   protected:
 	void remove_dependents (boost::shared_ptr<Region> region);
 	void region_going_away (boost::weak_ptr<Region> region);
+	bool region_changed (const PBD::PropertyChange&, boost::shared_ptr<Region>);
 
   private:
 	void dump () const;
+	void tempo_map_changed ();
+
+	void render_all_regions (std::vector< boost::shared_ptr<Region> > const &, MidiChannelFilter*);
+	void render_dirty_ranges (std::vector< boost::shared_ptr<Region> > const &, MidiChannelFilter*, Evoral::RangeList<samplepos_t>&);
 
 	NoteMode     _note_mode;
 	samplepos_t  _read_end;
 
 	RTMidiBuffer _rendered;
+
+	/** What render() last saw of a region */
+	struct RenderedRegion {
+		samplepos_t position;
+		samplecnt_t length;
+		samplepos_t start;
+		bool        audible;
+
+		bool operator!= (RenderedRegion const & other) const {
+			return position != other.position || length != other.length || start != other.start || audible != other.audible;
+		}
+	};
+
+	typedef std::map<PBD::ID, RenderedRegion> RenderedRegions;
+
+	/* state of the last render, only used by render() */
+	RenderedRegions _rendered_regions;
+	uint32_t        _rendered_filter;
+
+	/* spans of _rendered that need to be rendered again */
+	Glib::Threads::Mutex            _dirty_lock;
+	Evoral::RangeList<samplepos_t>  _dirty;
+	bool                            _render_all;
+
+	PBD::ScopedConnection _tempo_map_connection;
 };
 
 } /* namespace ARDOUR */
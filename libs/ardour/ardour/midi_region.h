@@ -123,6 +123,22 @@ class LIBARDOUR_API MidiRegion : public Region
 	            NoteMode                        mode,
 	            MidiChannelFilter*              filter) const;
 
+	/** Render only the events within [from, to] (session samples), as
+	 * render() would produce them.
+	 */
+	int render_range (Evoral::EventSink<samplepos_t>& dst,
+	                  uint32_t                        chan_n,
+	                  NoteMode                        mode,
+	                  MidiChannelFilter*              filter,
+	                  samplepos_t                     from,
+	                  samplepos_t                     to) const;
+
+	/** Get the span (session samples) affected by the contents change that
+	 * is currently being signalled.
+	 * @return false if it is not known, i.e. the whole region may have changed.
+	 */
+	bool contents_change_range (samplepos_t& from, samplepos_t& to) const;
+
   protected:
 
 	virtual bool can_trim_start_before_source_start () const {
@@ -178,6 +194,11 @@ class LIBARDOUR_API MidiRegion : public Region
 	PBD::ScopedConnection _source_connection;
 	PBD::ScopedConnection _model_contents_connection;
 	bool _ignore_shift;
+
+	/* only valid while model_contents_changed() sends the change */
+	bool        _contents_change_valid;
+	samplepos_t _contents_change_from;
+	samplepos_t _contents_change_to;
 };
 
 } /* namespace ARDOUR */
@@ -45,6 +45,25 @@ extern "C" {
 #endif
 }
 
+#ifdef FPU_AVX512F_SUPPORT
+extern "C" {
+/* AVX-512F functions */
+	LIBARDOUR_API float x86_avx512f_compute_peak          (const float * buf, uint32_t nsamples, float current);
+	LIBARDOUR_API void  x86_avx512f_find_peaks            (const float * buf, uint32_t nsamples, float *min, float *max);
+	LIBARDOUR_API void  x86_avx512f_apply_gain_to_buffer  (float * buf, uint32_t nframes, float gain);
+	LIBARDOUR_API void  x86_avx512f_mix_buffers_with_gain (float * dst, const float * src, uint32_t nframes, float gain);
+	LIBARDOUR_API void  x86_avx512f_mix_buffers_no_gain   (float * dst, const float * src, uint32_t nframes);
+	LIBARDOUR_API void  x86_avx512f_copy_vector           (float * dst, const float * src, uint32_t nframes);
+}
+#endif
+
+#ifdef FPU_AVX_FMA_SUPPORT
+extern "C" {
+/* AVX + FMA functions */
+	LIBARDOUR_API void  x86_fma_mix_buffers_with_gain     (float * dst, const float * src, uint32_t nframes, float gain);
+}
+#endif
+
 LIBARDOUR_API void  x86_sse_find_peaks     (const float * buf, uint32_t nsamples, float *min, float *max);
 #ifdef PLATFORM_WINDOWS
 LIBARDOUR_API void  x86_sse_avx_find_peaks (const float * buf, uint32_t nsamples, float *min, float *max);
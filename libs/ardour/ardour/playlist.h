@@ -57,6 +57,7 @@ namespace ARDOUR  {
 class Session;
 class Playlist;
 class Crossfade;
+class RegionIndex;
 
 namespace Properties {
 	/* fake the type, since regions are handled by SequenceProperty which doesn't
@@ -193,6 +194,18 @@ public:
 	 *  @return regions which have some part within this range.
 	 */
 	boost::shared_ptr<RegionList> regions_touched (samplepos_t start, samplepos_t end);
+
+	/** @return a counter that is incremented whenever regions are added or removed,
+	 *  or change their bounds, layering or any other property. Derived data that
+	 *  is expensive to compute can be cached until this changes.
+	 */
+	gint contents_generation () const { return g_atomic_int_get (&_contents_generation); }
+
+	/** Called by a region of this playlist whenever its properties change,
+	 *  also while its change signals are suspended (e.g. during a trim drag),
+	 *  so that the region index and derived data are never used while stale.
+	 */
+	void region_properties_changed (PBD::PropertyChange const&);
 	boost::shared_ptr<RegionList> regions_with_start_within (Evoral::Range<samplepos_t>);
 	boost::shared_ptr<RegionList> regions_with_end_within (Evoral::Range<samplepos_t>);
 	uint32_t                   region_use_count (boost::shared_ptr<Region>) const;
@@ -353,7 +366,13 @@ protected:
 
 	void _set_sort_id ();
 
-	boost::shared_ptr<RegionList> regions_touched_locked (samplepos_t start, samplepos_t end);
+	void regions_touched_locked (samplepos_t start, samplepos_t end, RegionList&);
+
+	/* Caller must hold the region lock */
+	boost::shared_ptr<RegionIndex const> region_index () const;
+	void invalidate_region_index ();
+
+	void bump_contents_generation () { g_atomic_int_inc (&_contents_generation); }
 
 	void notify_region_removed (boost::shared_ptr<Region>);
 	void notify_region_added (boost::shared_ptr<Region>);
@@ -430,10 +449,17 @@ private:
 private:
 	void setup_layering_indices (RegionList const &);
 	void coalesce_and_check_crossfades (std::list<Evoral::Range<samplepos_t> >);
-	boost::shared_ptr<RegionList> find_regions_at (samplepos_t);
+	void find_regions_at (samplepos_t, RegionList&);
 
 	samplepos_t _end_space;  //this is used when we are pasting a range with extra space at the end
 	bool _playlist_shift_active;
+
+	/* interval index of regions, (re)built on demand after regions were added, removed or changed bounds */
+	mutable boost::shared_ptr<RegionIndex> _region_index;
+	mutable Glib::Threads::Mutex           _region_index_lock;
+	mutable gint                           _region_index_dirty;
+
+	gint _contents_generation;
 };
 
 } /* namespace ARDOUR */
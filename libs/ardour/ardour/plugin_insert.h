@@ -200,6 +200,10 @@ public:
 	bool get_stats (uint64_t& min, uint64_t& max, double& avg, double& dev) const;
 	void clear_stats ();
 
+	/** Number of plugin calls per process cycle when running automation,
+	 * in the last cycle and the maximum since the last clear_stats() */
+	void get_automation_split_stats (uint32_t& last, uint32_t& peak) const;
+
 	/** A control that manipulates a plugin parameter (control port). */
 	struct PluginControl : public AutomationControl
 	{
@@ -210,11 +214,21 @@ public:
 
 		double get_value (void) const;
 		void catch_up_with_external_value (double val);
+		int set_state (XMLNode const&, int);
 		XMLNode& get_state();
 		std::string get_user_string() const;
 
+		/** Automation events of this control do not split the process
+		 * cycle into sub-blocks shorter than this (in samples).
+		 * -1: use the global plugin-automation-min-block setting,
+		 * 0: sample accurate.
+		 */
+		int32_t automation_min_block () const { return _automation_min_block; }
+		void set_automation_min_block (int32_t s) { _automation_min_block = s; }
+
 	private:
 		PluginInsert* _plugin;
+		int32_t       _automation_min_block;
 		void actually_set_value (double val, PBD::Controllable::GroupControlDisposition group_override);
 	};
 
@@ -402,6 +416,8 @@ private:
 	ChanMapping _thru_map; // out-idx <=  in-idx
 
 	void automate_and_run (BufferSet& bufs, samplepos_t start, samplepos_t end, double speed, pframes_t nframes);
+	bool find_next_block_event (double now, double end, Evoral::ControlEvent& next_event) const;
+	void update_automation_split_stats (gint splits);
 	void connect_and_run (BufferSet& bufs, samplepos_t start, samplecnt_t end, double speed, pframes_t nframes, samplecnt_t offset, bool with_auto);
 	void bypass (BufferSet& bufs, pframes_t nframes);
 	void inplace_silence_unconnected (BufferSet&, const PinMappings&, samplecnt_t nframes, samplecnt_t offset) const;
@@ -440,6 +456,8 @@ private:
 
 	PBD::TimingStats _timing_stats;
 	volatile gint _stat_reset;
+	volatile gint _automation_splits;
+	volatile gint _automation_splits_peak;
 
 	volatile gint _flush;
 };
@@ -95,6 +95,12 @@ CONFIG_VARIABLE (float, audio_capture_buffer_seconds, "capture-buffer-seconds",
 CONFIG_VARIABLE (float, audio_playback_buffer_seconds, "playback-buffer-seconds", 5.0)
 CONFIG_VARIABLE (float, midi_track_buffer_seconds, "midi-track-buffer-seconds", 1.0)
 CONFIG_VARIABLE (uint32_t, disk_choice_space_threshold,  "disk-choice-space-threshold", 57600000)
+CONFIG_VARIABLE (bool, disk_read_prefetch, "disk-read-prefetch", true)
+CONFIG_VARIABLE (uint32_t, butler_threads, "butler-threads", 1)
+CONFIG_VARIABLE (bool, mmap_audio_files, "mmap-audio-files", true)
+CONFIG_VARIABLE (uint32_t, loop_cache_mbytes, "loop-cache-mbytes", 0)
+CONFIG_VARIABLE (uint32_t, peak_builder_threads, "peak-builder-threads", 0)
+CONFIG_VARIABLE (uint32_t, peak_builder_threads_per_disk, "peak-builder-threads-per-disk", 2)
 CONFIG_VARIABLE (bool, auto_analyse_audio, "auto-analyse-audio", false)
 CONFIG_VARIABLE (float, transient_sensitivity, "transient-sensitivity", 50)
 CONFIG_VARIABLE (float, max_transport_speed, "max-transport-speed", 8.0)
@@ -195,6 +201,7 @@ CONFIG_VARIABLE (bool, hiding_groups_deactivates_groups, "hiding-groups-deactiva
 CONFIG_VARIABLE (bool, verify_remove_last_capture, "verify-remove-last-capture", true)
 CONFIG_VARIABLE (bool, save_history, "save-history", true)
 CONFIG_VARIABLE (int32_t, saved_history_depth, "save-history-depth", 20)
+CONFIG_VARIABLE (bool, save_binary_midi_history, "save-binary-midi-history", false)
 CONFIG_VARIABLE (int32_t, history_depth, "history-depth", 20)
 CONFIG_VARIABLE (RegionEquivalence, region_equivalence, "region-equivalency", LayerTime)
 CONFIG_VARIABLE (bool, periodic_safety_backups, "periodic-safety-backups", true)
@@ -209,6 +216,8 @@ CONFIG_VARIABLE_SPECIAL (std::string, default_session_parent_dir, "default-sessi
 #endif
 CONFIG_VARIABLE (bool, allow_special_bus_removal, "allow-special-bus-removal", false)
 CONFIG_VARIABLE (int32_t, processor_usage, "processor-usage", -1)
+CONFIG_VARIABLE (uint32_t, dsp_thread_spin_usecs, "dsp-thread-spin-usecs", 0) /* max time an idle DSP thread polls for work before sleeping, 0: disable */
+CONFIG_VARIABLE (std::string, dsp_thread_cpus, "dsp-thread-cpus", "") /* e.g. "2-5,8", empty: no CPU affinity */
 CONFIG_VARIABLE (gain_t, max_gain, "max-gain", 2.0) /* +6.0dB */
 CONFIG_VARIABLE (uint32_t, max_recent_sessions, "max-recent-sessions", 10)
 CONFIG_VARIABLE (uint32_t, max_recent_templates, "max-recent-templates", 10)
@@ -233,6 +242,7 @@ CONFIG_VARIABLE (bool, discover_audio_units, "discover-audio-units", false)
 CONFIG_VARIABLE (bool, ask_replace_instrument, "ask-replace-instrument", true)
 CONFIG_VARIABLE (bool, ask_setup_instrument, "ask-setup-instrument", true)
 CONFIG_VARIABLE (uint32_t, limit_n_automatables, "limit-n-automatables", 512)
+CONFIG_VARIABLE (uint32_t, plugin_automation_min_block, "plugin-automation-min-block", 0) /* samples, 0: sample accurate */
 
 /* custom user plugin paths */
 CONFIG_VARIABLE (std::string, plugin_path_vst, "plugin-path-vst", "@default@")
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __ardour_region_index_h__
+#define __ardour_region_index_h__
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class Region;
+
+/** An immutable interval index of the regions of a playlist.
+ *
+ * Regions are kept in a vector sorted by position, which is treated as
+ * an implicit balanced binary tree (the root of every sub-range is its
+ * middle element). Each node is augmented with the largest last-sample
+ * of its subtree, so that range queries are O(log n + k) and do not need
+ * to visit regions which end before the range of interest.
+ *
+ * The index only holds plain pointers, the owner (Playlist) has to
+ * guarantee that all regions outlive the index, or discard it when
+ * regions are removed or their bounds change.
+ */
+class LIBARDOUR_API RegionIndex
+{
+public:
+	RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end);
+
+	/** Replace the indexed regions, re-using the memory of the index */
+	void rebuild (RegionList::const_iterator begin, RegionList::const_iterator end);
+
+	size_t size () const { return _entries.size (); }
+	bool   empty () const { return _entries.empty (); }
+
+	/** Add regions which have some part within [start, end] to @param rl, in order of position */
+	void touched (samplepos_t start, samplepos_t end, RegionList& rl) const;
+
+	/** Add regions which have some part within [start, end] to @param rv, in order of position.
+	 * This does not allocate memory if @param rv has sufficient capacity.
+	 */
+	void touched (samplepos_t start, samplepos_t end, std::vector<Region*>& rv) const;
+
+	/** Add regions which start within [start, end] to @param rl, in order of position */
+	void starting_within (samplepos_t start, samplepos_t end, RegionList& rl) const;
+
+	/** Add regions which end within [start, end] to @param rl, in order of position */
+	void ending_within (samplepos_t start, samplepos_t end, RegionList& rl) const;
+
+	uint32_t count_at (samplepos_t) const;
+
+	/** @return the region on the top-most layer at the given position */
+	boost::shared_ptr<Region> top_at (samplepos_t, bool ignore_muted) const;
+
+	struct Entry {
+		Entry (Region*);
+		Entry (samplepos_t pos) : first (pos), last (pos), region (0) {}
+
+		samplepos_t first;
+		samplepos_t last;
+		Region*     region;
+	};
+
+private:
+	struct PositionCmp {
+		bool operator() (Entry const& a, Entry const& b) const {
+			return a.first < b.first;
+		}
+	};
+
+	samplepos_t augment (size_t lo, size_t hi);
+
+	template<typename Visitor>
+	void visit (size_t lo, size_t hi, samplepos_t start, samplepos_t end, Visitor&) const;
+
+	std::vector<Entry>       _entries;  ///< sorted by position
+	std::vector<samplepos_t> _max_last; ///< largest last sample in the subtree rooted at the given index
+};
+
+} /* namespace ARDOUR */
+
+#endif /* __ardour_region_index_h__ */
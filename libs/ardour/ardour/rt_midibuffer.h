@@ -28,9 +28,12 @@
 #include <glibmm/threads.h>
 
 #include "evoral/Event.h"
+#include "evoral/EventList.h"
 #include "evoral/EventSink.h"
 #include "ardour/types.h"
 
+class MidiPlaylistRenderTest;
+
 namespace ARDOUR {
 
 class MidiBuffer;
@@ -52,6 +55,11 @@ class LIBARDOUR_API RTMidiBuffer : public Evoral::EventSink<samplepos_t>
 	uint32_t write (TimeType time, Evoral::EventType type, uint32_t size, const uint8_t* buf);
 	uint32_t read (MidiBuffer& dst, samplepos_t start, samplepos_t end, MidiStateTracker& tracker, samplecnt_t offset = 0);
 
+	/** Replace all events within [from, to] by @param events, which
+	 * must be sorted and all lie within [from, to].
+	 */
+	void replace (TimeType from, TimeType to, Evoral::EventList<TimeType> const & events);
+
 	void dump (uint32_t);
 	void reverse ();
 	bool reversed() const;
@@ -66,6 +74,7 @@ class LIBARDOUR_API RTMidiBuffer : public Evoral::EventSink<samplepos_t>
 
   private:
 	friend struct WriteProtectRender;
+	friend class ::MidiPlaylistRenderTest;
 
 	struct Blob {
 		uint32_t size;
@@ -82,10 +91,15 @@ class LIBARDOUR_API RTMidiBuffer : public Evoral::EventSink<samplepos_t>
 	bool   _reversed;
 	/* secondary blob storage. Holds Blobs (arbitrary size + data) */
 
+	void encode (Item&, uint32_t size, const uint8_t* buf);
+
+	static uint32_t blob_space (uint32_t size);
 	uint32_t alloc_blob (uint32_t size);
 	uint32_t store_blob (uint32_t size, uint8_t const * data);
+	void compact_pool ();
 	uint32_t _pool_size;
 	uint32_t _pool_capacity;
+	uint32_t _pool_unused; /* bytes of _pool_size taken by blobs of replaced events */
 	uint8_t* _pool;
 
 	Glib::Threads::RWLock _lock;
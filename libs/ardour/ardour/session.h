@@ -135,6 +135,7 @@ class CoreSelection;
 class ExportHandler;
 class ExportStatus;
 class Graph;
+struct GraphStats;
 class IO;
 class IOProcessor;
 class ImportStatus;
@@ -165,6 +166,7 @@ class SessionDirectory;
 class SessionMetadata;
 class SessionPlaylists;
 class Source;
+class SourceBlockCache;
 class Speakers;
 class TempoMap;
 class TransportMaster;
@@ -304,6 +306,7 @@ public:
 
 	void refill_all_track_buffers ();
 	Butler* butler() { return _butler; }
+	SourceBlockCache* source_block_cache () const { return _source_block_cache; }
 	void butler_transport_work (bool have_process_lock = false);
 
 	void refresh_disk_space ();
@@ -341,6 +344,7 @@ public:
 	uint32_t nbusses () const;
 
 	bool plot_process_graph (std::string const& file_name) const;
+	bool process_graph_stats (GraphStats&) const;
 
 	boost::shared_ptr<BundleList> bundles () {
 		return _bundles.reader ();
@@ -1495,6 +1499,15 @@ private:
 	Glib::Threads::Mutex save_source_lock;
 	Glib::Threads::Mutex peak_cleanup_lock;
 
+	/* pending (crash recovery) state is written in the background */
+	Glib::Threads::Thread* _state_writer_thread;
+	Glib::Threads::Mutex   _state_writer_lock;
+
+	int  write_state_file (XMLTree&, std::string const& tmp_path, std::string const& xml_path);
+	void write_state_file_in_background (XMLTree*, std::string tmp_path, std::string xml_path);
+	void background_state_write (XMLTree*, std::string tmp_path, std::string xml_path);
+	void wait_for_state_writer ();
+
 	int        load_options (const XMLNode&);
 	int        load_state (std::string snapshot_name, bool from_template = false);
 	static int parse_stateful_loading_version (const std::string&);
@@ -1523,6 +1536,7 @@ private:
 	void try_run_lua (pframes_t);
 
 	Butler* _butler;
+	SourceBlockCache* _source_block_cache;
 
 	TransportFSM* _transport_fsm;
 
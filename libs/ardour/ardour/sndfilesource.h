@@ -70,6 +70,9 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 
 	bool clamped_at_unity () const;
 
+	/** @return true if reads are served from a memory map of the file */
+	bool mapped () const { return _map_data != 0; }
+
 	static const Source::Flag default_writable_flags;
 
 	static int get_soundfile_info (const std::string& path, SoundFileInfo& _info, std::string& error_msg);
@@ -81,14 +84,28 @@ class LIBARDOUR_API SndFileSource : public AudioFileSource {
 	void set_header_natural_position ();
 
 	samplecnt_t read_unlocked (Sample *dst, samplepos_t start, samplecnt_t cnt) const;
+	void prefetch_unlocked (samplepos_t start, samplecnt_t cnt) const;
 	samplecnt_t write_unlocked (Sample *dst, samplecnt_t cnt);
 	samplecnt_t write_float (Sample* data, samplepos_t pos, samplecnt_t cnt);
 
   private:
 	SNDFILE* _sndfile;
+	int _fd; ///< file descriptor used by _sndfile, -1 if closed
 	SF_INFO _info;
 	BroadcastInfo *_broadcast_info;
 
+	/* read-only, uncompressed files in native byte order are read via a memory map */
+	mutable void*          _map_addr;
+	mutable size_t         _map_length;
+	mutable uint8_t const* _map_data;         ///< start of the sample data in the map
+	mutable int            _map_sample_bytes; ///< 2, 3 or 4; 0 if not mapped
+	mutable bool           _map_float;
+	mutable bool           _map_tried;
+
+	bool map_file () const;
+	void unmap_file ();
+	samplecnt_t read_mapped (Sample *dst, samplepos_t start, samplecnt_t cnt) const;
+
 	void init_sndfile ();
 	int open();
 	int setup_broadcast_info (samplepos_t when, struct tm&, time_t);
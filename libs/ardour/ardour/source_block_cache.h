@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __ardour_source_block_cache_h__
+#define __ardour_source_block_cache_h__
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <boost/weak_ptr.hpp>
+#include <glibmm/threads.h>
+
+#include "pbd/id.h"
+
+#include "ardour/libardour_visibility.h"
+#include "ardour/types.h"
+
+namespace ARDOUR {
+
+class AudioSource;
+class Session;
+
+/** A cache of audio data read from sources, in blocks of block_samples.
+ *
+ * The blocks of all sources that the tracks play in the loop and punch
+ * ranges are pinned: the butler reads them in the background (update())
+ * and keeps them until the ranges or the playlists change. Blocks that are
+ * no longer pinned stay in the cache until they are evicted, least recently
+ * used first, to stay within the size that is set with the
+ * "loop-cache-mbytes" RC option.
+ *
+ * AudioSource::read() is served from the cache if all blocks it needs are
+ * present.
+ */
+class LIBARDOUR_API SourceBlockCache
+{
+public:
+	SourceBlockCache ();
+	~SourceBlockCache ();
+
+	struct Stats {
+		uint64_t hits;          ///< reads served from the cache
+		uint64_t misses;        ///< reads of pinned ranges that had to go to disk
+		size_t   blocks;        ///< blocks in the cache
+		size_t   pinned_blocks; ///< blocks that are pinned (whether in the cache or not)
+		size_t   bytes;         ///< memory used by blocks in the cache
+	};
+
+	static const samplecnt_t block_samples = 65536;
+
+	/** Copy start...start+cnt of @param src into @param dst.
+	 *  @return false if any part of that range is not in the cache.
+	 */
+	bool read (AudioSource const& src, Sample* dst, samplepos_t start, samplecnt_t cnt);
+
+	/** Pin the blocks used in the current loop and punch ranges, and read
+	 *  some of those that are missing. Called by the butler.
+	 *  @return true if there are more blocks to read.
+	 */
+	bool update (Session&);
+
+	/** Forget all blocks of @param src, e.g. because its gain changed.
+	 *  Pinned blocks are read again by the next update().
+	 */
+	void drop (AudioSource const& src);
+
+	void clear ();
+
+	Stats stats () const;
+	void reset_stats ();
+
+private:
+	typedef std::pair<PBD::ID, samplepos_t> BlockKey; ///< source, index of block
+	typedef std::map<BlockKey, boost::weak_ptr<AudioSource> > Pins;
+
+	struct Block {
+		Block () : pinned (false) {}
+		std::vector<Sample>            data;
+		bool                           pinned;
+		std::list<BlockKey>::iterator lru;
+	};
+
+	typedef std::map<BlockKey, Block*> Blocks;
+
+	mutable Glib::Threads::Mutex _lock;
+	volatile gint                _active;   ///< non-zero if the cache is enabled
+
+	Blocks              _blocks;
+	std::list<BlockKey> _lru;      ///< most recently used first
+	Pins                _pins;
+	Pins                _to_fill;  ///< pinned blocks that are not in the cache
+	size_t              _capacity; ///< in blocks
+	size_t              _n_pinned;
+	uint64_t            _signature;
+	uint64_t            _generation; ///< incremented by drop()
+	uint64_t            _hits;
+	uint64_t            _misses;
+
+	uint64_t signature (Session&) const;
+	void find_pins (Session&, size_t capacity, Pins&) const;
+	void set_pins (Pins const&);
+	void insert (BlockKey const&, std::vector<Sample>&);
+	void evict ();
+};
+
+} /* namespace ARDOUR */
+
+#endif /* __ardour_source_block_cache_h__ */
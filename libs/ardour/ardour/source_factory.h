@@ -40,8 +40,15 @@ class LIBARDOUR_API SourceFactory {
   public:
 	static void init ();
 
+	/** Emitted for every source that is created. A MIDI source that
+	 *  create() was asked to load asynchronously may not have its model
+	 *  yet, handlers must not use it before wait_for_midi_models().
+	 */
 	static PBD::Signal1<void,boost::shared_ptr<Source> > SourceCreated;
 
+	/** @param async true to build peakfiles and MIDI models in the background.
+	 *  Callers that need the MIDI models must call wait_for_midi_models().
+	 */
 	static boost::shared_ptr<Source> create (Session&, const XMLNode& node, bool async = false);
 	static boost::shared_ptr<Source> createSilent (Session&, const XMLNode& node,
 	                                               samplecnt_t nframes, float sample_rate);
@@ -64,12 +71,28 @@ class LIBARDOUR_API SourceFactory {
 		(DataType type, Session& s, boost::shared_ptr<Playlist> p, const PBD::ID& orig, const std::string& name,
 		 uint32_t chn, sampleoffset_t start, samplecnt_t len, bool copy, bool defer_peaks);
 
+	struct PeakBuildRequest {
+		PeakBuildRequest (boost::weak_ptr<AudioSource> s, uint64_t d, bool l = false) : source (s), device (d), levels_only (l) {}
+		boost::weak_ptr<AudioSource> source;
+		uint64_t                     device;      ///< disk that holds the source's file
+		bool                         levels_only; ///< only build the coarser peak levels
+	};
+
         static Glib::Threads::Cond                       PeaksToBuild;
         static Glib::Threads::Mutex                      peak_building_lock;
-	static std::list< boost::weak_ptr<AudioSource> > files_with_peaks;
+	static std::list<PeakBuildRequest>               files_with_peaks;
 
 	static int peak_work_queue_length ();
+	/** @param done number of peakfiles that were built since the queue was last empty
+	 *  @param total number of peakfiles that were queued since then
+	 */
+	static void peak_work_progress (int& done, int& total);
 	static int setup_peakfile (boost::shared_ptr<Source>, bool async);
+	/** Build the coarser peak levels of a source with a complete peakfile in the background */
+	static void queue_peak_levels (boost::shared_ptr<AudioSource>);
+
+	/** Block until all MIDI models queued by create() have been loaded */
+	static void wait_for_midi_models ();
 };
 
 }
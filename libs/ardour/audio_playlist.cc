@@ -154,60 +154,119 @@ struct ReadSorter {
 };
 
 /** A segment of region that needs to be read */
-struct Segment {
-	Segment (boost::shared_ptr<AudioRegion> r, Evoral::Range<samplepos_t> a) : region (r), range (a) {}
+struct AudioPlaylist::Segment {
+	Segment (AudioRegion const* r, Evoral::Range<samplepos_t> a) : region (r), range (a) {}
 
-	boost::shared_ptr<AudioRegion> region; ///< the region
-	Evoral::Range<samplepos_t> range;       ///< range of the region to read, in session samples
+	AudioRegion const* region;        ///< the region
+	Evoral::Range<samplepos_t> range; ///< range of the region to read, in session samples
 };
 
-/** @param start Start position in session samples.
- *  @param cnt Number of samples to read.
+/** The segments of regions that need to be read to fill a range of the
+ *  playlist, resolved for layering, opacity and fades, and an index to find
+ *  the ones that touch a given part of that range.
  */
-ARDOUR::samplecnt_t
-AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, samplepos_t start, samplecnt_t cnt, unsigned chan_n)
-{
-	DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("Playlist %1 read @ %2 for %3, channel %4, regions %5 mixdown @ %6 gain @ %7\n",
-							   name(), start, cnt, chan_n, regions.size(), mixdown_buffer, gain_buffer));
+struct AudioPlaylist::ReadPlan {
+	ReadPlan (gint g, samplepos_t s, samplepos_t e) : generation (g), start (s), end (e) {}
 
-	/* optimizing this memset() away involves a lot of conditionals
-	   that may well cause more of a hit due to cache misses
-	   and related stuff than just doing this here.
+	bool covers (samplepos_t s, samplepos_t e) const { return start <= s && e <= end; }
 
-	   it would be great if someone could measure this
-	   at some point.
+	void
+	build_index ()
+	{
+		by_start.resize (segments.size ());
+		for (uint32_t i = 0; i < segments.size (); ++i) {
+			by_start[i] = i;
+		}
+		std::sort (by_start.begin (), by_start.end (), StartCmp (segments));
 
-	   one way or another, parts of the requested area
-	   that are not written to by Region::region_at()
-	   for all Regions that cover the area need to be
-	   zeroed.
-	*/
+		max_to.resize (by_start.size ());
+		samplepos_t m = -1;
+		for (uint32_t i = 0; i < by_start.size (); ++i) {
+			m = max (m, segments[by_start[i]].range.to);
+			max_to[i] = m;
+		}
+	}
 
-	memset (buf, 0, sizeof (Sample) * cnt);
+	/** Add the segments touching start...end to @param to_do, in the same
+	 *  order in which they were planned (highest precedence first).
+	 *  @param hits scratch space, to avoid allocating on every read.
+	 */
+	void
+	segments_touched (samplepos_t start, samplepos_t end, vector<uint32_t>& hits, vector<Segment>& to_do) const
+	{
+		hits.clear ();
+
+		/* max_to is non-decreasing: skip all segments which, like every
+		 * segment before them, end before the range we are looking for */
+		for (vector<samplepos_t>::const_iterator i = lower_bound (max_to.begin (), max_to.end (), start); i != max_to.end (); ++i) {
+			uint32_t const n = by_start[i - max_to.begin ()];
+			if (segments[n].range.from > end) {
+				break;
+			}
+			if (segments[n].range.to >= start) {
+				hits.push_back (n);
+			}
+		}
 
-	/* this function is never called from a realtime thread, so
-	   its OK to block (for short intervals).
-	*/
+		std::sort (hits.begin (), hits.end ());
 
-	Playlist::RegionReadLock rl (this);
+		for (vector<uint32_t>::const_iterator i = hits.begin (); i != hits.end (); ++i) {
+			to_do.push_back (segments[*i]);
+		}
+	}
 
-	/* Find all the regions that are involved in the bit we are reading,
-	   and sort them by descending layer and ascending position.
-	*/
-	boost::shared_ptr<RegionList> all = regions_touched_locked (start, start + cnt - 1);
-	all->sort (ReadSorter ());
+	struct StartCmp {
+		StartCmp (vector<Segment> const& s) : segments (s) {}
+		bool operator() (uint32_t a, uint32_t b) const {
+			return segments[a].range.from < segments[b].range.from;
+		}
+		vector<Segment> const& segments;
+	};
+
+	gint                generation; ///< Playlist::contents_generation () this plan was made for
+	samplepos_t         start;      ///< first sample of the range this plan was made for
+	samplepos_t         end;        ///< last sample of the range this plan was made for
+	vector<Segment>     segments;   ///< in order of precedence
+	vector<uint32_t>    by_start;   ///< indices into segments, sorted by start
+	vector<samplepos_t> max_to;     ///< running maximum of the segment ends, in by_start order
+};
+
+/** Scratch space for ReadPlan::segments_touched(). Uses the playlist's
+ *  vector, unless another thread is reading the same playlist (which
+ *  happens when it is used by several tracks).
+ */
+class AudioPlaylist::ReadHits {
+public:
+	ReadHits (AudioPlaylist& pl)
+		: _lock (pl._read_hits_lock, Glib::Threads::TRY_LOCK)
+		, _hits (_lock.locked () ? pl._read_hits : _local)
+	{}
+
+	vector<uint32_t>& get () { return _hits; }
+
+private:
+	Glib::Threads::Mutex::Lock _lock;
+	vector<uint32_t>           _local;
+	vector<uint32_t>&          _hits;
+};
 
+/** Work out which parts of which regions need to be read to fill start...end,
+ *  taking layering, opacity and fades into account.
+ *  @param all Regions to consider, sorted by ReadSorter.
+ *  @param solo_selection true to treat regions which are not solo-selected as transparent.
+ *  @param to_do Filled in with the segments to read, in order of precedence.
+ */
+void
+AudioPlaylist::plan_segments (RegionList const& all, samplepos_t start, samplepos_t end, bool solo_selection, vector<Segment>& to_do)
+{
 	/* This will be a list of the bits of our read range that we have
 	   handled completely (ie for which no more regions need to be read).
 	   It is a list of ranges in session samples.
 	*/
 	Evoral::RangeList<samplepos_t> done;
 
-	/* This will be a list of the bits of regions that we need to read */
-	list<Segment> to_do;
-
 	/* Now go through the `all' list filling in `to_do' and `done' */
-	for (RegionList::iterator i = all->begin(); i != all->end(); ++i) {
+	for (RegionList::const_iterator i = all.begin(); i != all.end(); ++i) {
 		boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (*i);
 
 		/* muted regions don't figure into it at all */
@@ -216,7 +275,7 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, sa
 		}
 
 		/* check for the case of solo_selection */
-		const bool force_transparent = (_session.solo_selection_active() && SoloSelectedActive() && !SoloSelectedListIncludes( (const Region*) &(**i)));
+		const bool force_transparent = (solo_selection && !SoloSelectedListIncludes( (const Region*) &(**i)));
 		if (force_transparent) {
 			continue;
 		}
@@ -226,7 +285,7 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, sa
 		*/
 		Evoral::Range<samplepos_t> region_range = ar->range ();
 		region_range.from = max (region_range.from, start);
-		region_range.to = min (region_range.to, start + cnt - 1);
+		region_range.to = min (region_range.to, end);
 
 		/* ... and then remove the bits that are already done */
 
@@ -240,7 +299,7 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, sa
 
 		for (Evoral::RangeList<samplepos_t>::List::iterator j = t.begin(); j != t.end(); ++j) {
 			Evoral::Range<samplepos_t> d = *j;
-			to_do.push_back (Segment (ar, d));
+			to_do.push_back (Segment (ar.get (), d));
 
 			if (ar->opaque ()) {
 				/* Cut this range down to just the body and mark it done */
@@ -253,19 +312,141 @@ AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, sa
 			}
 		}
 	}
+}
+
+/** @return a read plan covering start...end for the current contents of the
+ *  playlist, making a new one if anything has changed since it was last used
+ *  or if the range is not covered by it.
+ *  Caller must hold the region lock.
+ */
+boost::shared_ptr<AudioPlaylist::ReadPlan const>
+AudioPlaylist::read_plan (samplepos_t start, samplepos_t end)
+{
+	Glib::Threads::Mutex::Lock lm (_read_plan_lock);
+
+	/* read this first, so that any change made while we are
+	 * planning will cause the plan to be made again */
+	gint const generation = contents_generation ();
+
+	if (_read_plan && _read_plan->generation == generation && _read_plan->covers (start, end)) {
+		return _read_plan;
+	}
+
+	/* Disk readers ask for consecutive chunks, plan for the next few of
+	 * them. Only regions touching this window are considered, so the
+	 * cost does not depend on the size of the playlist.
+	 */
+	samplecnt_t const ahead = (end - start + 1) * 15;
+	samplepos_t const plan_end = (end < max_samplepos - ahead) ? end + ahead : max_samplepos;
+
+	RegionList all;
+	regions_touched_locked (start, plan_end, all);
+	all.sort (ReadSorter ());
+
+	DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("Playlist %1 make read plan for %2 .. %3, %4 regions\n", name(), start, plan_end, all.size()));
+
+	boost::shared_ptr<ReadPlan> plan (new ReadPlan (generation, start, plan_end));
+	plan_segments (all, start, plan_end, false, plan->segments);
+	plan->build_index ();
+
+	_read_plan = plan;
+	return _read_plan;
+}
+
+/** @param start Start position in session samples.
+ *  @param cnt Number of samples to read.
+ */
+samplecnt_t
+AudioPlaylist::read (Sample *buf, Sample *mixdown_buffer, float *gain_buffer, samplepos_t start, samplecnt_t cnt, unsigned chan_n)
+{
+	DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("Playlist %1 read @ %2 for %3, channel %4, regions %5 mixdown @ %6 gain @ %7\n",
+							   name(), start, cnt, chan_n, regions.size(), mixdown_buffer, gain_buffer));
+
+	/* optimizing this memset() away involves a lot of conditionals
+	   that may well cause more of a hit due to cache misses
+	   and related stuff than just doing this here.
+
+	   it would be great if someone could measure this
+	   at some point.
+
+	   one way or another, parts of the requested area
+	   that are not written to by Region::region_at()
+	   for all Regions that cover the area need to be
+	   zeroed.
+	*/
+
+	memset (buf, 0, sizeof (Sample) * cnt);
+
+	/* this function is never called from a realtime thread, so
+	   its OK to block (for short intervals).
+	*/
+
+	Playlist::RegionReadLock rl (this);
+
+	samplepos_t const end = start + cnt - 1;
+
+	/* This will be a list of the bits of regions that we need to read */
+	vector<Segment> to_do;
+
+	if (_session.solo_selection_active() && SoloSelectedActive()) {
+		/* Transparency depends on the selection rather than on the
+		   playlist, so work out what to read for this range only.
+		   Find all the regions that are involved in the bit we are reading,
+		   and sort them by descending layer and ascending position.
+		*/
+		RegionList all;
+		regions_touched_locked (start, end, all);
+		all.sort (ReadSorter ());
+		plan_segments (all, start, end, true, to_do);
+	} else {
+		/* Layering only changes when the playlist does, so use the
+		   plan for this and the following reads and pick out the bits
+		   we need.
+		*/
+		ReadHits hits (*this);
+		read_plan (start, end)->segments_touched (start, end, hits.get (), to_do);
+	}
 
 	/* Now go backwards through the to_do list doing the actual reads */
-	for (list<Segment>::reverse_iterator i = to_do.rbegin(); i != to_do.rend(); ++i) {
+	for (vector<Segment>::reverse_iterator i = to_do.rbegin(); i != to_do.rend(); ++i) {
+		samplepos_t const from = max (i->range.from, start);
+		samplepos_t const to = min (i->range.to, end);
 		DEBUG_TRACE (DEBUG::AudioPlayback, string_compose ("\tPlaylist %1 read %2 @ %3 for %4, channel %5, buf @ %6 offset %7\n",
-								   name(), i->region->name(), i->range.from,
-								   i->range.to - i->range.from + 1, (int) chan_n,
-								   buf, i->range.from - start));
-		i->region->read_at (buf + i->range.from - start, mixdown_buffer, gain_buffer, i->range.from, i->range.to - i->range.from + 1, chan_n);
+								   name(), i->region->name(), from,
+								   to - from + 1, (int) chan_n,
+								   buf, from - start));
+		i->region->read_at (buf + from - start, mixdown_buffer, gain_buffer, from, to - from + 1, chan_n);
 	}
 
 	return cnt;
 }
 
+/** Ask all regions that a read() of start...start+cnt will use to prepare
+ *  their data, so that the disk I/O of many tracks can be in flight at the
+ *  same time rather than one read after another.
+ */
+void
+AudioPlaylist::prefetch (samplepos_t start, samplecnt_t cnt)
+{
+	if (cnt <= 0) {
+		return;
+	}
+
+	Playlist::RegionReadLock rl (this);
+
+	samplepos_t const end = start + cnt - 1;
+	vector<Segment> to_do;
+	ReadHits hits (*this);
+
+	read_plan (start, end)->segments_touched (start, end, hits.get (), to_do);
+
+	for (vector<Segment>::const_iterator i = to_do.begin(); i != to_do.end(); ++i) {
+		samplepos_t const from = max (i->range.from, start);
+		samplepos_t const to = min (i->range.to, end);
+		i->region->prefetch (from, to - from + 1);
+	}
+}
+
 void
 AudioPlaylist::dump () const
 {
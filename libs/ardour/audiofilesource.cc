@@ -55,6 +55,7 @@
 #include "ardour/mp3filesource.h"
 #include "ardour/sndfilesource.h"
 #include "ardour/session.h"
+#include "ardour/source_block_cache.h"
 #include "ardour/filename_extensions.h"
 
 // if these headers come before sigc++ is included
@@ -165,6 +166,7 @@ AudioFileSource::~AudioFileSource ()
 	if (removable()) {
 		::g_unlink (_path.c_str());
 		::g_unlink (_peakpath.c_str());
+		remove_peak_levels (_peakpath);
 	}
 }
 
@@ -253,6 +255,7 @@ AudioFileSource::mark_streaming_write_completed (const Lock& lock)
 int
 AudioFileSource::move_dependents_to_trash()
 {
+	remove_peak_levels (_peakpath);
 	return ::g_unlink (_peakpath.c_str());
 }
 
@@ -297,6 +300,12 @@ AudioFileSource::set_gain (float g, bool temporarily)
 		return;
 	}
 	_gain = g;
+
+	/* cached blocks were read with the old gain applied */
+	if (SourceBlockCache* cache = _session.source_block_cache ()) {
+		cache->drop (*this);
+	}
+
 	if (temporarily) {
 		return;
 	}
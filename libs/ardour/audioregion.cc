@@ -1383,6 +1383,31 @@ AudioRegion::read_raw_internal (Sample* buf, samplepos_t pos, samplecnt_t cnt, i
 	return audio_source(channel)->read (buf, pos, cnt);
 }
 
+/** Ask the sources of all channels to get ready for a read_at() of the same range.
+ *  @param position Position in session samples.
+ *  @param cnt Number of samples that will be read.
+ */
+void
+AudioRegion::prefetch (samplepos_t position, samplecnt_t cnt) const
+{
+	if (position < _position) {
+		cnt -= _position - position;
+		position = _position;
+	}
+
+	sampleoffset_t const internal_offset = position - _position;
+
+	if (cnt <= 0 || internal_offset >= _length) {
+		return;
+	}
+
+	cnt = min (cnt, _length - internal_offset);
+
+	for (uint32_t n = 0; n < n_channels (); ++n) {
+		audio_source (n)->prefetch (_start + internal_offset, cnt);
+	}
+}
+
 void
 AudioRegion::set_scale_amplitude (gain_t g)
 {
@@ -63,6 +63,8 @@
 #include "ardour/rc_configuration.h"
 #include "ardour/runtime_functions.h"
 #include "ardour/session.h"
+#include "ardour/source_block_cache.h"
+#include "ardour/source_factory.h"
 
 #include "pbd/i18n.h"
 
@@ -79,6 +81,14 @@ bool AudioSource::_build_peakfiles = false;
 
 #define _FPP 256
 
+/* The peakfile holds one peak per _FPP samples. Coarser levels, each with
+ * _PEAK_LEVEL_RATIO times fewer peaks than the previous one, are stored in
+ * files next to it (see peak_level_path()), so that zoomed-out views of long
+ * sources only read a small part of the peak data.
+ */
+#define _PEAK_LEVELS 3
+#define _PEAK_LEVEL_RATIO 16
+
 AudioSource::AudioSource (Session& s, const string& name)
 	: Source (s, DataType::AUDIO, name)
 	, _length (0)
@@ -93,6 +103,8 @@ AudioSource::AudioSource (Session& s, const string& name)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _last_fpp (0)
+	, _peak_levels (-1)
 {
 }
 
@@ -110,6 +122,8 @@ AudioSource::AudioSource (Session& s, const XMLNode& node)
 	, _last_scale (0.0)
 	, _last_map_off (0)
 	, _last_raw_map_length (0)
+	, _last_fpp (0)
+	, _peak_levels (-1)
 {
 	if (set_state (node, Stateful::loading_state_version)) {
 		throw failed_constructor();
@@ -214,6 +228,14 @@ AudioSource::touch_peakfile ()
 	tbuf.modtime = time ((time_t*) 0);
 
 	g_utime (_peakpath.c_str(), &tbuf);
+
+	/* keep the coarser levels as new as the peakfile, see peak_levels_valid() */
+	for (uint32_t level = 1; level < _PEAK_LEVELS; ++level) {
+		std::string const path = peak_level_path (peak_level_fpp (level));
+		if (Glib::file_test (path, Glib::FILE_TEST_EXISTS)) {
+			g_utime (path.c_str(), &tbuf);
+		}
+	}
 }
 
 int
@@ -230,7 +252,17 @@ AudioSource::rename_peakfile (string newpath)
 		}
 	}
 
+	/* the coarser levels can be rebuilt, so a failure to move them is not an error */
+	remove_peak_levels (newpath);
+	for (uint32_t level = 1; level < _PEAK_LEVELS; ++level) {
+		std::string const path = peak_level_path (peak_level_fpp (level));
+		if (Glib::file_test (path, Glib::FILE_TEST_EXISTS)) {
+			g_rename (path.c_str(), string_compose ("%1.%2", newpath, peak_level_fpp (level)).c_str());
+		}
+	}
+
 	_peakpath = newpath;
+	g_atomic_int_set (&_peak_levels, -1);
 
 	return 0;
 }
@@ -242,6 +274,7 @@ AudioSource::initialize_peakfile (const string& audio_path, const bool in_sessio
 	GStatBuf statbuf;
 
 	_peakpath = construct_peak_filepath (audio_path, in_session);
+	g_atomic_int_set (&_peak_levels, -1);
 
 	if (!empty() && !Glib::file_test (_peakpath.c_str(), Glib::FILE_TEST_EXISTS)) {
 		string oldpeak = construct_peak_filepath (audio_path, in_session, true);
@@ -306,6 +339,13 @@ AudioSource::initialize_peakfile (const string& audio_path, const bool in_sessio
 		}
 	}
 
+	if (!_peaks_built) {
+		remove_peak_levels (_peakpath);
+	} else if (_build_peakfiles && !peak_levels_valid ()) {
+		/* peakfiles written before the coarser levels existed */
+		queue_peak_levels ();
+	}
+
 	if (!empty() && !_peaks_built && _build_missing_peakfiles && _build_peakfiles) {
 		build_peaks_from_scratch ();
 	}
@@ -318,10 +358,24 @@ AudioSource::read (Sample *dst, samplepos_t start, samplecnt_t cnt, int /*channe
 {
 	assert (cnt >= 0);
 
+	SourceBlockCache* cache = _session.source_block_cache ();
+	if (cache && cache->read (*this, dst, start, cnt)) {
+		return cnt;
+	}
+
 	Glib::Threads::Mutex::Lock lm (_lock);
 	return read_unlocked (dst, start, cnt);
 }
 
+void
+AudioSource::prefetch (samplepos_t start, samplecnt_t cnt) const
+{
+	assert (cnt >= 0);
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+	prefetch_unlocked (start, cnt);
+}
+
 samplecnt_t
 AudioSource::write (Sample *dst, samplecnt_t cnt)
 {
@@ -334,9 +388,216 @@ AudioSource::write (Sample *dst, samplecnt_t cnt)
 int
 AudioSource::read_peaks (PeakData *peaks, samplecnt_t npeaks, samplepos_t start, samplecnt_t cnt, double samples_per_visual_peak) const
 {
+	/* use the coarsest level that still has at least one stored peak per visual peak */
+	for (uint32_t level = _PEAK_LEVELS - 1; level > 0; --level) {
+		samplecnt_t const fpp = peak_level_fpp (level);
+		if (samples_per_visual_peak >= fpp && peak_level_available (level)) {
+			if (read_peaks_with_fpp (peaks, npeaks, start, cnt, samples_per_visual_peak, fpp) == 0) {
+				return 0;
+			}
+			/* removed since we last looked, use the peakfile */
+			g_atomic_int_set (&_peak_levels, -1);
+			break;
+		}
+	}
+
 	return read_peaks_with_fpp (peaks, npeaks, start, cnt, samples_per_visual_peak, _FPP);
 }
 
+samplecnt_t
+AudioSource::peak_level_fpp (uint32_t level)
+{
+	samplecnt_t fpp = _FPP;
+	while (level--) {
+		fpp *= _PEAK_LEVEL_RATIO;
+	}
+	return fpp;
+}
+
+/** @return path of the file that holds one peak per @param fpp samples */
+std::string
+AudioSource::peak_level_path (samplecnt_t fpp) const
+{
+	if (fpp == _FPP) {
+		return _peakpath;
+	}
+	return string_compose ("%1.%2", _peakpath, fpp);
+}
+
+/** @return true if the complete @param level has been built. The result for
+ *  all levels is cached until the level files are built or removed, so that
+ *  read_peaks() does not stat them every time.
+ */
+bool
+AudioSource::peak_level_available (uint32_t level) const
+{
+	if (!_peaks_built) {
+		return false;
+	}
+
+	gint levels = g_atomic_int_get (&_peak_levels);
+
+	if (levels < 0) {
+		levels = 0;
+		for (uint32_t l = 1; l < _PEAK_LEVELS; ++l) {
+			if (peak_level_complete (peak_level_fpp (l))) {
+				levels |= 1 << l;
+			}
+		}
+		g_atomic_int_compare_and_exchange (&_peak_levels, -1, levels);
+	}
+
+	return levels & (1 << level);
+}
+
+/** @return true if the file of the level with @param fpp samples per peak is complete */
+bool
+AudioSource::peak_level_complete (samplecnt_t fpp) const
+{
+	GStatBuf statbuf;
+
+	if (g_stat (peak_level_path (fpp).c_str(), &statbuf) != 0) {
+		return false;
+	}
+
+	return statbuf.st_size >= (off_t) (((_length + fpp - 1) / fpp) * sizeof (PeakData));
+}
+
+/** @return true if all coarser levels exist and are at least as new as the peakfile */
+bool
+AudioSource::peak_levels_valid () const
+{
+	GStatBuf statbuf;
+
+	if (g_stat (_peakpath.c_str(), &statbuf) != 0) {
+		return false;
+	}
+
+	for (uint32_t level = 1; level < _PEAK_LEVELS; ++level) {
+		GStatBuf level_statbuf;
+		if (!peak_level_complete (peak_level_fpp (level))) {
+			return false;
+		}
+		if (g_stat (peak_level_path (peak_level_fpp (level)).c_str(), &level_statbuf) != 0 || level_statbuf.st_mtime < statbuf.st_mtime) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+AudioSource::remove_peak_levels (std::string const& peakpath)
+{
+	for (uint32_t level = 1; level < _PEAK_LEVELS; ++level) {
+		::g_unlink (string_compose ("%1.%2", peakpath, peak_level_fpp (level)).c_str());
+	}
+}
+
+/** Have the peak builder threads build the coarser levels, see build_peak_levels() */
+void
+AudioSource::queue_peak_levels ()
+{
+	boost::shared_ptr<AudioSource> as;
+
+	try {
+		as = boost::dynamic_pointer_cast<AudioSource> (shared_from_this ());
+	} catch (boost::bad_weak_ptr const&) {
+		/* not yet owned by a shared_ptr */
+	}
+
+	if (as) {
+		SourceFactory::queue_peak_levels (as);
+	} else {
+		build_peak_levels ();
+	}
+}
+
+/** Build the coarser peak levels from the complete peakfile. Each level is
+ *  written to a temporary file first, so that readers never see a partial one.
+ */
+int
+AudioSource::build_peak_levels ()
+{
+	/* queued by both initialize_peakfile() and done_with_peakfile_writes() */
+	Glib::Threads::Mutex::Lock lm (_peak_levels_lock);
+
+	const size_t n_peaks = _peak_byte_max / sizeof (PeakData);
+
+	if (n_peaks == 0) {
+		return 0;
+	}
+
+	DEBUG_TRACE (DEBUG::Peaks, string_compose ("Building %1 peak levels for %2\n", _PEAK_LEVELS - 1, _peakpath));
+
+	ScopedFileDescriptor sfd (g_open (_peakpath.c_str(), O_RDONLY, 0444));
+
+	if (sfd < 0) {
+		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), _peakpath, strerror (errno)) << endmsg;
+		return -1;
+	}
+
+	std::vector<PeakData> levels[_PEAK_LEVELS];
+
+	{
+		const size_t chunksize = 65536;
+		boost::scoped_array<PeakData> staging (new PeakData[chunksize]);
+		size_t done = 0;
+
+		levels[1].reserve (n_peaks / _PEAK_LEVEL_RATIO + 1);
+
+		while (done < n_peaks) {
+			size_t const to_read = min (chunksize, n_peaks - done);
+			if (::read (sfd, staging.get(), to_read * sizeof (PeakData)) != (ssize_t) (to_read * sizeof (PeakData))) {
+				error << string_compose (_("%1: could not read peak file data (%2)"), _name, strerror (errno)) << endmsg;
+				return -1;
+			}
+			for (size_t i = 0; i < to_read; ++i, ++done) {
+				if (done % _PEAK_LEVEL_RATIO == 0) {
+					levels[1].push_back (staging[i]);
+				} else {
+					levels[1].back().min = min (levels[1].back().min, staging[i].min);
+					levels[1].back().max = max (levels[1].back().max, staging[i].max);
+				}
+			}
+		}
+	}
+
+	for (uint32_t level = 2; level < _PEAK_LEVELS; ++level) {
+		std::vector<PeakData> const& finer (levels[level - 1]);
+		for (size_t i = 0; i < finer.size(); ++i) {
+			if (i % _PEAK_LEVEL_RATIO == 0) {
+				levels[level].push_back (finer[i]);
+			} else {
+				levels[level].back().min = min (levels[level].back().min, finer[i].min);
+				levels[level].back().max = max (levels[level].back().max, finer[i].max);
+			}
+		}
+	}
+
+	for (uint32_t level = 1; level < _PEAK_LEVELS; ++level) {
+		std::string const path = peak_level_path (peak_level_fpp (level));
+		std::string const tmp  = path + X_(".tmp");
+		ssize_t const bytes = levels[level].size() * sizeof (PeakData);
+
+		int fd = g_open (tmp.c_str(), O_CREAT|O_TRUNC|O_WRONLY, 0664);
+		if (fd < 0) {
+			error << string_compose(_("AudioSource: cannot open _peakpath (c) \"%1\" (%2)"), tmp, strerror (errno)) << endmsg;
+			return -1;
+		}
+		bool ok = ::write (fd, &levels[level][0], bytes) == bytes;
+		ok = (::close (fd) == 0) && ok;
+		if (!ok || g_rename (tmp.c_str(), path.c_str()) != 0) {
+			error << string_compose(_("%1: could not write peak file data (%2)"), _name, strerror (errno)) << endmsg;
+			::g_unlink (tmp.c_str());
+			return -1;
+		}
+	}
+
+	g_atomic_int_set (&_peak_levels, -1);
+	return 0;
+}
+
 /** @param peaks Buffer to write peak data.
  *  @param npeaks Number of peaks to write.
  */
@@ -402,16 +663,17 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 #endif
 	samplecnt_t read_npeaks = npeaks;
 	samplecnt_t zero_fill = 0;
+	std::string const peakpath = peak_level_path (samples_per_file_peak);
 
 	GStatBuf statbuf;
 
 	expected_peaks = (cnt / (double) samples_per_file_peak);
-	if (g_stat (_peakpath.c_str(), &statbuf) != 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for size check (%2)"), _peakpath, strerror (errno)) << endmsg;
+	if (g_stat (peakpath.c_str(), &statbuf) != 0) {
+		error << string_compose (_("Cannot open peakfile @ %1 for size check (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
 
-	if (!_captured_for.empty()) {
+	if (!_captured_for.empty() && samples_per_file_peak == _FPP) {
 
 		/* _captured_for is only set after a capture pass is
 		 * complete. so we know that capturing is finished for this
@@ -442,10 +704,10 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 		}
 	}
 
-	ScopedFileDescriptor sfd (g_open (_peakpath.c_str(), O_RDONLY, 0444));
+	ScopedFileDescriptor sfd (g_open (peakpath.c_str(), O_RDONLY, 0444));
 
 	if (sfd < 0) {
-		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), _peakpath, strerror (errno)) << endmsg;
+		error << string_compose (_("Cannot open peakfile @ %1 for reading (%2)"), peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
 
@@ -453,7 +715,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 
 
 	DEBUG_TRACE (DEBUG::Peaks, string_compose (" ======>RP: npeaks = %1 start = %2 cnt = %3 len = %4 samples_per_visual_peak = %5 expected was %6 ... scale =  %7 PD ptr = %8 pf = %9\n"
-			, npeaks, start, cnt, _length, samples_per_visual_peak, expected_peaks, scale, peaks, _peakpath));
+			, npeaks, start, cnt, _length, samples_per_visual_peak, expected_peaks, scale, peaks, peakpath));
 
 	/* fix for near-end-of-file conditions */
 
@@ -505,7 +767,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 		off_t  map_delta = map_off - read_map_off;
 		size_t map_length = bytes_to_read + map_delta;
 
-		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read)) {
+		if (_first_run  || (_last_scale != samples_per_visual_peak) || (_last_fpp != samples_per_file_peak) || (_last_map_off != map_off) || (_last_raw_map_length  < bytes_to_read)) {
 			peak_cache.reset (new PeakData[npeaks]);
 			char* addr;
 #ifdef PLATFORM_WINDOWS
@@ -516,13 +778,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 
 			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
 			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
 			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
 			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -533,13 +795,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 			err_flag = UnmapViewOfFile (view_handle);
 			err_flag = CloseHandle(map_handle);
 			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 #else
 			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
 			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -552,6 +814,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 
 			_first_run = false;
 			_last_scale = samples_per_visual_peak;
+			_last_fpp = samples_per_file_peak;
 			_last_map_off = map_off;
 			_last_raw_map_length = bytes_to_read;
 		}
@@ -598,7 +861,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 		size_t raw_map_length = chunksize * sizeof(PeakData);
 		size_t map_length = (chunksize * sizeof(PeakData)) + map_delta;
 
-		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length)) {
+		if (_first_run || (_last_scale != samples_per_visual_peak) || (_last_fpp != samples_per_file_peak) || (_last_map_off != map_off) || (_last_raw_map_length < raw_map_length)) {
 			peak_cache.reset (new PeakData[npeaks]);
 			boost::scoped_array<PeakData> staging (new PeakData[chunksize]);
 
@@ -611,13 +874,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 
 			map_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
 			if (map_handle == NULL) {
-				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not create file mapping for peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
 			view_handle = MapViewOfFile(map_handle, FILE_MAP_READ, 0, read_map_off, map_length);
 			if (view_handle == NULL) {
-				error << string_compose (_("map failed - could not map peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not map peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -628,13 +891,13 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 			err_flag = UnmapViewOfFile (view_handle);
 			err_flag = CloseHandle(map_handle);
 			if(!err_flag) {
-				error << string_compose (_("unmap failed - could not unmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("unmap failed - could not unmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 #else
 			addr = (char*) mmap (0, map_length, PROT_READ, MAP_PRIVATE, sfd, read_map_off);
 			if (addr ==  MAP_FAILED) {
-				error << string_compose (_("map failed - could not mmap peakfile %1."), _peakpath) << endmsg;
+				error << string_compose (_("map failed - could not mmap peakfile %1."), peakpath) << endmsg;
 				return -1;
 			}
 
@@ -668,6 +931,7 @@ AudioSource::read_peaks_with_fpp (PeakData *peaks, samplecnt_t npeaks, samplepos
 
 			_first_run = false;
 			_last_scale = samples_per_visual_peak;
+			_last_fpp = samples_per_file_peak;
 			_last_map_off = map_off;
 			_last_raw_map_length = raw_map_length;
 		}
@@ -844,6 +1108,8 @@ AudioSource::close_peakfile ()
 	}
 	if (!_peakpath.empty()) {
 		::g_unlink (_peakpath.c_str());
+		remove_peak_levels (_peakpath);
+		g_atomic_int_set (&_peak_levels, -1);
 	}
 	_peaks_built = false;
 	return 0;
@@ -860,6 +1126,11 @@ AudioSource::prepare_for_peakfile_writes ()
 		error << string_compose(_("AudioSource: cannot open _peakpath (c) \"%1\" (%2)"), _peakpath, strerror (errno)) << endmsg;
 		return -1;
 	}
+
+	/* the coarser levels are rebuilt from the peakfile when it is complete */
+	remove_peak_levels (_peakpath);
+	g_atomic_int_set (&_peak_levels, -1);
+
 	return 0;
 }
 
@@ -882,9 +1153,12 @@ AudioSource::done_with_peakfile_writes (bool done)
 	_peakfile_fd = -1;
 
 	if (done) {
-		Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
-		_peaks_built = true;
-		PeaksReady (); /* EMIT SIGNAL */
+		{
+			Glib::Threads::Mutex::Lock lm (_peaks_ready_lock);
+			_peaks_built = true;
+			PeaksReady (); /* EMIT SIGNAL */
+		}
+		queue_peak_levels ();
 	}
 }
 
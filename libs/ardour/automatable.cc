@@ -313,7 +313,7 @@ Automatable::get_automation_xml_state ()
 	for (Controls::iterator li = controls().begin(); li != controls().end(); ++li) {
 		boost::shared_ptr<AutomationList> l = boost::dynamic_pointer_cast<AutomationList>(li->second->list());
 		if (l) {
-			node->add_child_nocopy (l->get_state ());
+			node->add_child_nocopy (l->get_cached_state ());
 		}
 	}
 
@@ -681,6 +681,20 @@ Automatable::find_next_ac_event (boost::shared_ptr<AutomationControl> c, double
 		return;
 	}
 
+	{
+		/* binary search the flat copy of the list, if that can be had without blocking */
+		Glib::Threads::RWLock::ReaderLock lm (alist->lock(), Glib::Threads::TRY_LOCK);
+		const Evoral::ControlList::FlatEvents& flat (alist->flat_events ());
+
+		if (lm.locked () && flat.valid) {
+			const size_t n = flat.upper_bound (start);
+			if (n < flat.size () && flat.when[n] < end && flat.when[n] < next_event.when) {
+				next_event.when = flat.when[n];
+			}
+			return;
+		}
+	}
+
 	Evoral::ControlList::const_iterator i = upper_bound (alist->begin(), alist->end(), &cp, Evoral::ControlList::time_comparator);
 
 	if (i != alist->end() && (*i)->when < end) {
@@ -61,6 +61,9 @@ static void dumpit (const AutomationList& al, string prefix = "")
 AutomationList::AutomationList (const Evoral::Parameter& id, const Evoral::ParameterDescriptor& desc)
 	: ControlList(id, desc)
 	, _before (0)
+	, _state_cache (0)
+	, _state_cache_id ((uint64_t) 0)
+	, _state_dirty (1)
 {
 	_state = Off;
 	g_atomic_int_set (&_touching, 0);
@@ -75,6 +78,9 @@ AutomationList::AutomationList (const Evoral::Parameter& id, const Evoral::Param
 AutomationList::AutomationList (const Evoral::Parameter& id)
 	: ControlList(id, ARDOUR::ParameterDescriptor(id))
 	, _before (0)
+	, _state_cache (0)
+	, _state_cache_id ((uint64_t) 0)
+	, _state_dirty (1)
 {
 	_state = Off;
 	g_atomic_int_set (&_touching, 0);
@@ -90,6 +96,9 @@ AutomationList::AutomationList (const AutomationList& other)
 	: ControlList(other)
 	, StatefulDestructible()
 	, _before (0)
+	, _state_cache (0)
+	, _state_cache_id ((uint64_t) 0)
+	, _state_dirty (1)
 {
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
@@ -103,6 +112,9 @@ AutomationList::AutomationList (const AutomationList& other)
 AutomationList::AutomationList (const AutomationList& other, double start, double end)
 	: ControlList(other, start, end)
 	, _before (0)
+	, _state_cache (0)
+	, _state_cache_id ((uint64_t) 0)
+	, _state_dirty (1)
 {
 	_state = other._state;
 	g_atomic_int_set (&_touching, other.touching());
@@ -119,6 +131,9 @@ AutomationList::AutomationList (const AutomationList& other, double start, doubl
 AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 	: ControlList(id, ARDOUR::ParameterDescriptor(id))
 	, _before (0)
+	, _state_cache (0)
+	, _state_cache_id ((uint64_t) 0)
+	, _state_dirty (1)
 {
 	g_atomic_int_set (&_touching, 0);
 	_interpolation = default_interpolation ();
@@ -139,6 +154,7 @@ AutomationList::AutomationList (const XMLNode& node, Evoral::Parameter id)
 AutomationList::~AutomationList()
 {
 	delete _before;
+	delete _state_cache;
 }
 
 boost::shared_ptr<Evoral::ControlList>
@@ -168,6 +184,7 @@ AutomationList::create_curve_if_necessary()
 	}
 
 	WritePassStarted.connect_same_thread (_writepass_connection, boost::bind (&AutomationList::snapshot_history, this, false));
+	InterpolationChanged.connect_same_thread (_interpolation_connection, boost::bind (&AutomationList::mark_state_dirty, this));
 }
 
 AutomationList&
@@ -181,6 +198,7 @@ AutomationList::operator= (const AutomationList& other)
 		ControlList::operator= (other);
 		_state = other._state;
 		_touching = other._touching;
+		mark_state_dirty ();
 		ControlList::thaw ();
 	}
 
@@ -214,6 +232,7 @@ AutomationList::set_automation_state (AutoState s)
 			return;
 		}
 		_state = s;
+		mark_state_dirty ();
 		if (s == Write && _desc.toggled) {
 			snapshot_history (true);
 		}
@@ -349,6 +368,36 @@ AutomationList::get_state ()
 	return state (true, true);
 }
 
+void
+AutomationList::events_changed () const
+{
+	mark_state_dirty ();
+}
+
+XMLNode&
+AutomationList::get_cached_state ()
+{
+	if (regenerate_xml_or_string_ids ()) {
+		/* the state must contain new IDs, don't use (or update) the cache */
+		return get_state ();
+	}
+
+	Glib::Threads::Mutex::Lock lm (_state_cache_lock);
+
+	/* reset the flag before calling get_state(), a change made while the
+	 * state is being generated will mark it dirty again.
+	 */
+	const bool dirty = g_atomic_int_compare_and_exchange (&_state_dirty, 1, 0);
+
+	if (dirty || !_state_cache || _state_cache_id != id ()) {
+		delete _state_cache;
+		_state_cache = &get_state ();
+		_state_cache_id = id ();
+	}
+
+	return *(new XMLNode (*_state_cache));
+}
+
 XMLNode&
 AutomationList::state (bool save_auto_state, bool need_lock)
 {
@@ -516,6 +565,8 @@ AutomationList::set_state (const XMLNode& node, int version)
 		return -1;
 	}
 
+	mark_state_dirty ();
+
 	if (set_id (node)) {
 		/* update session AL list */
 		AutomationListCreated(this);
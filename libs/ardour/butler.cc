@@ -28,15 +28,24 @@
 #include <poll.h>
 #endif
 
+#include <algorithm>
+
+#include <glibmm/miscutils.h>
+
 #include "pbd/error.h"
+#include "pbd/gstdio_compat.h"
 #include "pbd/pthread_utils.h"
 
 #include "ardour/butler.h"
 #include "ardour/debug.h"
 #include "ardour/disk_io.h"
 #include "ardour/disk_reader.h"
+#include "ardour/file_source.h"
 #include "ardour/io.h"
+#include "ardour/playlist.h"
 #include "ardour/session.h"
+#include "ardour/session_directory.h"
+#include "ardour/source_block_cache.h"
 #include "ardour/track.h"
 #include "ardour/auditioner.h"
 
@@ -46,6 +55,69 @@ using namespace PBD;
 
 namespace ARDOUR {
 
+/** A thread that refills or flushes a part of the tracks */
+struct Butler::Worker {
+	Worker (Butler& b, uint32_t id, bool h)
+		: butler (b)
+		, sem (string_compose ("butler_worker_%1", id).c_str (), 0)
+		, helper (h)
+		, job (Refill)
+		, outstanding (false)
+		, errors (0)
+		, buffer_samples_needed (0)
+		, buffer_samples (0)
+		, sum_buffer (0)
+		, mixdown_buffer (0)
+		, gain_buffer (0)
+	{
+		g_atomic_int_set (&quit, 0);
+	}
+
+	~Worker ()
+	{
+		delete[] sum_buffer;
+		delete[] mixdown_buffer;
+		delete[] gain_buffer;
+	}
+
+	/** The butler thread itself uses DiskReader's working buffers,
+	 *  helpers need their own. They only grow, since tracks' playback
+	 *  buffers are resized after the butler learns about a new size.
+	 */
+	void reserve_buffers ()
+	{
+		if (!helper || buffer_samples >= buffer_samples_needed) {
+			return;
+		}
+
+		delete[] sum_buffer;
+		delete[] mixdown_buffer;
+		delete[] gain_buffer;
+
+		buffer_samples = buffer_samples_needed;
+		sum_buffer     = new Sample[buffer_samples];
+		mixdown_buffer = new Sample[buffer_samples];
+		gain_buffer    = new gain_t[buffer_samples];
+	}
+
+	Butler&        butler;
+	pthread_t      thread;
+	PBD::Semaphore sem;
+	gint           quit;
+	bool           helper;
+
+	Job                                    job;
+	std::vector<boost::shared_ptr<Track> > tracks;
+	bool                                   outstanding;
+	uint32_t                               errors;
+
+	samplecnt_t buffer_samples_needed; ///< set by the butler thread before a Refill
+	samplecnt_t buffer_samples;
+	Sample*     sum_buffer;
+	Sample* mixdown_buffer;
+	gain_t* gain_buffer;
+};
+
 Butler::Butler(Session& s)
 	: SessionHandleRef (s)
 	, thread()
@@ -54,6 +126,7 @@ Butler::Butler(Session& s)
 	, _audio_playback_buffer_size(0)
 	, _midi_buffer_size(0)
 	, pool_trash(16)
+	, _workers_done ("butler_workers_done", 0)
 	, _xthread (true)
 {
 	g_atomic_int_set(&should_do_transport_work, 0);
@@ -119,6 +192,8 @@ Butler::start_thread()
 
 	should_run = false;
 
+	start_workers (std::max (1U, Config->get_butler_threads ()));
+
 	if (pthread_create_and_store ("disk butler", &thread, _thread_work, this)) {
 		error << _("Session: could not create butler thread") << endmsg;
 		return -1;
@@ -142,7 +217,70 @@ Butler::terminate_thread ()
                 DEBUG_TRACE (DEBUG::Butler, string_compose ("%1: ask butler to quit @ %2\n", DEBUG_THREAD_SELF, g_get_monotonic_time()));
 		queue_request (Request::Quit);
 		pthread_join (thread, &status);
+		have_thread = false;
 	}
+
+	stop_workers ();
+}
+
+void
+Butler::start_workers (uint32_t n)
+{
+	stop_workers ();
+
+	_workers.push_back (new Worker (*this, 0, false));
+
+	for (uint32_t id = 1; id < n; ++id) {
+		Worker* w = new Worker (*this, id, true);
+		if (pthread_create_and_store ("disk butler helper", &w->thread, _worker_thread, w)) {
+			error << _("Session: could not create butler helper thread") << endmsg;
+			delete w;
+			break;
+		}
+		_workers.push_back (w);
+	}
+
+	DEBUG_TRACE (DEBUG::Butler, string_compose ("butler uses %1 thread(s)\n", _workers.size ()));
+}
+
+void
+Butler::stop_workers ()
+{
+	for (std::vector<Worker*>::iterator w = _workers.begin (); w != _workers.end (); ++w) {
+		if (w != _workers.begin ()) {
+			void* status;
+			g_atomic_int_set (&(*w)->quit, 1);
+			(*w)->sem.signal ();
+			pthread_join ((*w)->thread, &status);
+		}
+		delete *w;
+	}
+	_workers.clear ();
+}
+
+void*
+Butler::_worker_thread (void* arg)
+{
+	Worker* w = static_cast<Worker*> (arg);
+	pthread_set_name (X_("butler helper"));
+	return w->butler.worker_thread (w);
+}
+
+void*
+Butler::worker_thread (Worker* w)
+{
+	while (true) {
+		w->sem.wait ();
+
+		if (g_atomic_int_get (&w->quit)) {
+			break;
+		}
+
+		do_job (*w);
+		_workers_done.signal ();
+	}
+
+	return 0;
 }
 
 void *
@@ -232,10 +370,10 @@ Butler::thread_work ()
 		RouteList rl_with_auditioner = *rl;
 		rl_with_auditioner.push_back (_session.the_auditioner());
 
-		DEBUG_TRACE (DEBUG::Butler, string_compose ("butler starts refill loop, twr = %1\n", transport_work_requested()));
-
+		/* first let the OS start reading for all tracks, so that the
+		 * reads below do not have to wait for the disk one after another.
+		 */
 		for (i = rl_with_auditioner.begin(); !transport_work_requested() && should_run && i != rl_with_auditioner.end(); ++i) {
-
 			boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
 
 			if (!tr) {
@@ -245,31 +383,15 @@ Butler::thread_work ()
 			boost::shared_ptr<IO> io = tr->input ();
 
 			if (io && !io->active()) {
-				/* don't read inactive tracks */
-				// DEBUG_TRACE (DEBUG::Butler, string_compose ("butler skips inactive track %1\n", tr->name()));
 				continue;
 			}
-			// DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
-			switch (tr->do_refill ()) {
-			case 0:
-				//DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
-				break;
-
-			case 1:
-				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
-				disk_work_outstanding = true;
-				break;
-
-			default:
-				error << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << endmsg;
-                                std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), (*i)->name()) << std::endl;
-				break;
-			}
 
+			tr->prefetch ();
 		}
 
-		if (i != rl_with_auditioner.begin() && i != rl_with_auditioner.end()) {
-			/* we didn't get to all the streams */
+		DEBUG_TRACE (DEBUG::Butler, string_compose ("butler starts refill loop, twr = %1\n", transport_work_requested()));
+
+		if (refill_tracks (rl_with_auditioner)) {
 			disk_work_outstanding = true;
 		}
 
@@ -293,6 +415,10 @@ Butler::thread_work ()
 			goto restart;
 		}
 
+		if (_session.source_block_cache ()->update (_session)) {
+			disk_work_outstanding = true;
+		}
+
 		if (!disk_work_outstanding) {
 			_session.refresh_disk_space ();
 		}
@@ -317,14 +443,29 @@ Butler::thread_work ()
 	return (0);
 }
 
+bool
+Butler::refill_tracks (RouteList const& rl)
+{
+	/* read-ahead failures are reported, but are not errors that stop the transport */
+	uint32_t errors = 0;
+	return run_job (Refill, rl, errors);
+}
+
 bool
 Butler::flush_tracks_to_disk_normal (boost::shared_ptr<RouteList> rl, uint32_t& errors)
 {
-	bool disk_work_outstanding = false;
+	return run_job (Flush, *rl, errors);
+}
 
-	for (RouteList::iterator i = rl->begin(); !transport_work_requested() && should_run && i != rl->end(); ++i) {
+/** Refill or flush all tracks in @param rl, using all butler threads.
+ *  @return true if there is more disk work to be done.
+ */
+bool
+Butler::run_job (Job job, RouteList const& rl, uint32_t& errors)
+{
+	std::vector<boost::shared_ptr<Track> > tracks;
 
-		// cerr << "write behind for " << (*i)->name () << endl;
+	for (RouteList::const_iterator i = rl.begin(); i != rl.end(); ++i) {
 
 		boost::shared_ptr<Track> tr = boost::dynamic_pointer_cast<Track> (*i);
 
@@ -332,36 +473,260 @@ Butler::flush_tracks_to_disk_normal (boost::shared_ptr<RouteList> rl, uint32_t&
 			continue;
 		}
 
+		if (job == Refill) {
+			boost::shared_ptr<IO> io = tr->input ();
+
+			if (io && !io->active()) {
+				/* don't read inactive tracks */
+				continue;
+			}
+		}
+
 		/* note that we still try to flush diskstreams attached to inactive routes
 		 */
 
-		int ret;
+		tracks.push_back (tr);
+	}
 
-		// DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
-		ret = tr->do_flush (ButlerContext, false);
-		switch (ret) {
-		case 0:
-			//DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
-			break;
+	size_t const n = std::min (_workers.size (), tracks.size ());
 
-		case 1:
-			//DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
-			disk_work_outstanding = true;
-			break;
+	if (n < 2) {
+		Worker& w (*_workers.front ());
+		w.job = job;
+		w.tracks.swap (tracks);
+		do_job (w);
+		w.tracks.clear ();
+		errors += w.errors;
+		return w.outstanding;
+	}
 
-		default:
-			errors++;
-			error << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << endmsg;
-			std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), (*i)->name()) << std::endl;
-			/* don't break - try to flush all streams in case they
-			   are split across disks.
-			*/
+	assign_tracks (tracks);
+
+	samplecnt_t const buffer_samples = refill_buffer_samples ();
+	size_t            n_helpers      = 0;
+
+	for (size_t k = 0; k < _workers.size (); ++k) {
+		Worker& w (*_workers[k]);
+		w.job = job;
+		w.buffer_samples_needed = buffer_samples;
+		if (k > 0 && !w.tracks.empty ()) {
+			w.sem.signal ();
+			++n_helpers;
 		}
 	}
 
+	do_job (*_workers.front ());
+
+	for (size_t k = 0; k < n_helpers; ++k) {
+		_workers_done.wait ();
+	}
+
+	bool disk_work_outstanding = false;
+
+	for (size_t k = 0; k < _workers.size (); ++k) {
+		Worker& w (*_workers[k]);
+		disk_work_outstanding = disk_work_outstanding || w.outstanding;
+		errors += w.errors;
+		w.tracks.clear ();
+	}
+
 	return disk_work_outstanding;
 }
 
+void
+Butler::do_job (Worker& w)
+{
+	std::vector<boost::shared_ptr<Track> >::const_iterator i;
+
+	w.outstanding = false;
+	w.errors = 0;
+
+	if (w.job == Refill && !w.tracks.empty ()) {
+		w.reserve_buffers ();
+	}
+
+	for (i = w.tracks.begin(); !transport_work_requested() && should_run && i != w.tracks.end(); ++i) {
+
+		boost::shared_ptr<Track> tr (*i);
+		int ret;
+
+		if (w.job == Refill) {
+			// DEBUG_TRACE (DEBUG::Butler, string_compose ("butler refills %1, playback load = %2\n", tr->name(), tr->playback_buffer_load()));
+			if (w.sum_buffer) {
+				ret = tr->do_refill (w.sum_buffer, w.mixdown_buffer, w.gain_buffer);
+			} else {
+				ret = tr->do_refill ();
+			}
+
+			switch (ret) {
+			case 0:
+				//DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill done %1\n", tr->name()));
+				break;
+
+			case 1:
+				DEBUG_TRACE (DEBUG::Butler, string_compose ("\ttrack refill unfinished %1\n", tr->name()));
+				w.outstanding = true;
+				break;
+
+			default:
+				error << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler read ahead failure on dstream %1"), tr->name()) << std::endl;
+				break;
+			}
+
+		} else {
+			// DEBUG_TRACE (DEBUG::Butler, string_compose ("butler flushes track %1 capture load %2\n", tr->name(), tr->capture_buffer_load()));
+			ret = tr->do_flush (ButlerContext, false);
+
+			switch (ret) {
+			case 0:
+				//DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush complete for %1\n", tr->name()));
+				break;
+
+			case 1:
+				//DEBUG_TRACE (DEBUG::Butler, string_compose ("\tflush not finished for %1\n", tr->name()));
+				w.outstanding = true;
+				break;
+
+			default:
+				w.errors++;
+				error << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << endmsg;
+				std::cerr << string_compose(_("Butler write-behind failure on dstream %1"), tr->name()) << std::endl;
+				/* don't break - try to flush all streams in case they
+				   are split across disks.
+				*/
+			}
+		}
+	}
+
+	if (w.job == Refill && i != w.tracks.begin() && i != w.tracks.end()) {
+		/* we didn't get to all the streams */
+		w.outstanding = true;
+	}
+}
+
+/** @return the number of samples that a single refill may read into the working buffers */
+samplecnt_t
+Butler::refill_buffer_samples () const
+{
+	/* A refill never reads more than fits into a track's playback buffer,
+	 * which PlaybackBuffer rounds up to a power of two after adding its
+	 * reservation (< 8192), nor more than DiskReader's own working buffers
+	 * hold (see DiskReader::allocate_working_buffers).
+	 */
+	samplecnt_t const limit = 2 * 1048576;
+	samplecnt_t       n     = 8192;
+
+	while (n < limit && n < _audio_playback_buffer_size + 8192) {
+		n *= 2;
+	}
+
+	return std::min (n, limit);
+}
+
+struct TrackDeviceSorter {
+	TrackDeviceSorter (std::map<PBD::ID, uint64_t> const& d) : devices (d) {}
+	bool operator() (boost::shared_ptr<Track> const& a, boost::shared_ptr<Track> const& b) const {
+		return devices.find (a->id ())->second < devices.find (b->id ())->second;
+	}
+	std::map<PBD::ID, uint64_t> const& devices;
+};
+
+struct TrackGroupSizeSorter {
+	bool operator() (std::pair<size_t, size_t> const& a, std::pair<size_t, size_t> const& b) const {
+		return a.second - a.first > b.second - b.first;
+	}
+};
+
+/** Hand @param tracks to the butler threads. All tracks whose files are on
+ *  the same device are handled by the same thread, so that a disk is never
+ *  accessed by several threads at once. Devices with many tracks are
+ *  assigned first, each to the thread that has the fewest tracks so far.
+ */
+void
+Butler::assign_tracks (std::vector<boost::shared_ptr<Track> >& tracks)
+{
+	boost::shared_ptr<RouteList> routes = _session.get_routes ();
+
+	/* the route list is replaced whenever routes are added or removed.
+	 * Holding a weak_ptr (rather than its address) means that a new list
+	 * can not be mistaken for the one the cache was built for.
+	 */
+	if (_device_routes.lock () != routes) {
+		_track_device.clear ();
+		_device_routes = routes;
+	}
+
+	for (std::vector<boost::shared_ptr<Track> >::const_iterator i = tracks.begin (); i != tracks.end (); ++i) {
+		if (_track_device.find ((*i)->id ()) == _track_device.end ()) {
+			_track_device[(*i)->id ()] = track_device (*i);
+		}
+	}
+
+	std::stable_sort (tracks.begin (), tracks.end (), TrackDeviceSorter (_track_device));
+
+	/* [first, second) range of tracks for each device */
+	std::vector<std::pair<size_t, size_t> > groups;
+
+	for (size_t b = 0; b < tracks.size (); ) {
+		uint64_t const dev = _track_device[tracks[b]->id ()];
+		size_t         e   = b + 1;
+		while (e < tracks.size () && _track_device[tracks[e]->id ()] == dev) {
+			++e;
+		}
+		groups.push_back (std::make_pair (b, e));
+		b = e;
+	}
+
+	std::stable_sort (groups.begin (), groups.end (), TrackGroupSizeSorter ());
+
+	for (std::vector<std::pair<size_t, size_t> >::const_iterator g = groups.begin (); g != groups.end (); ++g) {
+		Worker* w = _workers.front ();
+		for (std::vector<Worker*>::const_iterator i = _workers.begin (); i != _workers.end (); ++i) {
+			if ((*i)->tracks.size () < w->tracks.size ()) {
+				w = *i;
+			}
+		}
+		w->tracks.insert (w->tracks.end (), tracks.begin () + g->first, tracks.begin () + g->second);
+	}
+}
+
+/** @return an ID of the device that holds the files of @param tr */
+uint64_t
+Butler::track_device (boost::shared_ptr<Track> tr) const
+{
+#ifdef PLATFORM_WINDOWS
+	return 0;
+#else
+	std::string dir;
+
+	boost::shared_ptr<Playlist> pl = tr->playlist ();
+
+	if (pl) {
+		boost::shared_ptr<RegionList> regions = pl->region_list ();
+		for (RegionList::const_iterator r = regions->begin (); r != regions->end () && dir.empty (); ++r) {
+			boost::shared_ptr<FileSource> fs = boost::dynamic_pointer_cast<FileSource> ((*r)->source (0));
+			if (fs) {
+				dir = Glib::path_get_dirname (fs->path ());
+			}
+		}
+	}
+
+	if (dir.empty ()) {
+		/* new recordings go to the session */
+		dir = _session.session_directory ().sound_path ();
+	}
+
+	GStatBuf statbuf;
+
+	if (g_stat (dir.c_str (), &statbuf) != 0) {
+		return 0;
+	}
+
+	return statbuf.st_dev;
+#endif
+}
+
 bool
 Butler::flush_tracks_to_disk_after_locate (boost::shared_ptr<RouteList> rl, uint32_t& errors)
 {
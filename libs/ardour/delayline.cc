@@ -55,6 +55,26 @@ DelayLine::set_name (const string& name)
 	return Processor::set_name (string_compose ("latcomp-%1-%2", name, this));
 }
 
+/** Add the events [first, last) of another buffer to @param dst, all at once
+ *  if there is enough space, otherwise as many as fit one at a time.
+ *  @return the end of the events that were added
+ */
+static MidiBuffer::const_iterator
+merge_events (MidiBuffer& dst, MidiBuffer::const_iterator first, MidiBuffer::const_iterator const& last)
+{
+	if (dst.merge_in_place (first, last)) {
+		return last;
+	}
+
+	for (; first != last; ++first) {
+		const Evoral::Event<MidiBuffer::TimeType> ev (*first, false);
+		if (!dst.insert_event (ev)) {
+			break;
+		}
+	}
+	return first;
+}
+
 #define FADE_LEN (128)
 
 void
@@ -253,15 +273,19 @@ DelayLine::run (BufferSet& bufs, samplepos_t /* start_sample */, samplepos_t /*
 			}
 
 			// move events from dly-buffer into current-buffer until n_samples
-			// and remove them from the dly-buffer
-			for (MidiBuffer::iterator m = dly->begin (); m != dly->end ();) {
-				const Evoral::Event<MidiBuffer::TimeType> ev (*m, false);
-				if (ev.time () >= n_samples) {
-					break;
-				}
-				mb.insert_event (ev);
-				m = dly->erase (m);
+			// and remove them from the dly-buffer. Both are sorted, so this
+			// is a single merge of the leading events. Events that do not
+			// fit stay in the dly-buffer, and are due in the next cycle.
+			const MidiBuffer& pending (*dly);
+			MidiBuffer::const_iterator split = pending.begin ();
+			while (split != pending.end () && (*split).time () < n_samples) {
+				++split;
 			}
+			MidiBuffer::const_iterator const moved = merge_events (mb, pending.begin (), split);
+			if (moved != split) {
+				cerr << "DelayLine: MIDI buffer overflow, delayed events postponed.\n";
+			}
+			dly->erase (dly->begin (), MidiBuffer::iterator (*dly, moved.offset));
 
 			/* For now, this is only relevant if there is there's a positive delay.
 			 * In the future this could also be used to delay 'too early' events
@@ -270,15 +294,15 @@ DelayLine::run (BufferSet& bufs, samplepos_t /* start_sample */, samplepos_t /*
 			if (_delay != 0) {
 				// move events after n_samples from current-buffer into dly-buffer
 				// and trim current-buffer after n_samples
-				for (MidiBuffer::iterator m = mb.begin (); m != mb.end ();) {
-					const Evoral::Event<MidiBuffer::TimeType> ev (*m, false);
-					if (ev.time () < n_samples) {
-						++m;
-						continue;
-					}
-					dly->insert_event (ev);
-					m = mb.erase (m);
+				const MidiBuffer& current (mb);
+				MidiBuffer::const_iterator late = current.begin ();
+				while (late != current.end () && (*late).time () < n_samples) {
+					++late;
+				}
+				if (merge_events (*dly, late, current.end ()) != current.end ()) {
+					cerr << "DelayLine: MIDI delay buffer overflow, events dropped.\n";
 				}
+				mb.erase (MidiBuffer::iterator (mb, late.offset), mb.end ());
 			}
 		}
 	}
@@ -1098,9 +1098,15 @@ DiskReader::audio_read (Sample*            sum_buffer,
 
 int
 DiskReader::do_refill ()
+{
+	return do_refill (_sum_buffer, _mixdown_buffer, _gain_buffer);
+}
+
+int
+DiskReader::do_refill (Sample* sum_buffer, Sample* mixdown_buffer, gain_t* gain_buffer)
 {
 	const bool reversed = !_session.transport_will_roll_forwards ();
-	return refill (_sum_buffer, _mixdown_buffer, _gain_buffer, 0, reversed);
+	return refill (sum_buffer, mixdown_buffer, gain_buffer, 0, reversed);
 }
 
 int
@@ -1137,6 +1143,106 @@ DiskReader::refill (Sample* sum_buffer, Sample* mixdown_buffer, float* gain_buff
 	return 0;
 }
 
+/** @return the number of samples to read from disk per channel, when there
+ *  are total_space samples to fill.
+ */
+samplecnt_t
+DiskReader::refill_chunk_samples (samplecnt_t total_space) const
+{
+	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
+	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format ());
+	size_t       total_bytes     = total_space * bits_per_sample / 8;
+
+	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer */
+	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
+
+	/* find nearest (lower) multiple of 16384 */
+
+	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
+
+	/* now back to samples */
+	return byte_size_for_read / (bits_per_sample / 8);
+}
+
+/** Ask the playlist to prefetch what the next refill_audio() will read */
+void
+DiskReader::prefetch ()
+{
+	if (!Config->get_disk_read_prefetch () || _session.loading () || !_playlists[DataType::AUDIO]) {
+		return;
+	}
+
+	boost::shared_ptr<ChannelList> c = channels.reader ();
+
+	if (c->empty ()) {
+		return;
+	}
+
+	samplecnt_t total_space = c->front ()->rbuf->write_space ();
+
+	/* same as refill_audio(): don't bother with small reads */
+	if (total_space == 0 || ((total_space < _chunk_samples) && fabs (_session.transport_speed ()) < 2.0f)) {
+		return;
+	}
+
+	const bool reversed = !_session.transport_will_roll_forwards ();
+	prefetch_audio (file_sample[DataType::AUDIO], min (total_space, refill_chunk_samples (total_space)), reversed);
+}
+
+/** Ask the playlist to prefetch what seek (sample) will read */
+void
+DiskReader::prefetch_seek (samplepos_t sample)
+{
+	if (!Config->get_disk_read_prefetch () || _session.loading () || !_playlists[DataType::AUDIO]) {
+		return;
+	}
+
+	boost::shared_ptr<ChannelList> c = channels.reader ();
+
+	if (c->empty () || can_internal_playback_seek (sample - playback_sample)) {
+		return;
+	}
+
+	const bool  reversed = !_session.transport_will_roll_forwards ();
+	samplecnt_t shift    = sample > c->front ()->rbuf->reservation_size () ? c->front ()->rbuf->reservation_size () : sample;
+
+	if (reversed) {
+		shift = -shift;
+	}
+
+	/* seek() does a complete refill */
+	prefetch_audio (sample - shift, c->front ()->rbuf->bufsize (), reversed);
+}
+
+/** Like audio_read() but only hint the playlist at what is going to be read */
+void
+DiskReader::prefetch_audio (samplepos_t start, samplecnt_t cnt, bool reversed)
+{
+	if (reversed) {
+		cnt = min (cnt, start);
+		audio_playlist ()->prefetch (start - cnt, cnt);
+		return;
+	}
+
+	Location* loc = _loop_location;
+
+	if (loc) {
+		const samplepos_t loop_start = loc->start ();
+		const samplepos_t loop_end   = loc->end ();
+
+		const Evoral::Range<samplepos_t> loop_range (loop_start, loop_end - 1);
+		start = loop_range.squish (start);
+
+		if (loop_end - start < cnt) {
+			audio_playlist ()->prefetch (start, loop_end - start);
+			cnt   = min (cnt - (loop_end - start), loop_end - loop_start);
+			start = loop_start;
+		}
+	}
+
+	audio_playlist ()->prefetch (start, cnt);
+}
+
 /** Get some more data from disk and put it in our channels' bufs,
  *  if there is suitable space in them.
  *
@@ -1255,19 +1361,7 @@ DiskReader::refill_audio (Sample* sum_buffer, Sample* mixdown_buffer, float* gai
 		}
 	}
 
-	/* total_space is in samples. We want to optimize read sizes in various sizes using bytes */
-	const size_t bits_per_sample = format_data_width (_session.config.get_native_file_data_format ());
-	size_t       total_bytes     = total_space * bits_per_sample / 8;
-
-	/* chunk size range is 256kB to 4MB. Bigger is faster in terms of MB/sec, but bigger chunk size always takes longer */
-	size_t byte_size_for_read = max ((size_t) (256 * 1024), min ((size_t) (4 * 1048576), total_bytes));
-
-	/* find nearest (lower) multiple of 16384 */
-
-	byte_size_for_read = (byte_size_for_read / 16384) * 16384;
-
-	/* now back to samples */
-	samplecnt_t samples_to_read = byte_size_for_read / (bits_per_sample / 8);
+	samplecnt_t samples_to_read = refill_chunk_samples (total_space);
 
 	DEBUG_TRACE (DEBUG::DiskIO, string_compose ("%1: will refill %2 channels with %3 samples\n", name (), c->size (), total_space));
 
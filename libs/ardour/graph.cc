@@ -20,17 +20,30 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <map>
 #include <stdio.h>
+#include <stdlib.h>
+
+#if defined __linux__ && !defined PLATFORM_WINDOWS
+#include <sched.h>
+#endif
+
+#if defined(COMPILER_MSVC) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
 
 #include "pbd/compose.h"
 #include "pbd/debug_rt_alloc.h"
 #include "pbd/pthread_utils.h"
+#include "pbd/strsplit.h"
 
 #include "ardour/audioengine.h"
 #include "ardour/debug.h"
 #include "ardour/graph.h"
 #include "ardour/process_thread.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/route.h"
 #include "ardour/session.h"
 #include "ardour/types.h"
@@ -56,12 +69,70 @@ alloc_allowed ()
 
 #define g_atomic_uint_get(x) static_cast<guint> (g_atomic_int_get (x))
 
+/** hint to the CPU that this is a busy-wait loop */
+static inline void
+cpu_relax ()
+{
+#if defined(COMPILER_MSVC) && (defined(_M_IX86) || defined(_M_X64))
+	_mm_pause ();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause ();
+#elif defined(__aarch64__)
+	__asm__ __volatile__ ("yield");
+#endif
+}
+
+#ifdef CPU_SETSIZE
+static long const max_cpus = CPU_SETSIZE;
+#else
+static long const max_cpus = 1024;
+#endif
+
+/** parse a list of CPU cores, e.g. "2-5,8" */
+static std::vector<int>
+parse_cpu_list (std::string const& str)
+{
+	std::vector<int>         rv;
+	std::vector<std::string> ranges;
+	split (str, ranges, ',');
+
+	for (std::vector<std::string>::const_iterator i = ranges.begin (); i != ranges.end (); ++i) {
+		char*       end;
+		char const* s     = i->c_str ();
+		long        first = strtol (s, &end, 10);
+		long        last  = first;
+		if (end == s || first < 0) {
+			continue;
+		}
+		if (*end == '-') {
+			s    = end + 1;
+			last = strtol (s, &end, 10);
+			if (end == s || last < first) {
+				continue;
+			}
+		}
+		if (last >= max_cpus) {
+			warning << string_compose (_("dsp-thread-cpus: ignoring CPUs above %1"), max_cpus - 1) << endmsg;
+			if (first >= max_cpus) {
+				continue;
+			}
+			last = max_cpus - 1;
+		}
+		for (long c = first; c <= last; ++c) {
+			rv.push_back (c);
+		}
+	}
+	return rv;
+}
+
 Graph::Graph (Session& session)
 	: SessionHandleRef (session)
 	, _execution_sem ("graph_execution", 0)
 	, _callback_start_sem ("graph_start", 0)
 	, _callback_done_sem ("graph_done", 0)
 	, _graph_empty (true)
+	, _max_spin_usecs (0)
+	, _last_priority_update (0)
 	, _current_chain (0)
 	, _pending_chain (0)
 	, _setup_chain (1)
@@ -71,9 +142,17 @@ Graph::Graph (Session& session)
 	g_atomic_int_set (&_n_workers, 0);
 	g_atomic_int_set (&_idle_thread_cnt, 0);
 	g_atomic_int_set (&_trigger_queue_size, 0);
+	g_atomic_int_set (&_priority_update_pending, 0);
 
 	_n_terminal_nodes[0] = 0;
 	_n_terminal_nodes[1] = 0;
+	_n_nodes[0]          = 0;
+	_n_nodes[1]          = 0;
+	_critical_path[0]    = 0;
+	_critical_path[1]    = 0;
+
+	_critical_path_cost[0] = 0;
+	_critical_path_cost[1] = 0;
 
 	/* pre-allocate memory */
 	_trigger_queue.reserve (1024);
@@ -128,6 +207,19 @@ Graph::reset_thread_list ()
 	/* Allow threads to run */
 	g_atomic_int_set (&_terminate, 0);
 
+	_thread_cpus = parse_cpu_list (Config->get_dsp_thread_cpus ());
+
+	/* one work-stealing deque per thread, any thread may
+	 * trigger all nodes, so size them for the whole graph */
+	assert (_workers.empty ());
+	for (uint32_t i = 0; i < num_threads; ++i) {
+		Worker* w = new Worker;
+		w->deque.reserve (std::max<size_t> (1024, _n_nodes[_current_chain]));
+		w->reset_stats ();
+		w->spin_usecs = G_MAXINT64; // start at the configured maximum
+		_workers.push_back (w);
+	}
+
 	if (AudioEngine::instance ()->create_process_thread (boost::bind (&Graph::main_thread, this)) != 0) {
 		throw failed_constructor ();
 	}
@@ -181,6 +273,11 @@ Graph::drop_threads ()
 	g_atomic_int_set (&_n_workers, 0);
 	g_atomic_int_set (&_idle_thread_cnt, 0);
 
+	for (std::vector<Worker*>::iterator i = _workers.begin (); i != _workers.end (); ++i) {
+		delete *i;
+	}
+	_workers.clear ();
+
 	/* signal main process thread if it's waiting for an already terminated thread */
 	_callback_done_sem.signal ();
 
@@ -210,6 +307,7 @@ Graph::clear_other_chain ()
 		if (_setup_chain != _pending_chain) {
 			for (node_list_t::iterator ni = _nodes_rt[_setup_chain].begin (); ni != _nodes_rt[_setup_chain].end (); ++ni) {
 				(*ni)->_activation_set[_setup_chain].clear ();
+				(*ni)->_activation_list[_setup_chain].clear ();
 			}
 
 			_nodes_rt[_setup_chain].clear ();
@@ -233,13 +331,24 @@ Graph::prep ()
 			_setup_chain   = _current_chain;
 			_current_chain = _pending_chain;
 			/* ensure that all nodes can be queued */
-			_trigger_queue.reserve (_nodes_rt[_current_chain].size ());
+			_trigger_queue.reserve (_n_nodes[_current_chain]);
+			for (std::vector<Worker*>::iterator w = _workers.begin (); w != _workers.end (); ++w) {
+				(*w)->deque.reserve (_n_nodes[_current_chain]);
+			}
 			assert (g_atomic_uint_get (&_trigger_queue_size) == 0);
 			_cleanup_cond.signal ();
 		}
 		_swap_mutex.unlock ();
 	}
 
+	/* All other threads are idle and all deques are empty.
+	 * Rewind the indices, so that they never overflow.
+	 */
+	for (std::vector<Worker*>::iterator w = _workers.begin (); w != _workers.end (); ++w) {
+		assert ((*w)->deque.empty ());
+		(*w)->deque.reset ();
+	}
+
 	_graph_empty = true;
 
 	int chain = _current_chain;
@@ -254,6 +363,10 @@ Graph::prep ()
 
 	g_atomic_int_set (&_terminal_refcnt, _n_terminal_nodes[chain]);
 
+	/* idle threads may poll for work, at most for a quarter of a cycle */
+	_max_spin_usecs = std::min<gint64> (Config->get_dsp_thread_spin_usecs (),
+	                                    250000 * (gint64)_process_nframes / _session.nominal_sample_rate ());
+
 	/* Trigger the initial nodes for processing, which are the ones at the `input' end */
 	for (i = _init_trigger_list[chain].begin (); i != _init_trigger_list[chain].end (); i++) {
 		g_atomic_int_inc (&_trigger_queue_size);
@@ -261,11 +374,96 @@ Graph::prep ()
 	}
 }
 
+/** Called from a DSP thread when all of a node's inputs are ready.
+ * The node is queued on the calling thread's deque, other threads can steal it.
+ */
 void
-Graph::trigger (GraphNode* n)
+Graph::trigger (GraphNode* n, uint32_t tid)
 {
+	assert (tid < _workers.size ());
 	g_atomic_int_inc (&_trigger_queue_size);
-	_trigger_queue.push_back (n);
+	_workers[tid]->deque.push_back (n);
+}
+
+/** Find a node to process, preferably one that was triggered by this thread
+ * (its input is still hot in this CPU's cache), next one of the initial nodes,
+ * and finally steal from other threads.
+ */
+bool
+Graph::find_work (uint32_t tid, GraphNode*& n)
+{
+	Worker* w = _workers[tid];
+
+	if (w->deque.pop_back (n)) {
+		++w->local_runs;
+		return true;
+	}
+
+	if (_trigger_queue.pop_front (n)) {
+		++w->queue_runs;
+		return true;
+	}
+
+	size_t const n_workers = _workers.size ();
+	for (size_t i = 1; i < n_workers; ++i) {
+		Worker* victim = _workers[(tid + i) % n_workers];
+		if (victim->deque.empty ()) {
+			continue;
+		}
+		if (victim->deque.steal (n)) {
+			++w->steals;
+			return true;
+		}
+		++w->failed_steals;
+	}
+	return false;
+}
+
+/** Accumulate per thread statistics of the cycle that just completed.
+ * Must only be called while all other threads are idle.
+ */
+void
+Graph::collect_stats ()
+{
+	int chain = _current_chain;
+
+	GraphStats s;
+	s.n_nodes       = _n_nodes[chain];
+	s.n_threads     = _workers.size ();
+	s.critical_path = _critical_path[chain];
+	s.critical_path_usec = _critical_path_cost[chain];
+
+	for (std::vector<Worker*>::iterator i = _workers.begin (); i != _workers.end (); ++i) {
+		Worker* w = *i;
+		s.local_runs    += w->local_runs;
+		s.queue_runs    += w->queue_runs;
+		s.steals        += w->steals;
+		s.failed_steals += w->failed_steals;
+		s.idle_waits    += w->idle_waits;
+		s.spin_hits     += w->spin_hits;
+		s.spin_misses   += w->spin_misses;
+		w->reset_stats ();
+	}
+
+	_stats = s;
+
+	/* node costs are only measured while processing, ask for priorities
+	 * to be updated now and then (see Session::emit_thread_run) */
+	gint64 now = g_get_monotonic_time ();
+	if (now - _last_priority_update > 1000000) {
+		_last_priority_update = now;
+		g_atomic_int_set (&_priority_update_pending, 1);
+	}
+}
+
+/** Retrieve scheduler statistics of the last completed process cycle.
+ * This is not synchronized with the process thread, values are
+ * only meant for diagnostics.
+ */
+void
+Graph::stats (GraphStats& s) const
+{
+	s = _stats;
 }
 
 /** Called when a node at the `output' end of the chain (ie one that has no-one to feed)
@@ -293,10 +491,18 @@ Graph::reached_terminal_node ()
 		 * threads may only be "on the way" to become idle.
 		 */
 		guint n_workers = g_atomic_uint_get (&_n_workers);
-		while (g_atomic_uint_get (&_idle_thread_cnt) != n_workers) {
-			sched_yield ();
+		for (guint i = 0; g_atomic_uint_get (&_idle_thread_cnt) != n_workers; ++i) {
+			if (_max_spin_usecs > 0 && i < 256) {
+				/* threads stop polling as soon as the cycle is complete,
+				 * don't give up the CPU just yet */
+				cpu_relax ();
+			} else {
+				sched_yield ();
+			}
 		}
 
+		collect_stats ();
+
 		/* Block until the a process callback */
 		_callback_start_sem.wait ();
 
@@ -342,12 +548,15 @@ Graph::rechain (boost::shared_ptr<RouteList> routelist, GraphEdges const& edges)
 	_init_trigger_list[chain].clear ();
 
 	_nodes_rt[chain].clear ();
+	_n_nodes[chain] = 0;
 
 	/* Clear things out, and make _nodes_rt[chain] a copy of routelist */
 	for (RouteList::iterator ri = routelist->begin (); ri != routelist->end (); ri++) {
 		(*ri)->_init_refcount[chain] = 0;
 		(*ri)->_activation_set[chain].clear ();
+		(*ri)->_activation_list[chain].clear ();
 		_nodes_rt[chain].push_back (*ri);
+		++_n_nodes[chain];
 	}
 
 	// now add refs for the connections.
@@ -387,13 +596,212 @@ Graph::rechain (boost::shared_ptr<RouteList> routelist, GraphEdges const& edges)
 		}
 	}
 
+	compute_priorities (chain);
+
 	_pending_chain = chain;
 	dump (chain);
 }
 
+struct Graph::NodePriorityCmp {
+	NodePriorityCmp (int c, bool d) : chain (c), descending (d) {}
+
+	bool operator() (GraphNode const* a, GraphNode const* b) const {
+		if (descending) {
+			return a->_priority[chain] > b->_priority[chain];
+		}
+		return a->_priority[chain] < b->_priority[chain];
+	}
+
+	bool operator() (node_ptr_t const& a, node_ptr_t const& b) const {
+		return (*this) (a.get (), b.get ());
+	}
+
+	int  chain;
+	bool descending;
+};
+
+/** Calculate the longest chain of dependent nodes, and for every node the
+ * estimated time to process it and all nodes that depend on it (using the
+ * average time it took to process each node during the last cycles).
+ *
+ * Initial nodes are queued in order of decreasing priority, and each
+ * node triggers the nodes it feeds in order of ascending priority (the
+ * last one is processed next by the same thread). This way long chains
+ * of expensive nodes are started first and the cycle finishes earlier.
+ */
+void
+Graph::compute_priorities (int chain)
+{
+	std::map<GraphNode*, gint>  seen;
+	std::map<GraphNode*, guint> depth;
+	std::vector<GraphNode*>     order;
+
+	for (node_list_t::const_iterator i = _init_trigger_list[chain].begin (); i != _init_trigger_list[chain].end (); ++i) {
+		depth[i->get ()] = 1;
+		order.push_back (i->get ());
+	}
+
+	/* topological traversal */
+	guint max_depth = 0;
+	for (size_t o = 0; o < order.size (); ++o) {
+		GraphNode* n = order[o];
+		guint      d = depth[n];
+		max_depth    = std::max (max_depth, d);
+		for (node_set_t::const_iterator a = n->_activation_set[chain].begin (); a != n->_activation_set[chain].end (); ++a) {
+			GraphNode* fed = a->get ();
+			depth[fed]     = std::max (depth[fed], d + 1);
+			if (++seen[fed] == fed->_init_refcount[chain]) {
+				order.push_back (fed);
+			}
+		}
+	}
+
+	/* longest path to a terminal node, in reverse topological order */
+	NodePriorityCmp cmp (chain, false);
+	float           max_cost = 0;
+	for (std::vector<GraphNode*>::reverse_iterator o = order.rbegin (); o != order.rend (); ++o) {
+		GraphNode* n = *o;
+		float      p = 0;
+		n->_activation_list[chain].clear ();
+		for (node_set_t::const_iterator a = n->_activation_set[chain].begin (); a != n->_activation_set[chain].end (); ++a) {
+			p = std::max (p, (*a)->_priority[chain]);
+			n->_activation_list[chain].push_back (a->get ());
+		}
+		std::sort (n->_activation_list[chain].begin (), n->_activation_list[chain].end (), cmp);
+		n->_planned_cost[chain] = n->cost ();
+		n->_priority[chain]     = p + std::max (n->_planned_cost[chain], 1.f);
+		max_cost = std::max (max_cost, n->_priority[chain]);
+	}
+
+	_init_trigger_list[chain].sort (NodePriorityCmp (chain, true));
+
+	_critical_path[chain]      = max_depth;
+	_critical_path_cost[chain] = max_cost;
+}
+
+/** @return true if the cost of any node differs significantly from
+ * the cost that was used to calculate the priorities of the given chain.
+ */
+bool
+Graph::costs_changed (int chain) const
+{
+	for (node_list_t::const_iterator i = _nodes_rt[chain].begin (); i != _nodes_rt[chain].end (); ++i) {
+		float const planned = (*i)->_planned_cost[chain];
+		if (fabsf ((*i)->cost () - planned) > std::max (10.f, .25f * planned)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Re-calculate node priorities of the current chain using the most
+ * recent cost of each node. Priorities are otherwise only calculated
+ * when the graph is re-chained, at which time newly added nodes have
+ * not been processed yet.
+ *
+ * This must not be called from the process thread. The graph topology
+ * is copied to the setup chain, which is swapped in by the next cycle.
+ */
+void
+Graph::update_priorities ()
+{
+	if (!g_atomic_int_compare_and_exchange (&_priority_update_pending, 1, 0)) {
+		return;
+	}
+
+	Glib::Threads::Mutex::Lock ls (_swap_mutex);
+
+	if (_current_chain != _pending_chain) {
+		/* a new chain is about to be used, its priorities are up to date */
+		return;
+	}
+
+	int const cur   = _current_chain;
+	int const chain = _setup_chain;
+
+	if (!costs_changed (cur)) {
+		return;
+	}
+
+	DEBUG_TRACE (DEBUG::Graph, string_compose ("============== update priorities %1 -> %2\n", cur, chain));
+
+	for (node_list_t::iterator ni = _nodes_rt[chain].begin (); ni != _nodes_rt[chain].end (); ++ni) {
+		(*ni)->_activation_set[chain].clear ();
+		(*ni)->_activation_list[chain].clear ();
+	}
+
+	for (node_list_t::iterator ni = _nodes_rt[cur].begin (); ni != _nodes_rt[cur].end (); ++ni) {
+		(*ni)->_init_refcount[chain] = (*ni)->_init_refcount[cur];
+		(*ni)->_activation_set[chain] = (*ni)->_activation_set[cur];
+	}
+
+	_nodes_rt[chain]          = _nodes_rt[cur];
+	_init_trigger_list[chain] = _init_trigger_list[cur];
+	_n_terminal_nodes[chain]  = _n_terminal_nodes[cur];
+	_n_nodes[chain]           = _n_nodes[cur];
+
+	compute_priorities (chain);
+
+	_pending_chain = chain;
+}
+
+/** Poll for work for a short while before going to sleep, to avoid the
+ * wake-up latency of the semaphore. The time spent polling adapts: it is
+ * doubled whenever work showed up, and halved whenever polling timed out.
+ */
+bool
+Graph::spin_for_work (uint32_t tid, GraphNode*& n)
+{
+	gint64 const max_spin = _max_spin_usecs;
+
+	if (max_spin <= 0) {
+		return false;
+	}
+
+	Worker* w     = _workers[tid];
+	w->spin_usecs = std::max<gint64> (1, std::min (w->spin_usecs, max_spin));
+
+	gint64 const deadline = g_get_monotonic_time () + w->spin_usecs;
+
+	for (guint i = 1; !g_atomic_int_get (&_terminate); ++i) {
+		if (g_atomic_uint_get (&_trigger_queue_size) > 0 && find_work (tid, n)) {
+			w->spin_usecs = std::min (max_spin, 2 * w->spin_usecs);
+			++w->spin_hits;
+			return true;
+		}
+		if (g_atomic_uint_get (&_terminal_refcnt) == 0) {
+			/* the cycle is complete, no more work will show up */
+			return false;
+		}
+		cpu_relax ();
+		if ((i % 64) == 0 && g_get_monotonic_time () > deadline) {
+			break;
+		}
+	}
+
+	w->spin_usecs /= 2;
+	++w->spin_misses;
+	return false;
+}
+
+/** Restrict the calling DSP thread to the CPU configured by dsp-thread-cpus */
+void
+Graph::set_thread_affinity (uint32_t tid)
+{
+	if (_thread_cpus.empty ()) {
+		return;
+	}
+	int cpu = _thread_cpus[tid % _thread_cpus.size ()];
+	if (pbd_set_thread_affinity (pthread_self (), cpu)) {
+		warning << string_compose (_("Cannot restrict DSP thread %1 to CPU %2"), tid, cpu) << endmsg;
+	} else {
+		DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 runs on CPU %2\n", pthread_name (), cpu));
+	}
+}
+
 /** Called by both the main thread and all helpers. */
 void
-Graph::run_one ()
+Graph::run_one (uint32_t tid)
 {
 	GraphNode* to_run = NULL;
 
@@ -401,9 +809,9 @@ Graph::run_one ()
 		return;
 	}
 
-	if (_trigger_queue.pop_front (to_run)) {
+	if (find_work (tid, to_run) || spin_for_work (tid, to_run)) {
 		/* Wake up idle threads, but at most as many as there's
-		 * work in the trigger queue that can be processed by
+		 * work in the trigger queues that can be processed by
 		 * other threads.
 		 * This thread as not yet decreased _trigger_queue_size.
 		 */
@@ -419,6 +827,7 @@ Graph::run_one ()
 
 	while (!to_run) {
 		/* Wait for work, fall asleep */
+		++_workers[tid]->idle_waits;
 		g_atomic_int_inc (&_idle_thread_cnt);
 		assert (g_atomic_uint_get (&_idle_thread_cnt) <= _n_workers);
 
@@ -434,12 +843,12 @@ Graph::run_one ()
 		g_atomic_int_dec_and_test (&_idle_thread_cnt);
 
 		/* Try to find some work to do */
-		_trigger_queue.pop_front (to_run);
+		find_work (tid, to_run);
 	}
 
 	/* Process the graph-node */
 	g_atomic_int_dec_and_test (&_trigger_queue_size);
-	to_run->run (_current_chain);
+	to_run->run (_current_chain, tid);
 
 	DEBUG_TRACE (DEBUG::ProcessThreads, string_compose ("%1 has finished run_one()\n", pthread_name ()));
 }
@@ -447,8 +856,9 @@ Graph::run_one ()
 void
 Graph::helper_thread ()
 {
-	g_atomic_int_inc (&_n_workers);
-	guint id = g_atomic_uint_get (&_n_workers);
+	/* thread-id 0 is the main thread, helpers use 1 .. N-1 */
+	guint id = g_atomic_int_add (&_n_workers, 1) + 1;
+	assert (id < _workers.size ());
 
 	/* This is needed for ARDOUR::Session requests called from rt-processors
 	 * in particular Lua scripts may do cross-thread calls */
@@ -460,6 +870,8 @@ Graph::helper_thread ()
 		PBD::notify_event_loops_about_thread_creation (pthread_self (), name, 64);
 	}
 
+	set_thread_affinity (id);
+
 	suspend_rt_malloc_checks ();
 	ProcessThread* pt = new ProcessThread ();
 	resume_rt_malloc_checks ();
@@ -467,7 +879,7 @@ Graph::helper_thread ()
 	pt->get_buffers ();
 
 	while (!g_atomic_int_get (&_terminate)) {
-		run_one ();
+		run_one (id);
 	}
 
 	pt->drop_buffers ();
@@ -492,6 +904,7 @@ Graph::main_thread ()
 		SessionEvent::create_per_thread_pool (name, 64);
 		PBD::notify_event_loops_about_thread_creation (pthread_self (), name, 64);
 	}
+	set_thread_affinity (0);
 	resume_rt_malloc_checks ();
 
 	pt->get_buffers ();
@@ -520,7 +933,7 @@ again:
 
 	/* After setup, the main-thread just becomes a normal worker */
 	while (!g_atomic_int_get (&_terminate)) {
-		run_one ();
+		run_one (0);
 	}
 
 	pt->drop_buffers ();
@@ -539,7 +952,7 @@ Graph::dump (int chain) const
 	DEBUG_TRACE (DEBUG::Graph, "--------------------------------------------Graph dump:\n");
 	for (ni = _nodes_rt[chain].begin (); ni != _nodes_rt[chain].end (); ni++) {
 		boost::shared_ptr<Route> rp = boost::dynamic_pointer_cast<Route> (*ni);
-		DEBUG_TRACE (DEBUG::Graph, string_compose ("GraphNode: %1  refcount: %2\n", rp->name ().c_str (), (*ni)->_init_refcount[chain]));
+		DEBUG_TRACE (DEBUG::Graph, string_compose ("GraphNode: %1  refcount: %2 cost: %3 priority: %4\n", rp->name ().c_str (), (*ni)->_init_refcount[chain], (*ni)->cost (), (*ni)->_priority[chain]));
 		for (ai = (*ni)->_activation_set[chain].begin (); ai != (*ni)->_activation_set[chain].end (); ai++) {
 			DEBUG_TRACE (DEBUG::Graph, string_compose ("  triggers: %1\n", boost::dynamic_pointer_cast<Route> (*ai)->name ().c_str ()));
 		}
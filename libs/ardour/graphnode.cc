@@ -27,6 +27,11 @@ using namespace ARDOUR;
 GraphNode::GraphNode (boost::shared_ptr<Graph> graph)
 	: _graph (graph)
 {
+	CostBits c;
+	c.f = 1.f;
+	g_atomic_int_set (&_cost, c.i);
+	_priority[0] = _priority[1] = 0.f;
+	_planned_cost[0] = _planned_cost[1] = 0.f;
 }
 
 GraphNode::~GraphNode ()
@@ -40,9 +45,11 @@ GraphNode::prep (int chain)
 	g_atomic_int_set (&_refcount, _init_refcount[chain]);
 }
 
-/** Called by an upstream node, when it has completed processing */
+/** Called by an upstream node, when it has completed processing.
+ * @param tid the DSP thread that processed the upstream node
+ */
 void
-GraphNode::trigger ()
+GraphNode::trigger (uint32_t tid)
 {
 	/* check if we can run */
 	if (g_atomic_int_dec_and_test (&_refcount)) {
@@ -51,19 +58,36 @@ GraphNode::trigger ()
 		g_atomic_int_set (&_refcount, _init_refcount[chain]);
 #endif
 		/* All nodes that feed this node have completed, so this node be processed now. */
-		_graph->trigger (this);
+		_graph->trigger (this, tid);
 	}
 }
 
 void
-GraphNode::finish (int chain)
+GraphNode::run (int chain, uint32_t tid)
+{
+	gint64 start = g_get_monotonic_time ();
+	process ();
+	/* running average over the last ~32 cycles, used by Graph to
+	 * prioritize nodes on the critical path. Only this thread writes
+	 * the cost while the node runs, others merely read it. */
+	CostBits c;
+	c.i = g_atomic_int_get (&_cost);
+	c.f += ((float)(g_get_monotonic_time () - start) - c.f) / 32.f;
+	g_atomic_int_set (&_cost, c.i);
+	finish (chain, tid);
+}
+
+void
+GraphNode::finish (int chain, uint32_t tid)
 {
-	node_set_t::iterator i;
-	bool                 feeds = false;
+	std::vector<GraphNode*>::const_iterator i;
+	bool                                    feeds = false;
 
-	/* Notify downstream nodes that depend on this node */
-	for (i = _activation_set[chain].begin (); i != _activation_set[chain].end (); ++i) {
-		(*i)->trigger ();
+	/* Notify downstream nodes that depend on this node.
+	 * The most important node is triggered last, so that
+	 * it will be the next node processed by this thread. */
+	for (i = _activation_list[chain].begin (); i != _activation_list[chain].end (); ++i) {
+		(*i)->trigger (tid);
 		feeds = true;
 	}
 
@@ -1563,6 +1563,7 @@ LuaBindings::common (lua_State* L)
 		.addFunction ("is_channelstrip", &PluginInsert::is_channelstrip)
 		.addFunction ("clear_stats", &PluginInsert::clear_stats)
 		.addRefFunction ("get_stats", &PluginInsert::get_stats)
+		.addRefFunction ("get_automation_split_stats", &PluginInsert::get_automation_split_stats)
 		.endClass ()
 
 		.deriveWSPtrClass <ReadOnlyControl, PBD::StatefulDestructible> ("ReadOnlyControl")
@@ -1680,6 +1681,8 @@ LuaBindings::common (lua_State* L)
 		.endClass ()
 
 		.deriveWSPtrClass <PluginInsert::PluginControl, AutomationControl> ("PluginControl")
+		.addFunction ("automation_min_block", &PluginInsert::PluginControl::automation_min_block)
+		.addFunction ("set_automation_min_block", &PluginInsert::PluginControl::set_automation_min_block)
 		.endClass ()
 
 		.beginClass <RawMidiParser> ("RawMidiParser")
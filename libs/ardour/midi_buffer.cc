@@ -435,165 +435,133 @@ MidiBuffer::second_simultaneous_midi_byte_is_first (uint8_t a, uint8_t b)
 /** Merge \a other into this buffer.  Realtime safe. */
 bool
 MidiBuffer::merge_in_place (const MidiBuffer &other)
+{
+	return merge_in_place (other.begin(), other.end());
+}
+
+/** Merge the events [\a first, \a last) of another buffer into this buffer.
+ *
+ * Our own events are first moved to the end of the buffer, then both
+ * buffers are merged into it from the front, so every byte is copied at
+ * most twice, independent of how the events interleave.
+ *
+ * Realtime safe.
+ */
+bool
+MidiBuffer::merge_in_place (const_iterator const & first, const_iterator const & last)
 {
 	const size_t header_size = sizeof(TimeType) + sizeof(Evoral::EventType);
 
-	if (other.size() && size()) {
-		DEBUG_TRACE (DEBUG::MidiIO, string_compose ("merge in place, sizes %1/%2\n", size(), other.size()));
+	assert (first.buffer == last.buffer);
+	assert (first.buffer != this);
+	assert (first.offset <= last.offset);
+
+	const MidiBuffer& other (*first.buffer);
+	const size_t other_size = last.offset - first.offset;
+
+	if (other_size && size()) {
+		DEBUG_TRACE (DEBUG::MidiIO, string_compose ("merge in place, sizes %1/%2\n", size(), other_size));
 	}
 
-	if (other.size() == 0) {
+	if (other_size == 0) {
 		return true;
 	}
 
-	if (size() + other.size() > _capacity) {
+	if (size() + other_size > _capacity) {
 		return false;
 	}
 
 	if (size() == 0) {
-		copy (other);
+		memcpy (_data, other._data + first.offset, other_size);
+		_size = other_size;
 		return true;
 	}
 
-	const_iterator them = other.begin();
-	iterator us = begin();
-
-	while (them != other.end()) {
-
-		size_t bytes_to_merge;
-		ssize_t merge_offset;
-
-		/* gather up total size of events that are earlier than
-		   the event referenced by "us"
-		*/
-
-		merge_offset = -1;
-		bytes_to_merge = 0;
-
-		while (them != other.end() && (*them).time() < (*us).time()) {
-			if (merge_offset == -1) {
-				merge_offset = them.offset;
-			}
-			bytes_to_merge += align32 (header_size + (*them).size());
-			++them;
-		}
-
-		/* "them" now points to either:
-		 *
-		 * 1) an event that has the same or later timestamp than the
-		 *        event pointed to by "us"
-		 *
-		 * OR
-		 *
-		 * 2) the end of the "other" buffer
-		 *
-		 * if "sz" is non-zero, there is data to be merged from "other"
-		 * into this buffer before we do anything else, corresponding
-		 * to the events from "other" that we skipped while advancing
-		 * "them".
-		 */
-
-		if (bytes_to_merge) {
-			assert(merge_offset >= 0);
-			/* move existing */
-			memmove (_data + us.offset + bytes_to_merge, _data + us.offset, _size - us.offset);
-			/* increase _size */
-			_size += bytes_to_merge;
-			assert (_size <= _capacity);
-			/* insert new stuff */
-			memcpy  (_data + us.offset, other._data + merge_offset, bytes_to_merge);
-			/* update iterator to our own events. this is a miserable hack */
-			us.offset += bytes_to_merge;
-		}
-
-		/* if we're at the end of the other buffer, we're done */
-
-		if (them == other.end()) {
-			break;
-		}
-
-		/* if we have two messages messages with the same timestamp. we
-		 * must order them correctly.
-		 */
+	/* move our own events out of the way. The regions may overlap, and
+	 * memmove may allocate, so copy by hand (back to front).
+	 */
 
-		if ((*us).time() == (*them).time()) {
+	const size_t gap = _capacity - _size;
 
-			DEBUG_TRACE (DEBUG::MidiIO,
-				     string_compose ("simultaneous MIDI events discovered during merge, times %1/%2 status %3/%4\n",
-						     (*us).time(), (*them).time(),
-						     (int) *(_data + us.offset + header_size),
-						     (int) *(other._data + them.offset + header_size)));
+	for (size_t n = _size; n > 0; --n) {
+		_data[gap + n - 1] = _data[n - 1];
+	}
 
-			uint8_t our_midi_status_byte = *(_data + us.offset + header_size);
-			uint8_t their_midi_status_byte = *(other._data + them.offset + header_size);
-			bool them_first = second_simultaneous_midi_byte_is_first (our_midi_status_byte, their_midi_status_byte);
+	/* Since the merged size fits in _capacity, the write position never
+	 * passes the read position of our own remaining events.
+	 */
 
-			DEBUG_TRACE (DEBUG::MidiIO, string_compose ("other message came first ? %1\n", them_first));
+	size_t us = gap;
+	size_t them = first.offset;
+	size_t out = 0;
 
-			if (!them_first) {
-				/* skip past our own event */
-				++us;
-			}
+	while (us < _capacity && them < last.offset) {
 
-			bytes_to_merge = align32 (header_size + (*them).size());
+		const TimeType our_time = *(reinterpret_cast<TimeType*>((uintptr_t)(_data + us)));
+		const TimeType their_time = *(reinterpret_cast<TimeType*>((uintptr_t)(other._data + them)));
 
-			/* move our remaining events later in the buffer by
-			 * enough to fit the one message we're going to merge
-			 */
+		bool them_first;
 
-			memmove (_data + us.offset + bytes_to_merge, _data + us.offset, _size - us.offset);
-			/* increase _size */
-			_size += bytes_to_merge;
-			assert(_size <= _capacity);
-			/* insert new stuff */
-			memcpy  (_data + us.offset, other._data + them.offset, bytes_to_merge);
-			/* update iterator to our own events. this is a miserable hack */
-			us.offset += bytes_to_merge;
-			/* 'us' is now an iterator to the event right after the
-			   new ones that we merged
-			*/
-			if (them_first) {
-				/* need to skip the event pointed to by 'us'
-				   since its at the same time as 'them'
-				   (still), and we'll enter
-				*/
-
-				if (us != end()) {
-					++us;
-				}
-			}
-
-			/* we merged one event from the other buffer, so
-			 * advance the iterator there.
+		if (our_time == their_time) {
+			/* if we have two messages messages with the same timestamp. we
+			 * must order them correctly.
 			 */
-
-			++them;
-
+			them_first = second_simultaneous_midi_byte_is_first (_data[us + header_size], other._data[them + header_size]);
 		} else {
+			them_first = their_time < our_time;
+		}
 
-			/* advance past our own events to get to the correct insertion
-			   point for the next event(s) from "other"
-			*/
-
-			while (us != end() && (*us).time() <= (*them).time()) {
-				++us;
+		if (them_first) {
+			const size_t sz = align32 (header_size + Evoral::midi_event_size (other._data + them + header_size));
+			memcpy (_data + out, other._data + them, sz);
+			them += sz;
+			out += sz;
+		} else {
+			const size_t sz = align32 (header_size + Evoral::midi_event_size (_data + us + header_size));
+			for (size_t n = 0; n < sz; ++n) {
+				_data[out + n] = _data[us + n];
 			}
+			us += sz;
+			out += sz;
 		}
+	}
 
-		/* check to see if we reached the end of this buffer while
-		 * looking for the insertion point.
-		 */
+	if (them < last.offset) {
+		/* append the rest of the other buffer */
+		memcpy (_data + out, other._data + them, last.offset - them);
+		out += last.offset - them;
+	}
 
-		if (us == end()) {
+	/* move the rest of our events down to the merged ones */
+	for (; us < _capacity; ++us, ++out) {
+		_data[out] = _data[us];
+	}
 
-			/* just append the rest of other and we're done*/
+	_size += other_size;
+	assert (out == _size);
 
-			memcpy (_data + us.offset, other._data + them.offset, other._size - them.offset);
-			_size += other._size - them.offset;
-			assert(_size <= _capacity);
-			break;
-		}
+	return true;
+}
+
+/** Remove the events [\a first, \a last).  Realtime safe.
+ * @return an iterator to the event that followed the removed ones.
+ */
+MidiBuffer::iterator
+MidiBuffer::erase (const iterator& first, const iterator& last)
+{
+	assert (first.buffer == this);
+	assert (last.buffer == this);
+	assert (first.offset <= last.offset);
+
+	/* we need to avoid the temporary malloc that memmove would do,
+	   so copy by hand.
+	*/
+	size_t a, b;
+	for (a = first.offset, b = last.offset; b < _size; ++b, ++a) {
+		_data[a] = _data[b];
 	}
 
-	return true;
+	_size -= last.offset - first.offset;
+
+	return iterator (*this, first.offset);
 }
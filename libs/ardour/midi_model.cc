@@ -25,10 +25,13 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <stdexcept>
 #include <stdint.h>
 
+#include <glib.h>
+
 #include "pbd/compose.h"
 #include "pbd/enumwriter.h"
 #include "pbd/error.h"
@@ -43,6 +46,7 @@
 #include "ardour/midi_model.h"
 #include "ardour/midi_source.h"
 #include "ardour/midi_state_tracker.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/session.h"
 #include "ardour/types.h"
 
@@ -60,10 +64,35 @@ using namespace PBD;
 
 MidiModel::MidiModel (boost::shared_ptr<MidiSource> s)
 	: AutomatableSequence<TimeType>(s->session())
+	, _edit_range_valid (false)
 {
 	set_midi_source (s);
 }
 
+void
+MidiModel::contents_changed (TimeType const & start, TimeType const & end)
+{
+	_edit_start = start;
+	_edit_end = end;
+	_edit_range_valid = true;
+
+	ContentsChanged (); /* EMIT SIGNAL */
+
+	_edit_range_valid = false;
+}
+
+bool
+MidiModel::edit_range (TimeType& start, TimeType& end) const
+{
+	if (!_edit_range_valid) {
+		return false;
+	}
+
+	start = _edit_start;
+	end = _edit_end;
+	return true;
+}
+
 MidiModel::NoteDiffCommand*
 MidiModel::new_note_diff_command (const string& name)
 {
@@ -230,12 +259,59 @@ MidiModel::NoteDiffCommand::operator+= (const NoteDiffCommand& other)
 	return *this;
 }
 
+/** Extend [start, end] to cover all notes touched by this command, using
+ * both their current times and the times they are being changed from/to.
+ */
+void
+MidiModel::NoteDiffCommand::extend_range (TimeType& start, TimeType& end) const
+{
+	NoteList const * lists[] = { &_added_notes, &_removed_notes };
+
+	for (size_t n = 0; n < 2; ++n) {
+		for (NoteList::const_iterator i = lists[n]->begin(); i != lists[n]->end(); ++i) {
+			start = std::min (start, (*i)->time());
+			end = std::max (end, (*i)->end_time());
+		}
+	}
+
+	for (set<NotePtr>::const_iterator i = side_effect_removals.begin(); i != side_effect_removals.end(); ++i) {
+		start = std::min (start, (*i)->time());
+		end = std::max (end, (*i)->end_time());
+	}
+
+	for (ChangeList::const_iterator i = _changes.begin(); i != _changes.end(); ++i) {
+		if (!i->note) {
+			continue;
+		}
+
+		start = std::min (start, i->note->time());
+		end = std::max (end, i->note->end_time());
+
+		switch (i->property) {
+		case StartTime:
+			start = std::min (start, std::min (i->old_value.get_beats(), i->new_value.get_beats()));
+			end = std::max (end, std::max (i->old_value.get_beats(), i->new_value.get_beats()) + i->note->length());
+			break;
+		case Length:
+			end = std::max (end, i->note->time() + std::max (i->old_value.get_beats(), i->new_value.get_beats()));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 void
 MidiModel::NoteDiffCommand::operator() ()
 {
+	TimeType start = std::numeric_limits<TimeType>::max();
+	TimeType end;
+
 	{
 		MidiModel::WriteLock lock(_model->edit_lock());
 
+		extend_range (start, end);
+
 		for (NoteList::iterator i = _added_notes.begin(); i != _added_notes.end(); ++i) {
 			if (!_model->add_note_unlocked(*i)) {
 				/* failed to add it, so don't leave it in the removed list, to
@@ -322,17 +398,24 @@ MidiModel::NoteDiffCommand::operator() ()
 				cerr << "\t" << *i << ' ' << **i << endl;
 			}
 		}
+
+		extend_range (start, end);
 	}
 
-	_model->ContentsChanged(); /* EMIT SIGNAL */
+	_model->contents_changed (start, end); /* EMIT SIGNAL */
 }
 
 void
 MidiModel::NoteDiffCommand::undo ()
 {
+	TimeType start = std::numeric_limits<TimeType>::max();
+	TimeType end;
+
 	{
 		MidiModel::WriteLock lock(_model->edit_lock());
 
+		extend_range (start, end);
+
 		for (NoteList::iterator i = _added_notes.begin(); i != _added_notes.end(); ++i) {
 			_model->remove_note_unlocked(*i);
 		}
@@ -432,9 +515,234 @@ MidiModel::NoteDiffCommand::undo ()
 		for (set<NotePtr>::iterator i = side_effect_removals.begin(); i != side_effect_removals.end(); ++i) {
 			_model->add_note_unlocked (*i);
 		}
+
+		extend_range (start, end);
 	}
 
-	_model->ContentsChanged(); /* EMIT SIGNAL */
+	_model->contents_changed (start, end); /* EMIT SIGNAL */
+}
+
+/** Ticks are signed, but the sign of the result of / and % with a negative
+ * operand is implementation defined before C++11, so divide the magnitude.
+ * Beats keeps beats and ticks with the same sign.
+ */
+MidiModel::TimeType
+MidiModel::NoteDiffCommand::Value::get_beats () const
+{
+	const int32_t  sign  = _v < 0 ? -1 : 1;
+	const uint64_t ticks = _v < 0 ? -(uint64_t) _v : (uint64_t) _v;
+	const uint64_t beats = std::min (ticks / TimeType::PPQN, (uint64_t) std::numeric_limits<int32_t>::max ());
+
+	return TimeType (sign * (int32_t) beats, sign * (int32_t) (ticks % TimeType::PPQN));
+}
+
+/* Compact encoding of note changes and notes for the undo history.
+ *
+ * Each record is a sequence of zigzag-encoded LEB128 varints, so that
+ * small values (note numbers, velocities, the difference between event
+ * ids) take a single byte. The result is base64 encoded and stored as the
+ * content of the enclosing XML node, which is marked encoding="binary".
+ */
+
+static void
+put_varint (std::vector<guchar>& buf, int64_t v)
+{
+	uint64_t u = ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+	while (u >= 0x80) {
+		buf.push_back ((guchar) (u | 0x80));
+		u >>= 7;
+	}
+	buf.push_back ((guchar) u);
+}
+
+static bool
+get_varint (guchar const*& p, guchar const* end, int64_t& v)
+{
+	uint64_t u = 0;
+	for (int shift = 0; p < end && shift < 64; shift += 7) {
+		const guchar b = *p++;
+		u |= (uint64_t) (b & 0x7f) << shift;
+		if (!(b & 0x80)) {
+			v = (int64_t) (u >> 1) ^ -(int64_t) (u & 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+static XMLNode*
+binary_node (const char* name, std::vector<guchar> const& buf)
+{
+	XMLNode* node = new XMLNode (name);
+	node->set_property (X_("encoding"), X_("binary"));
+
+	if (!buf.empty ()) {
+		gchar* b64 = g_base64_encode (&buf[0], buf.size ());
+		node->add_content (b64);
+		g_free (b64);
+	}
+
+	return node;
+}
+
+static bool
+is_binary_node (XMLNode const& node)
+{
+	std::string encoding;
+	return node.get_property (X_("encoding"), encoding) && encoding == X_("binary");
+}
+
+static std::vector<guchar>
+binary_content (XMLNode const& node)
+{
+	std::vector<guchar> buf;
+
+	for (XMLNodeList::const_iterator n = node.children ().begin (); n != node.children ().end (); ++n) {
+		if (!(*n)->is_content ()) {
+			continue;
+		}
+		gsize size;
+		guchar* data = g_base64_decode ((*n)->content ().c_str (), &size);
+		buf.assign (data, data + size);
+		g_free (data);
+		break;
+	}
+
+	return buf;
+}
+
+XMLNode&
+MidiModel::NoteDiffCommand::pack_changes (const char* name)
+{
+	std::vector<guchar> buf;
+	buf.reserve (_changes.size () * 8);
+
+	for (ChangeList::const_iterator i = _changes.begin (); i != _changes.end (); ++i) {
+		gint note_id;
+		if (i->note) {
+			note_id = i->note->id ();
+		} else if (i->note_id) {
+			warning << _("Change has no note, using note ID") << endmsg;
+			note_id = i->note_id;
+		} else {
+			error << _("Change has no note or note ID") << endmsg;
+			continue;
+		}
+		put_varint (buf, note_id);
+		put_varint (buf, i->property);
+		put_varint (buf, i->old_value.packed ());
+		put_varint (buf, i->new_value.packed ());
+	}
+
+	return *binary_node (name, buf);
+}
+
+void
+MidiModel::NoteDiffCommand::unpack_changes (XMLNode const& node)
+{
+	std::vector<guchar> const buf (binary_content (node));
+
+	if (buf.empty ()) {
+		return;
+	}
+
+	guchar const* p   = &buf[0];
+	guchar const* end = p + buf.size ();
+
+	while (p < end) {
+		int64_t note_id, property, old_value, new_value;
+
+		if (!get_varint (p, end, note_id) ||
+		    !get_varint (p, end, property) ||
+		    !get_varint (p, end, old_value) ||
+		    !get_varint (p, end, new_value)) {
+			error << _("Truncated binary note change data - ignored") << endmsg;
+			break;
+		}
+
+		if (property < NoteNumber || property > Channel) {
+			error << string_compose (_("Unknown note property %1 in binary note change data - ignored"), property) << endmsg;
+			continue;
+		}
+
+		NoteChange change;
+		change.property  = (Property) property;
+		change.old_value = Value::from_packed (old_value);
+		change.new_value = Value::from_packed (new_value);
+		change.note      = _model->find_note ((gint) note_id);
+		change.note_id   = (gint) note_id;
+
+		_changes.push_back (change);
+	}
+}
+
+XMLNode&
+MidiModel::NoteDiffCommand::pack_notes (const char* name, NoteList const& notes)
+{
+	std::vector<guchar> buf;
+	buf.reserve (notes.size () * 10);
+
+	for (NoteList::const_iterator i = notes.begin (); i != notes.end (); ++i) {
+		put_varint (buf, (*i)->id ());
+		put_varint (buf, (*i)->note ());
+		put_varint (buf, (*i)->channel ());
+		put_varint (buf, (*i)->velocity ());
+		put_varint (buf, (*i)->time ().to_ticks ());
+		put_varint (buf, (*i)->length ().to_ticks ());
+	}
+
+	return *binary_node (name, buf);
+}
+
+void
+MidiModel::NoteDiffCommand::unpack_notes (XMLNode const& node, NoteList& notes)
+{
+	std::vector<guchar> const buf (binary_content (node));
+
+	if (buf.empty ()) {
+		return;
+	}
+
+	guchar const* p   = &buf[0];
+	guchar const* end = p + buf.size ();
+
+	while (p < end) {
+		int64_t id, note, channel, velocity, time, length;
+
+		if (!get_varint (p, end, id) ||
+		    !get_varint (p, end, note) ||
+		    !get_varint (p, end, channel) ||
+		    !get_varint (p, end, velocity) ||
+		    !get_varint (p, end, time) ||
+		    !get_varint (p, end, length)) {
+			error << _("Truncated binary note data - ignored") << endmsg;
+			break;
+		}
+
+		/* as unmarshal_note() does for missing values */
+
+		if (note < 0 || note > 127) {
+			warning << string_compose (_("binary note information has bad note value %1"), note) << endmsg;
+			note = 127;
+		}
+
+		if (channel < 0 || channel > 15) {
+			warning << string_compose (_("binary note information has bad channel %1"), channel) << endmsg;
+			channel = 0;
+		}
+
+		if (velocity < 0 || velocity > 127) {
+			warning << string_compose (_("binary note information has bad velocity %1"), velocity) << endmsg;
+			velocity = 127;
+		}
+
+		NotePtr note_ptr (new Evoral::Note<TimeType> ((uint8_t) channel,
+		                                              Value::from_packed (time).get_beats (),
+		                                              Value::from_packed (length).get_beats (),
+		                                              (uint8_t) note, (uint8_t) velocity));
+		note_ptr->set_id ((Evoral::event_id_t) id);
+		notes.push_back (note_ptr);
+	}
 }
 
 XMLNode&
@@ -588,7 +896,9 @@ MidiModel::NoteDiffCommand::set_state (const XMLNode& diff_command, int /*versio
 
 	_added_notes.clear();
 	XMLNode* added_notes = diff_command.child(ADDED_NOTES_ELEMENT);
-	if (added_notes) {
+	if (added_notes && is_binary_node (*added_notes)) {
+		unpack_notes (*added_notes, _added_notes);
+	} else if (added_notes) {
 		XMLNodeList notes = added_notes->children();
 		transform(notes.begin(), notes.end(), back_inserter(_added_notes),
 		          boost::bind (&NoteDiffCommand::unmarshal_note, this, _1));
@@ -599,7 +909,9 @@ MidiModel::NoteDiffCommand::set_state (const XMLNode& diff_command, int /*versio
 
 	_removed_notes.clear();
 	XMLNode* removed_notes = diff_command.child(REMOVED_NOTES_ELEMENT);
-	if (removed_notes) {
+	if (removed_notes && is_binary_node (*removed_notes)) {
+		unpack_notes (*removed_notes, _removed_notes);
+	} else if (removed_notes) {
 		XMLNodeList notes = removed_notes->children();
 		transform(notes.begin(), notes.end(), back_inserter(_removed_notes),
 		          boost::bind (&NoteDiffCommand::unmarshal_note, this, _1));
@@ -612,7 +924,9 @@ MidiModel::NoteDiffCommand::set_state (const XMLNode& diff_command, int /*versio
 
 	XMLNode* changed_notes = diff_command.child(DIFF_NOTES_ELEMENT);
 
-	if (changed_notes) {
+	if (changed_notes && is_binary_node (*changed_notes)) {
+		unpack_changes (*changed_notes);
+	} else if (changed_notes) {
 		XMLNodeList notes = changed_notes->children();
 		transform (notes.begin(), notes.end(), back_inserter(_changes),
 		           boost::bind (&NoteDiffCommand::unmarshal_change, this, _1));
@@ -625,7 +939,11 @@ MidiModel::NoteDiffCommand::set_state (const XMLNode& diff_command, int /*versio
 
 	XMLNode* side_effect_notes = diff_command.child(SIDE_EFFECT_REMOVALS_ELEMENT);
 
-	if (side_effect_notes) {
+	if (side_effect_notes && is_binary_node (*side_effect_notes)) {
+		NoteList notes;
+		unpack_notes (*side_effect_notes, notes);
+		side_effect_removals.insert (notes.begin(), notes.end());
+	} else if (side_effect_notes) {
 		XMLNodeList notes = side_effect_notes->children();
 		for (XMLNodeList::iterator n = notes.begin(); n != notes.end(); ++n) {
 			side_effect_removals.insert (unmarshal_note (*n));
@@ -641,6 +959,17 @@ MidiModel::NoteDiffCommand::get_state ()
 	XMLNode* diff_command = new XMLNode (NOTE_DIFF_COMMAND_ELEMENT);
 	diff_command->set_property("midi-source", _model->midi_source()->id().to_s());
 
+	if (Config->get_save_binary_midi_history ()) {
+		diff_command->add_child_nocopy (pack_changes (DIFF_NOTES_ELEMENT));
+		diff_command->add_child_nocopy (pack_notes (ADDED_NOTES_ELEMENT, _added_notes));
+		diff_command->add_child_nocopy (pack_notes (REMOVED_NOTES_ELEMENT, _removed_notes));
+		if (!side_effect_removals.empty()) {
+			NoteList notes (side_effect_removals.begin(), side_effect_removals.end());
+			diff_command->add_child_nocopy (pack_notes (SIDE_EFFECT_REMOVALS_ELEMENT, notes));
+		}
+		return *diff_command;
+	}
+
 	XMLNode* changes = diff_command->add_child(DIFF_NOTES_ELEMENT);
 	for_each(_changes.begin(), _changes.end(),
 	         boost::bind (
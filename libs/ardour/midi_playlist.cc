@@ -30,6 +30,7 @@
 
 #include "ardour/beats_samples_converter.h"
 #include "ardour/debug.h"
+#include "ardour/midi_channel_filter.h"
 #include "ardour/midi_model.h"
 #include "ardour/midi_playlist.h"
 #include "ardour/midi_region.h"
@@ -51,6 +52,8 @@ MidiPlaylist::MidiPlaylist (Session& session, const XMLNode& node, bool hidden)
 	: Playlist (session, node, DataType::MIDI, hidden)
 	, _note_mode(Sustained)
 	, _read_end(0)
+	, _rendered_filter (0)
+	, _render_all (true)
 {
 #ifndef NDEBUG
 	XMLProperty const * prop = node.property("type");
@@ -64,20 +67,28 @@ MidiPlaylist::MidiPlaylist (Session& session, const XMLNode& node, bool hidden)
 	in_set_state--;
 
 	relayer ();
+
+	_session.tempo_map().MetricPositionChanged.connect_same_thread (_tempo_map_connection, boost::bind (&MidiPlaylist::tempo_map_changed, this));
 }
 
 MidiPlaylist::MidiPlaylist (Session& session, string name, bool hidden)
 	: Playlist (session, name, DataType::MIDI, hidden)
 	, _note_mode(Sustained)
 	, _read_end(0)
+	, _rendered_filter (0)
+	, _render_all (true)
 {
+	_session.tempo_map().MetricPositionChanged.connect_same_thread (_tempo_map_connection, boost::bind (&MidiPlaylist::tempo_map_changed, this));
 }
 
 MidiPlaylist::MidiPlaylist (boost::shared_ptr<const MidiPlaylist> other, string name, bool hidden)
 	: Playlist (other, name, hidden)
 	, _note_mode(other->_note_mode)
 	, _read_end(0)
+	, _rendered_filter (0)
+	, _render_all (true)
 {
+	_session.tempo_map().MetricPositionChanged.connect_same_thread (_tempo_map_connection, boost::bind (&MidiPlaylist::tempo_map_changed, this));
 }
 
 MidiPlaylist::MidiPlaylist (boost::shared_ptr<const MidiPlaylist> other,
@@ -88,7 +99,10 @@ MidiPlaylist::MidiPlaylist (boost::shared_ptr<const MidiPlaylist> other,
 	: Playlist (other, start, dur, name, hidden)
 	, _note_mode(other->_note_mode)
 	, _read_end(0)
+	, _rendered_filter (0)
+	, _render_all (true)
 {
+	_session.tempo_map().MetricPositionChanged.connect_same_thread (_tempo_map_connection, boost::bind (&MidiPlaylist::tempo_map_changed, this));
 }
 
 MidiPlaylist::~MidiPlaylist ()
@@ -116,6 +130,51 @@ MidiPlaylist::remove_dependents (boost::shared_ptr<Region> region)
 {
 }
 
+void
+MidiPlaylist::set_note_mode (NoteMode m)
+{
+	Glib::Threads::Mutex::Lock lm (_dirty_lock);
+	if (m != _note_mode) {
+		_note_mode = m;
+		_render_all = true;
+	}
+}
+
+void
+MidiPlaylist::tempo_map_changed ()
+{
+	/* every event may have moved */
+	Glib::Threads::Mutex::Lock lm (_dirty_lock);
+	_render_all = true;
+}
+
+bool
+MidiPlaylist::region_changed (const PropertyChange& what_changed, boost::shared_ptr<Region> region)
+{
+	/* changes of a region's extent are found by render() comparing it
+	 * to what it rendered last time, but edits of a region's contents
+	 * can only be seen here.
+	 */
+	if (what_changed.contains (Properties::contents)) {
+
+		boost::shared_ptr<MidiRegion> mr = boost::dynamic_pointer_cast<MidiRegion> (region);
+		samplepos_t from;
+		samplepos_t to;
+
+		if (!mr || !mr->contents_change_range (from, to)) {
+			from = region->position ();
+			to = region->position () + region->length ();
+		}
+
+		if (from <= to) {
+			Glib::Threads::Mutex::Lock lm (_dirty_lock);
+			_dirty.add (Evoral::Range<samplepos_t> (from, to));
+		}
+	}
+
+	return Playlist::region_changed (what_changed, region);
+}
+
 void
 MidiPlaylist::region_going_away (boost::weak_ptr<Region> region)
 {
@@ -307,19 +366,95 @@ MidiPlaylist::render (MidiChannelFilter* filter)
 
 	DEBUG_TRACE (DEBUG::MidiPlaylistIO, string_compose ("---- MidiPlaylist::render (regions: %1)-----\n", regions.size()));
 
+	Evoral::RangeList<samplepos_t> dirty;
+	bool render_all;
+
+	{
+		Glib::Threads::Mutex::Lock lm (_dirty_lock);
+		dirty = _dirty;
+		_dirty = Evoral::RangeList<samplepos_t> ();
+		render_all = _render_all;
+		_render_all = false;
+	}
+
 	std::vector< boost::shared_ptr<Region> > regs;
+	RenderedRegions rendered_regions;
 
 	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
 
+		RenderedRegion& rr (rendered_regions[(*i)->id()]);
+
+		rr.position = (*i)->position ();
+		rr.length = (*i)->length ();
+		rr.start = (*i)->start ();
+		rr.audible = !(*i)->muted ();
+
 		/* check for the case of solo_selection */
 
 		if (_session.solo_selection_active() && SoloSelectedActive() && !SoloSelectedListIncludes ((const Region*) &(**i))) {
+			rr.audible = false;
 			continue;
 		}
 
 		regs.push_back (*i);
 	}
 
+	uint32_t filter_state = UINT32_MAX;
+
+	if (filter) {
+		ChannelMode mode;
+		uint16_t mask;
+		filter->get_mode_and_mask (&mode, &mask);
+		filter_state = ((uint32_t) mode << 16) | mask;
+	}
+
+	if (filter_state != _rendered_filter || _rendered.reversed ()) {
+		render_all = true;
+	}
+
+	if (!render_all) {
+
+		/* add the old and new extent of every region that was added,
+		 * removed, moved, trimmed or (un)muted since the last render.
+		 * Hanging notes are resolved one sample after a region's end.
+		 */
+
+		for (RenderedRegions::const_iterator o = _rendered_regions.begin(); o != _rendered_regions.end(); ++o) {
+			RenderedRegions::const_iterator n = rendered_regions.find (o->first);
+			if (n != rendered_regions.end() && !(n->second != o->second)) {
+				continue;
+			}
+			if (o->second.audible) {
+				dirty.add (Evoral::Range<samplepos_t> (o->second.position, o->second.position + o->second.length));
+			}
+		}
+
+		for (RenderedRegions::const_iterator n = rendered_regions.begin(); n != rendered_regions.end(); ++n) {
+			RenderedRegions::const_iterator o = _rendered_regions.find (n->first);
+			if (o != _rendered_regions.end() && !(n->second != o->second)) {
+				continue;
+			}
+			if (n->second.audible) {
+				dirty.add (Evoral::Range<samplepos_t> (n->second.position, n->second.position + n->second.length));
+			}
+		}
+	}
+
+	_rendered_regions.swap (rendered_regions);
+	_rendered_filter = filter_state;
+
+	if (render_all) {
+		render_all_regions (regs, filter);
+	} else if (!dirty.empty ()) {
+		render_dirty_ranges (regs, filter, dirty);
+	}
+
+	DEBUG_TRACE (DEBUG::MidiPlaylistIO, string_compose ("---- End MidiPlaylist::render, events: %1\n", _rendered.size()));
+}
+
+void
+MidiPlaylist::render_all_regions (std::vector< boost::shared_ptr<Region> > const & regs, MidiChannelFilter* filter)
+{
 	/* If we are reading from a single region, we can read directly into _rendered.  Otherwise,
 	   we read into a temporarily list, sort it, then write that to _rendered.
 	*/
@@ -344,7 +479,7 @@ MidiPlaylist::render (MidiChannelFilter* filter)
 
 		DEBUG_TRACE (DEBUG::MidiPlaylistIO, string_compose ("\t%1 regions to read, direct: %2\n", regs.size(), (regs.size() == 1)));
 
-		for (vector<boost::shared_ptr<Region> >::iterator i = regs.begin(); i != regs.end(); ++i) {
+		for (vector<boost::shared_ptr<Region> >::const_iterator i = regs.begin(); i != regs.end(); ++i) {
 
 			boost::shared_ptr<MidiRegion> mr = boost::dynamic_pointer_cast<MidiRegion>(*i);
 
@@ -375,8 +510,57 @@ MidiPlaylist::render (MidiChannelFilter* filter)
 	}
 
 	/* no need to release - RAII with WriteProtectRender takes care of it */
+}
 
-	DEBUG_TRACE (DEBUG::MidiPlaylistIO, string_compose ("---- End MidiPlaylist::render, events: %1\n", _rendered.size()));
+void
+MidiPlaylist::render_dirty_ranges (std::vector< boost::shared_ptr<Region> > const & regs, MidiChannelFilter* filter, Evoral::RangeList<samplepos_t>& dirty)
+{
+	typedef Evoral::RangeList<samplepos_t>::List Ranges;
+
+	Ranges const & ranges (dirty.get ());
+
+	/* render each span from every region that overlaps it, before taking
+	 * the write lock, then replace the span's events in _rendered.
+	 */
+
+	std::vector<Evoral::EventList<samplepos_t> > evlists (ranges.size ());
+	EventsSortByTimeAndType<samplepos_t> cmp;
+	size_t n = 0;
+
+	for (Ranges::const_iterator r = ranges.begin(); r != ranges.end(); ++r, ++n) {
+
+		DEBUG_TRACE (DEBUG::MidiPlaylistIO, string_compose ("\trender %1 .. %2\n", r->from, r->to));
+
+		for (vector<boost::shared_ptr<Region> >::const_iterator i = regs.begin(); i != regs.end(); ++i) {
+
+			boost::shared_ptr<MidiRegion> mr = boost::dynamic_pointer_cast<MidiRegion>(*i);
+
+			if (!mr || mr->position() > r->to || mr->position() + mr->length() < r->from) {
+				continue;
+			}
+
+			mr->render_range (evlists[n], 0, _note_mode, filter, r->from, r->to);
+		}
+
+		/* order events the same way as render_all_regions() does */
+		if (regs.size() > 1) {
+			evlists[n].sort (cmp);
+		}
+	}
+
+	RTMidiBuffer::WriteProtectRender wpr (_rendered);
+	wpr.acquire ();
+
+	n = 0;
+
+	for (Ranges::const_iterator r = ranges.begin(); r != ranges.end(); ++r, ++n) {
+
+		_rendered.replace (r->from, r->to, evlists[n]);
+
+		for (Evoral::EventList<samplepos_t>::iterator e = evlists[n].begin(); e != evlists[n].end(); ++e) {
+			delete *e;
+		}
+	}
 }
 
 RTMidiBuffer*
@@ -88,6 +88,7 @@ MidiRegion::MidiRegion (const SourceList& srcs)
 	, _start_beats (Properties::start_beats, 0.0)
 	, _length_beats (Properties::length_beats, midi_source(0)->length_beats().to_double())
 	, _ignore_shift (false)
+	, _contents_change_valid (false)
 {
 	register_properties ();
 	midi_source(0)->ModelChanged.connect_same_thread (_source_connection, boost::bind (&MidiRegion::model_changed, this));
@@ -101,6 +102,7 @@ MidiRegion::MidiRegion (boost::shared_ptr<const MidiRegion> other)
 	, _start_beats (Properties::start_beats, other->_start_beats)
 	, _length_beats (Properties::length_beats, other->_length_beats)
 	, _ignore_shift (false)
+	, _contents_change_valid (false)
 {
 	//update_length_beats ();
 	register_properties ();
@@ -116,6 +118,7 @@ MidiRegion::MidiRegion (boost::shared_ptr<const MidiRegion> other, MusicSample o
 	, _start_beats (Properties::start_beats, other->_start_beats)
 	, _length_beats (Properties::length_beats, other->_length_beats)
 	, _ignore_shift (false)
+	, _contents_change_valid (false)
 {
 
 	register_properties ();
@@ -557,6 +560,126 @@ MidiRegion::render (Evoral::EventSink<samplepos_t>& dst,
 	return 0;
 }
 
+namespace {
+
+/** Passes on only the events within [from, to] */
+class RangeFilterSink : public Evoral::EventSink<samplepos_t>
+{
+  public:
+	RangeFilterSink (Evoral::EventSink<samplepos_t>& dst, samplepos_t from, samplepos_t to)
+		: _dst (dst)
+		, _from (from)
+		, _to (to)
+	{}
+
+	uint32_t write (samplepos_t time, Evoral::EventType type, uint32_t size, const uint8_t* buf) {
+		if (time < _from || time > _to) {
+			return size;
+		}
+		return _dst.write (time, type, size, buf);
+	}
+
+  private:
+	Evoral::EventSink<samplepos_t>& _dst;
+	samplepos_t _from;
+	samplepos_t _to;
+};
+
+}
+
+int
+MidiRegion::render_range (Evoral::EventSink<samplepos_t>& dst,
+                          uint32_t                        chan_n,
+                          NoteMode                        mode,
+                          MidiChannelFilter*              filter,
+                          samplepos_t                     from,
+                          samplepos_t                     to) const
+{
+	assert(chan_n == 0);
+
+	if (muted()) {
+		return 0; /* read nothing */
+	}
+
+	/* render() resolves hanging notes one sample past the last sample */
+	const samplepos_t region_end = _position + _length;
+
+	from = max (from, _position.val());
+	to = min (to, region_end);
+
+	if (from > to) {
+		return 0;
+	}
+
+	boost::shared_ptr<MidiSource> src = midi_source(chan_n);
+
+	Glib::Threads::Mutex::Lock lm(src->mutex());
+
+	src->set_note_mode(lm, mode);
+
+	/* start one sample early, in case rounding puts a note-on that the
+	 * model has before `from' at `from'. Events before `from' are read
+	 * (and tracked) but not passed on.
+	 */
+	const samplepos_t read_start = max (_position.val(), from - 1);
+
+	MidiCursor cursor;
+	MidiStateTracker tracker;
+	RangeFilterSink sink (dst, from, to);
+
+	boost::shared_ptr<const MidiModel> m = src->model();
+
+	if (m && read_start > _position) {
+
+		/* Notes that are still sounding at `read_start' were switched
+		 * on before it, but their note-offs, or their resolution at
+		 * the region end, may fall within the span. Hand them to the
+		 * model iterator as active notes, as a cursor that survives
+		 * a locate does, and to the tracker, instead of reading the
+		 * span from their note-ons. The region plays no notes that
+		 * start before its own start, so only the notes between there
+		 * and `read_start' are candidates.
+		 */
+
+		BeatsSamplesConverter converter (_session.tempo_map(), _position - _start);
+		const Temporal::Beats region_start = converter.from (_start);
+		const Temporal::Beats t = converter.from (_start + (read_start - _position));
+
+		MidiModel::ReadLock lock (m->read_lock());
+
+		const MidiModel::Notes::const_iterator end = m->note_lower_bound (t);
+
+		for (MidiModel::Notes::const_iterator n = m->note_lower_bound (region_start); n != end; ++n) {
+			if ((*n)->end_time() > t) {
+				cursor.active_notes.insert (*n);
+				tracker.add ((*n)->note(), (*n)->channel());
+			}
+		}
+	}
+
+	const samplepos_t read_end = min (to + 1, region_end);
+
+	src->midi_read (
+		lm,
+		sink,
+		_position - _start,
+		_start + (read_start - _position),
+		read_end - read_start,
+		0,
+		cursor,
+		&tracker,
+		filter,
+		_filtered_parameters,
+		quarter_note(),
+		_start_beats);
+
+	if (to == region_end) {
+		tracker.resolve_notes (sink, region_end);
+	}
+
+	return 0;
+}
+
 
 XMLNode&
 MidiRegion::state ()
@@ -680,7 +803,40 @@ MidiRegion::model_changed ()
 void
 MidiRegion::model_contents_changed ()
 {
+	Temporal::Beats start;
+	Temporal::Beats end;
+
+	if (model()->edit_range (start, end)) {
+		if (start > end) {
+			/* nothing was touched */
+			_contents_change_from = 1;
+			_contents_change_to = 0;
+		} else {
+			/* model time to session samples, as MidiSource::midi_read() does */
+			TempoMap& tmap (_session.tempo_map());
+			const double start_qn = quarter_note() - _start_beats;
+
+			_contents_change_from = max (_position.val(), tmap.sample_at_quarter_note (start.to_double() + start_qn));
+			_contents_change_to = min ((samplepos_t) (_position + _length), tmap.sample_at_quarter_note (end.to_double() + start_qn));
+		}
+		_contents_change_valid = true;
+	}
+
 	send_change (Properties::contents);
+
+	_contents_change_valid = false;
+}
+
+bool
+MidiRegion::contents_change_range (samplepos_t& from, samplepos_t& to) const
+{
+	if (!_contents_change_valid) {
+		return false;
+	}
+
+	from = _contents_change_from;
+	to = _contents_change_to;
+	return true;
 }
 
 void
@@ -722,11 +878,16 @@ MidiRegion::model_automation_state_changed (Evoral::Parameter const & p)
 	   for a given set of filtered_parameters, so now that we've changed that list we must invalidate
 	   the iterator.
 	*/
-	Glib::Threads::Mutex::Lock lm (midi_source(0)->mutex(), Glib::Threads::TRY_LOCK);
-	if (lm.locked()) {
-		/* TODO: This is too aggressive, we need more fine-grained invalidation. */
-		midi_source(0)->invalidate (lm);
+	{
+		Glib::Threads::Mutex::Lock lm (midi_source(0)->mutex(), Glib::Threads::TRY_LOCK);
+		if (lm.locked()) {
+			/* TODO: This is too aggressive, we need more fine-grained invalidation. */
+			midi_source(0)->invalidate (lm);
+		}
 	}
+
+	/* what we play back has changed, so a rendered playlist needs to re-read us */
+	send_change (Properties::contents);
 }
 
 /** This is called when a trim drag has resulted in a -ve _start time for this region.
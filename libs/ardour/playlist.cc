@@ -44,6 +44,7 @@
 #include "ardour/region.h"
 #include "ardour/midi_region.h"
 #include "ardour/region_factory.h"
+#include "ardour/region_index.h"
 #include "ardour/region_sorters.h"
 #include "ardour/session.h"
 #include "ardour/session_playlists.h"
@@ -348,6 +349,8 @@ Playlist::init (bool hide)
 	_combine_ops = 0;
 	_end_space = 0;
 	_playlist_shift_active = false;
+	g_atomic_int_set (&_region_index_dirty, 1);
+	g_atomic_int_set (&_contents_generation, 0);
 
 	_session.history().BeginUndoRedo.connect_same_thread (*this, boost::bind (&Playlist::begin_undo, this));
 	_session.history().EndUndoRedo.connect_same_thread (*this, boost::bind (&Playlist::end_undo, this));
@@ -467,6 +470,8 @@ Playlist::release_notifications (bool from_undo)
 void
 Playlist::notify_contents_changed ()
 {
+	bump_contents_generation ();
+
 	if (holding_state ()) {
 		pending_contents_change = true;
 	} else {
@@ -478,6 +483,8 @@ Playlist::notify_contents_changed ()
 void
 Playlist::notify_layering_changed ()
 {
+	bump_contents_generation ();
+
 	if (holding_state ()) {
 		pending_layering = true;
 	} else {
@@ -489,6 +496,8 @@ Playlist::notify_layering_changed ()
 void
 Playlist::notify_region_removed (boost::shared_ptr<Region> r)
 {
+	invalidate_region_index ();
+
 	if (holding_state ()) {
 		pending_removes.insert (r);
 		pending_contents_change = true;
@@ -572,6 +581,8 @@ Playlist::notify_region_added (boost::shared_ptr<Region> r)
 	 * as though it could be.
 	 */
 
+	invalidate_region_index ();
+
 	if (holding_state()) {
 		pending_adds.insert (r);
 		pending_contents_change = true;
@@ -1837,6 +1848,7 @@ Playlist::drop_regions ()
 	RegionWriteLock rl (this);
 	regions.clear ();
 	all_regions.clear ();
+	invalidate_region_index ();
 }
 
 void
@@ -1865,6 +1877,7 @@ Playlist::clear (bool with_signals)
 		}
 
 		regions.clear ();
+		invalidate_region_index ();
 
 		for (set<boost::shared_ptr<Region> >::iterator s = pending_removes.begin(); s != pending_removes.end(); ++s) {
 			remove_dependents (*s);
@@ -1910,84 +1923,37 @@ boost::shared_ptr<RegionList>
 Playlist::regions_at (samplepos_t sample)
 {
 	RegionReadLock rlock (this);
-	return find_regions_at (sample);
+	boost::shared_ptr<RegionList> rlist (new RegionList);
+	find_regions_at (sample, *rlist);
+	return rlist;
 }
 
 uint32_t
 Playlist::count_regions_at (samplepos_t sample) const
 {
 	RegionReadLock rlock (const_cast<Playlist*>(this));
-	uint32_t cnt = 0;
-
-	for (RegionList::const_iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->covers (sample)) {
-			cnt++;
-		}
-	}
-
-	return cnt;
+	return region_index ()->count_at (sample);
 }
 
 boost::shared_ptr<Region>
 Playlist::top_region_at (samplepos_t sample)
 {
 	RegionReadLock rlock (this);
-	boost::shared_ptr<RegionList> rlist = find_regions_at (sample);
-	boost::shared_ptr<Region> region;
-
-	if (rlist->size()) {
-		RegionSortByLayer cmp;
-		rlist->sort (cmp);
-		region = rlist->back();
-	}
-
-	return region;
+	return region_index ()->top_at (sample, false);
 }
 
 boost::shared_ptr<Region>
 Playlist::top_unmuted_region_at (samplepos_t sample)
 {
 	RegionReadLock rlock (this);
-	boost::shared_ptr<RegionList> rlist = find_regions_at (sample);
-
-	for (RegionList::iterator i = rlist->begin(); i != rlist->end(); ) {
-
-		RegionList::iterator tmp = i;
-
-		++tmp;
-
-		if ((*i)->muted()) {
-			rlist->erase (i);
-		}
-
-		i = tmp;
-	}
-
-	boost::shared_ptr<Region> region;
-
-	if (rlist->size()) {
-		RegionSortByLayer cmp;
-		rlist->sort (cmp);
-		region = rlist->back();
-	}
-
-	return region;
+	return region_index ()->top_at (sample, true);
 }
 
-boost::shared_ptr<RegionList>
-Playlist::find_regions_at (samplepos_t sample)
+void
+Playlist::find_regions_at (samplepos_t sample, RegionList& rlist)
 {
 	/* Caller must hold lock */
-
-	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->covers (sample)) {
-			rlist->push_back (*i);
-		}
-	}
-
-	return rlist;
+	region_index ()->touched (sample, sample, rlist);
 }
 
 boost::shared_ptr<RegionList>
@@ -1995,13 +1961,7 @@ Playlist::regions_with_start_within (Evoral::Range<samplepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->first_sample() >= range.from && (*i)->first_sample() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index ()->starting_within (range.from, range.to, *rlist);
 	return rlist;
 }
 
@@ -2010,13 +1970,7 @@ Playlist::regions_with_end_within (Evoral::Range<samplepos_t> range)
 {
 	RegionReadLock rlock (this);
 	boost::shared_ptr<RegionList> rlist (new RegionList);
-
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->last_sample() >= range.from && (*i)->last_sample() <= range.to) {
-			rlist->push_back (*i);
-		}
-	}
-
+	region_index ()->ending_within (range.from, range.to, *rlist);
 	return rlist;
 }
 
@@ -2024,21 +1978,54 @@ boost::shared_ptr<RegionList>
 Playlist::regions_touched (samplepos_t start, samplepos_t end)
 {
 	RegionReadLock rlock (this);
-	return regions_touched_locked (start, end);
+	boost::shared_ptr<RegionList> rlist (new RegionList);
+	regions_touched_locked (start, end, *rlist);
+	return rlist;
 }
 
-boost::shared_ptr<RegionList>
-Playlist::regions_touched_locked (samplepos_t start, samplepos_t end)
+/** Add regions which have some part within [start, end] to @param rlist.
+ *  Caller must hold the region lock.
+ */
+void
+Playlist::regions_touched_locked (samplepos_t start, samplepos_t end, RegionList& rlist)
 {
-	boost::shared_ptr<RegionList> rlist (new RegionList);
+	region_index ()->touched (start, end, rlist);
+}
 
-	for (RegionList::iterator i = regions.begin(); i != regions.end(); ++i) {
-		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
-			rlist->push_back (*i);
-		}
+void
+Playlist::region_properties_changed (PropertyChange const& what_changed)
+{
+	if (what_changed.contains (Properties::position) || what_changed.contains (Properties::length)) {
+		invalidate_region_index ();
+	} else {
+		/* mute, opacity, fades etc. may all affect derived data */
+		bump_contents_generation ();
 	}
+}
 
-	return rlist;
+void
+Playlist::invalidate_region_index ()
+{
+	g_atomic_int_set (&_region_index_dirty, 1);
+	bump_contents_generation ();
+}
+
+/** @return an index of all regions, sorted by position, for fast range queries.
+ * The caller must hold the region lock (reader or writer) while using the index.
+ */
+boost::shared_ptr<RegionIndex const>
+Playlist::region_index () const
+{
+	Glib::Threads::Mutex::Lock lm (_region_index_lock);
+	if (g_atomic_int_compare_and_exchange (&_region_index_dirty, 1, 0) || !_region_index) {
+		if (_region_index && _region_index.unique ()) {
+			/* no other reader uses the index, update it in place */
+			_region_index->rebuild (regions.begin (), regions.end ());
+		} else {
+			_region_index.reset (new RegionIndex (regions.begin (), regions.end ()));
+		}
+	}
+	return _region_index;
 }
 
 samplepos_t
@@ -3058,14 +3045,8 @@ Playlist::foreach_region (boost::function<void(boost::shared_ptr<Region>)> s)
 bool
 Playlist::has_region_at (samplepos_t const p) const
 {
-	RegionReadLock (const_cast<Playlist *> (this));
-
-	RegionList::const_iterator i = regions.begin ();
-	while (i != regions.end() && !(*i)->covers (p)) {
-		++i;
-	}
-
-	return (i != regions.end());
+	RegionReadLock rlock (const_cast<Playlist *> (this));
+	return region_index ()->count_at (p) > 0;
 }
 
 /** Look from a session sample time and find the start time of the next region
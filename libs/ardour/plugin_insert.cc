@@ -26,6 +26,7 @@
 #include "libardour-config.h"
 #endif
 
+#include <limits>
 #include <string>
 
 #include "pbd/failed_constructor.h"
@@ -91,6 +92,8 @@ PluginInsert::PluginInsert (Session& s, boost::shared_ptr<Plugin> plug)
 	, _bypass_port (UINT32_MAX)
 	, _inverted_bypass_enable (false)
 	, _stat_reset (0)
+	, _automation_splits (0)
+	, _automation_splits_peak (0)
 	, _flush (0)
 {
 	/* the first is the master */
@@ -655,7 +658,13 @@ PluginInsert::automation_run (samplepos_t start, pframes_t nframes, bool only_ac
 bool
 PluginInsert::find_next_event (double now, double end, Evoral::ControlEvent& next_event, bool only_active) const
 {
-	bool rv = Automatable::find_next_event (now, end, next_event, only_active);
+	bool rv;
+
+	if (only_active && now < end) {
+		rv = find_next_block_event (now, end, next_event);
+	} else {
+		rv = Automatable::find_next_event (now, end, next_event, only_active);
+	}
 
 	if (_loop_location && now < end) {
 		if (rv) {
@@ -671,6 +680,47 @@ PluginInsert::find_next_event (double now, double end, Evoral::ControlEvent& nex
 	return rv;
 }
 
+/** Like Automatable::find_next_event() for active controls, but events
+ * closer to @a now than the control's minimum automation block are moved
+ * to the end of that block. The control's value is evaluated at the start
+ * of every sub-block, so its events are quantized instead of splitting
+ * the cycle into tiny runs of the plugin.
+ */
+bool
+PluginInsert::find_next_block_event (double now, double end, Evoral::ControlEvent& next_event) const
+{
+	const double none = std::numeric_limits<double>::max();
+	const uint32_t min_block = Config->get_plugin_automation_min_block ();
+
+	next_event.when = none;
+
+	boost::shared_ptr<ControlList> cl = _automated_controls.reader ();
+	for (ControlList::const_iterator ci = cl->begin(); ci != cl->end(); ++ci) {
+		if (!(*ci)->automation_playback()) {
+			continue;
+		}
+
+		Evoral::ControlEvent ev (none, 0.0);
+		find_next_ac_event (*ci, now, end, ev);
+		if (ev.when == none) {
+			continue;
+		}
+
+		double block = min_block;
+		boost::shared_ptr<PluginControl> pc = boost::dynamic_pointer_cast<PluginControl> (*ci);
+		if (pc && pc->automation_min_block () >= 0) {
+			block = pc->automation_min_block ();
+		}
+
+		const double when = std::max (ev.when, now + block);
+		if (when < end && when < next_event.when) {
+			next_event.when = when;
+		}
+	}
+
+	return next_event.when != none;
+}
+
 void
 PluginInsert::activate ()
 {
@@ -1266,6 +1316,7 @@ PluginInsert::run (BufferSet& bufs, samplepos_t start_sample, samplepos_t end_sa
 
 	if (g_atomic_int_compare_and_exchange (&_stat_reset, 1, 0)) {
 		_timing_stats.reset ();
+		g_atomic_int_set (&_automation_splits_peak, 0);
 	}
 
 	if (g_atomic_int_compare_and_exchange (&_flush, 1, 0)) {
@@ -1319,6 +1370,7 @@ PluginInsert::automate_and_run (BufferSet& bufs, samplepos_t start, samplepos_t
 {
 	Evoral::ControlEvent next_event (0, 0.0f);
 	samplecnt_t offset = 0;
+	gint splits = 0;
 
 	Glib::Threads::Mutex::Lock lm (control_lock(), Glib::Threads::TRY_LOCK);
 
@@ -1335,6 +1387,7 @@ PluginInsert::automate_and_run (BufferSet& bufs, samplepos_t start, samplepos_t
 		/* no events have a time within the relevant range */
 
 		connect_and_run (bufs, start, end, speed, nframes, offset, true);
+		update_automation_split_stats (1);
 		return;
 	}
 
@@ -1344,6 +1397,7 @@ PluginInsert::automate_and_run (BufferSet& bufs, samplepos_t start, samplepos_t
 		assert (cnt > 0);
 
 		connect_and_run (bufs, start, start + cnt * speed, speed, cnt, offset, true);
+		++splits;
 
 		nframes -= cnt;
 		offset += cnt;
@@ -1360,7 +1414,26 @@ PluginInsert::automate_and_run (BufferSet& bufs, samplepos_t start, samplepos_t
 
 	if (nframes) {
 		connect_and_run (bufs, start, start + nframes * speed, speed, nframes, offset, true);
+		++splits;
 	}
+
+	update_automation_split_stats (splits);
+}
+
+void
+PluginInsert::update_automation_split_stats (gint splits)
+{
+	g_atomic_int_set (&_automation_splits, splits);
+	if (splits > g_atomic_int_get (&_automation_splits_peak)) {
+		g_atomic_int_set (&_automation_splits_peak, splits);
+	}
+}
+
+void
+PluginInsert::get_automation_split_stats (uint32_t& last, uint32_t& peak) const
+{
+	last = g_atomic_int_get (&_automation_splits);
+	peak = g_atomic_int_get (&_automation_splits_peak);
 }
 
 float
@@ -3024,6 +3097,7 @@ PluginInsert::PluginControl::PluginControl (PluginInsert*                     p,
                                             boost::shared_ptr<AutomationList> list)
 	: AutomationControl (p->session(), param, desc, list, p->describe_parameter(param))
 	, _plugin (p)
+	, _automation_min_block (-1)
 {
 	if (alist()) {
 		if (desc.toggled) {
@@ -3057,11 +3131,23 @@ PluginInsert::PluginControl::catch_up_with_external_value (double user_val)
 	AutomationControl::actually_set_value (user_val, Controllable::NoGroup);
 }
 
+int
+PluginInsert::PluginControl::set_state (XMLNode const& node, int version)
+{
+	if (!node.get_property (X_("automation-min-block"), _automation_min_block)) {
+		_automation_min_block = -1;
+	}
+	return AutomationControl::set_state (node, version);
+}
+
 XMLNode&
 PluginInsert::PluginControl::get_state ()
 {
 	XMLNode& node (AutomationControl::get_state());
 	node.set_property (X_("parameter"), parameter().id());
+	if (_automation_min_block >= 0) {
+		node.set_property (X_("automation-min-block"), _automation_min_block);
+	}
 
 	boost::shared_ptr<LV2Plugin> lv2plugin = boost::dynamic_pointer_cast<LV2Plugin> (_plugin->_plugins[0]);
 	if (lv2plugin) {
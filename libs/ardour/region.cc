@@ -1485,6 +1485,14 @@ Region::send_change (const PropertyChange& what_changed)
 		return;
 	}
 
+	/* The playlist indexes regions by their bounds; it has to know
+	   about changes immediately, not only once they are thawed.
+	*/
+	boost::shared_ptr<Playlist> pl (_playlist.lock ());
+	if (pl) {
+		pl->region_properties_changed (what_changed);
+	}
+
 	Stateful::send_change (what_changed);
 
 	if (!Stateful::property_changes_suspended()) {
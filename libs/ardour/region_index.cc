@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "ardour/region.h"
+#include "ardour/region_index.h"
+
+using namespace ARDOUR;
+
+RegionIndex::Entry::Entry (Region* r)
+	: first (r->first_sample ())
+	, last (r->last_sample ())
+	, region (r)
+{
+}
+
+RegionIndex::RegionIndex (RegionList::const_iterator begin, RegionList::const_iterator end)
+{
+	rebuild (begin, end);
+}
+
+void
+RegionIndex::rebuild (RegionList::const_iterator begin, RegionList::const_iterator end)
+{
+	bool sorted = true;
+
+	_entries.clear ();
+
+	for (RegionList::const_iterator i = begin; i != end; ++i) {
+		Entry e (i->get ());
+		if (!_entries.empty () && e.first < _entries.back ().first) {
+			sorted = false;
+		}
+		_entries.push_back (e);
+	}
+
+	/* Playlists keep their regions sorted by position, except
+	 * while splicing or rippling is in progress */
+	if (!sorted) {
+		std::stable_sort (_entries.begin (), _entries.end (), PositionCmp ());
+	}
+
+	_max_last.resize (_entries.size ());
+	augment (0, _entries.size ());
+}
+
+samplepos_t
+RegionIndex::augment (size_t lo, size_t hi)
+{
+	if (lo >= hi) {
+		return std::numeric_limits<samplepos_t>::min ();
+	}
+	size_t const mid = (lo + hi) / 2;
+	samplepos_t  m   = _entries[mid].last;
+	m                = std::max (m, augment (lo, mid));
+	m                = std::max (m, augment (mid + 1, hi));
+	_max_last[mid]   = m;
+	return m;
+}
+
+/** Call @param v for every region that overlaps [start, end], in order of position */
+template<typename Visitor>
+void
+RegionIndex::visit (size_t lo, size_t hi, samplepos_t start, samplepos_t end, Visitor& v) const
+{
+	while (lo < hi) {
+		size_t const mid = (lo + hi) / 2;
+		if (_max_last[mid] < start) {
+			/* all regions in this subtree end before the range */
+			return;
+		}
+		visit (lo, mid, start, end, v);
+
+		Entry const& e = _entries[mid];
+		if (e.first > end) {
+			/* this and all later regions start after the range */
+			return;
+		}
+		if (e.last >= start) {
+			v (e);
+		}
+		lo = mid + 1;
+	}
+}
+
+namespace {
+
+struct CollectList {
+	CollectList (RegionList& l) : rl (l) {}
+	void operator() (RegionIndex::Entry const& e) { rl.push_back (e.region->shared_from_this ()); }
+	RegionList& rl;
+};
+
+struct CollectVector {
+	CollectVector (std::vector<Region*>& v) : rv (v) {}
+	void operator() (RegionIndex::Entry const& e) { rv.push_back (e.region); }
+	std::vector<Region*>& rv;
+};
+
+struct CollectEndingBefore {
+	CollectEndingBefore (RegionList& l, samplepos_t e) : rl (l), end (e) {}
+	void operator() (RegionIndex::Entry const& e) {
+		if (e.last <= end) {
+			rl.push_back (e.region->shared_from_this ());
+		}
+	}
+	RegionList& rl;
+	samplepos_t end;
+};
+
+struct Count {
+	Count () : n (0) {}
+	void operator() (RegionIndex::Entry const&) { ++n; }
+	uint32_t n;
+};
+
+struct FindTop {
+	FindTop (bool m) : ignore_muted (m), top (0) {}
+	void operator() (RegionIndex::Entry const& e) {
+		if (ignore_muted && e.region->muted ()) {
+			return;
+		}
+		/* like RegionSortByLayer, the last of equal layers wins */
+		if (!top || e.region->layer () >= top->layer ()) {
+			top = e.region;
+		}
+	}
+	bool    ignore_muted;
+	Region* top;
+};
+
+}
+
+void
+RegionIndex::touched (samplepos_t start, samplepos_t end, RegionList& rl) const
+{
+	CollectList v (rl);
+	visit (0, _entries.size (), start, end, v);
+}
+
+void
+RegionIndex::touched (samplepos_t start, samplepos_t end, std::vector<Region*>& rv) const
+{
+	CollectVector v (rv);
+	visit (0, _entries.size (), start, end, v);
+}
+
+void
+RegionIndex::starting_within (samplepos_t start, samplepos_t end, RegionList& rl) const
+{
+	Entry key (start);
+	std::vector<Entry>::const_iterator i = std::lower_bound (_entries.begin (), _entries.end (), key, PositionCmp ());
+	for (; i != _entries.end () && i->first <= end; ++i) {
+		rl.push_back (i->region->shared_from_this ());
+	}
+}
+
+void
+RegionIndex::ending_within (samplepos_t start, samplepos_t end, RegionList& rl) const
+{
+	CollectEndingBefore v (rl, end);
+	visit (0, _entries.size (), start, end, v);
+}
+
+uint32_t
+RegionIndex::count_at (samplepos_t pos) const
+{
+	Count v;
+	visit (0, _entries.size (), pos, pos, v);
+	return v.n;
+}
+
+boost::shared_ptr<Region>
+RegionIndex::top_at (samplepos_t pos, bool ignore_muted) const
+{
+	FindTop v (ignore_muted);
+	visit (0, _entries.size (), pos, pos, v);
+	if (!v.top) {
+		return boost::shared_ptr<Region> ();
+	}
+	return v.top->shared_from_this ();
+}
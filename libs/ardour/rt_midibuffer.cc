@@ -43,6 +43,7 @@ RTMidiBuffer::RTMidiBuffer ()
 	, _reversed (false)
 	, _pool_size (0)
 	, _pool_capacity (0)
+	, _pool_unused (0)
 	, _pool (0)
 {
 }
@@ -154,7 +155,7 @@ RTMidiBuffer::reverse ()
 void
 RTMidiBuffer::dump (uint32_t cnt)
 {
-	cerr << this << " total items: " << _size << " within " << _capacity << " blob pool: " << _pool_capacity << " used " << _pool_size << endl;
+	cerr << this << " total items: " << _size << " within " << _capacity << " blob pool: " << _pool_capacity << " used " << _pool_size << " unused " << _pool_unused << endl;
 
 	for (uint32_t i = 0; i < _size && i < cnt; ++i) {
 
@@ -200,37 +201,42 @@ RTMidiBuffer::write (TimeType time, Evoral::EventType /*type*/, uint32_t size, c
 	}
 
 	_data[_size].timestamp = time;
+	encode (_data[_size], size, buf);
 
+	++_size;
+
+	return size;
+}
+
+void
+RTMidiBuffer::encode (Item& item, uint32_t size, const uint8_t* buf)
+{
 	if (size > 3) {
 
 		uint32_t off = store_blob (size, buf);
 
 		/* non-zero MSbit indicates that the data (more than 3 bytes) is not inline */
-		_data[_size].offset = (off | (1<<(CHAR_BIT-1)));
+		item.offset = (off | (1<<(CHAR_BIT-1)));
 
 	} else {
 
 		assert ((int) size == Evoral::midi_event_size (buf[0]));
 
 		/* zero MSbit indicates that the data (up to 3 bytes) is inline */
-		_data[_size].bytes[0] = 0;
+		item.bytes[0] = 0;
 
 		switch (size) {
 		case 3:
-			_data[_size].bytes[3] = buf[2];
+			item.bytes[3] = buf[2];
 			/* fallthru */
 		case 2:
-			_data[_size].bytes[2] = buf[1];
+			item.bytes[2] = buf[1];
 			/* fallthru */
 		case 1:
-			_data[_size].bytes[1] = buf[0];
+			item.bytes[1] = buf[0];
 			break;
 		}
 	}
-
-	++_size;
-
-	return size;
 }
 
 /* These (non-matching) comparison arguments weren't supported prior to C99 !!!
@@ -248,6 +254,85 @@ item_item_earlier (ARDOUR::RTMidiBuffer::Item const & item, ARDOUR::RTMidiBuffer
 	return item.timestamp < other.timestamp;
 }
 
+void
+RTMidiBuffer::replace (TimeType from, TimeType to, Evoral::EventList<TimeType> const & events)
+{
+	/* caller must hold the write lock (WriteProtectRender) */
+
+	assert (!_reversed);
+	assert (from <= to);
+
+	Item foo;
+
+	foo.timestamp = from;
+	const size_t lo = lower_bound (_data, _data + _size, foo, item_item_earlier) - _data;
+	foo.timestamp = to;
+	const size_t hi = upper_bound (_data + lo, _data + _size, foo, item_item_earlier) - _data;
+
+	const size_t n = events.size ();
+	const size_t tail = _size - hi;
+	const size_t new_size = lo + n + tail;
+
+	if (new_size > _capacity) {
+		resize (new_size + 1024); // XXX 1024 is completely arbitrary, see write()
+	}
+
+	/* the blobs of the replaced events are no longer used */
+	for (size_t i = lo; i < hi; ++i) {
+		if (_data[i].bytes[0]) {
+			Blob* blob = reinterpret_cast<Blob*> (&_pool[_data[i].offset & ~(1<<(CHAR_BIT-1))]);
+			_pool_unused += blob_space (blob->size);
+		}
+	}
+
+	/* move everything after the replaced span into place */
+	if (tail && lo + n != hi) {
+		memmove (&_data[lo + n], &_data[hi], tail * sizeof (Item));
+	}
+
+	size_t i = lo;
+
+	for (Evoral::EventList<TimeType>::const_iterator e = events.begin(); e != events.end(); ++e, ++i) {
+		assert ((*e)->time() >= from && (*e)->time() <= to);
+		assert (i == lo || _data[i-1].timestamp <= (*e)->time());
+		_data[i].timestamp = (*e)->time();
+		encode (_data[i], (*e)->size(), (*e)->buffer());
+	}
+
+	_size = new_size;
+
+	/* repeated edits would otherwise grow the pool without bound */
+	if (_pool_unused > _pool_size / 2) {
+		compact_pool ();
+	}
+}
+
+/** Copy the blobs that are still in use to a new pool, dropping the rest */
+void
+RTMidiBuffer::compact_pool ()
+{
+	uint8_t* old_pool = _pool;
+
+	_pool_capacity = _pool_size - _pool_unused;
+	_pool_size = 0;
+	_pool_unused = 0;
+	_pool = 0;
+
+	if (_pool_capacity) {
+		cache_aligned_malloc ((void **) &_pool, (_pool_capacity * sizeof (Blob)));
+	}
+
+	for (size_t i = 0; i < _size; ++i) {
+		if (_data[i].bytes[0]) {
+			Blob* blob = reinterpret_cast<Blob*> (&old_pool[_data[i].offset & ~(1<<(CHAR_BIT-1))]);
+			uint32_t off = store_blob (blob->size, blob->data);
+			_data[i].offset = (off | (1<<(CHAR_BIT-1)));
+		}
+	}
+
+	cache_aligned_free (old_pool);
+}
+
 uint32_t
 RTMidiBuffer::read (MidiBuffer& dst, samplepos_t start, samplepos_t end, MidiStateTracker& tracker, samplecnt_t offset)
 {
@@ -370,10 +455,12 @@ RTMidiBuffer::read (MidiBuffer& dst, samplepos_t start, samplepos_t end, MidiSta
 uint32_t
 RTMidiBuffer::alloc_blob (uint32_t size)
 {
-	if (_pool_size + size > _pool_capacity) {
+	const uint32_t space = blob_space (size);
+
+	if (_pool_size + space > _pool_capacity) {
 		uint8_t* old_pool = _pool;
 
-		_pool_capacity += size * 4;
+		_pool_capacity += space * 4;
 
 		cache_aligned_malloc ((void **) &_pool, (_pool_capacity * sizeof (Blob)));
 		memcpy (_pool, old_pool, _pool_size * sizeof (Blob));
@@ -381,13 +468,21 @@ RTMidiBuffer::alloc_blob (uint32_t size)
 	}
 
 	uint32_t offset = _pool_size;
+	_pool_size += space;
+
+	return offset;
+}
+
+/** @return the pool space taken by a blob for @param size bytes of data */
+uint32_t
+RTMidiBuffer::blob_space (uint32_t size)
+{
+	size += sizeof (size);
 #if defined(__arm__) || defined(__aarch64_)
-		_pool_size += ((size - 1) | 3) + 1;
+	return ((size - 1) | 3) + 1;
 #else
-		_pool_size += size;
+	return size;
 #endif
-
-	return offset;
 }
 
 uint32_t
@@ -410,6 +505,7 @@ RTMidiBuffer::clear ()
 	_size = 0;
 	/* free the entire current pool size, if any */
 	_pool_size = 0;
+	_pool_unused = 0;
 	/* rendering new data .. it will not be reversed */
 	_reversed = false;
 }
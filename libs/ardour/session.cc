@@ -111,6 +111,7 @@
 #include "ardour/session_playlists.h"
 #include "ardour/session_route.h"
 #include "ardour/smf_source.h"
+#include "ardour/source_block_cache.h"
 #include "ardour/solo_isolate_control.h"
 #include "ardour/source_factory.h"
 #include "ardour/speakers.h"
@@ -236,6 +237,7 @@ Session::Session (AudioEngine &eng,
 	, _suspend_save (0)
 	, _save_queued (false)
 	, _save_queued_pending (false)
+	, _state_writer_thread (0)
 	, _last_roll_location (0)
 	, _last_roll_or_reversal_location (0)
 	, _last_record_location (0)
@@ -244,6 +246,7 @@ Session::Session (AudioEngine &eng,
 	, lua (lua_newstate (&PBD::ReallocPool::lalloc, &_mempool))
 	, _n_lua_scripts (0)
 	, _butler (new Butler (*this))
+	, _source_block_cache (new SourceBlockCache)
 	, _transport_fsm (new TransportFSM (*this))
 	, _post_transport_work (0)
 	, _locations (new Locations (*this))
@@ -658,6 +661,10 @@ Session::destroy ()
 	delete _butler;
 	_butler = 0;
 
+	SourceBlockCache* sbc = _source_block_cache;
+	_source_block_cache = 0;
+	delete sbc;
+
 	delete _all_route_group;
 
 	DEBUG_TRACE (DEBUG::Destruction, "delete route groups\n");
@@ -6085,6 +6092,16 @@ Session::plot_process_graph (std::string const& file_name) const {
 	return _process_graph ? _process_graph->plot (file_name) : false;
 }
 
+bool
+Session::process_graph_stats (GraphStats& s) const
+{
+	if (!_process_graph) {
+		return false;
+	}
+	_process_graph->stats (s);
+	return true;
+}
+
 void
 Session::add_automation_list(AutomationList *al)
 {
@@ -116,6 +116,11 @@ Session::process (pframes_t nframes)
 		}
 	}
 
+	if (_rt_thread_active && _process_graph && _process_graph->priority_update_pending ()) {
+		/* wake up the emit thread, which updates graph priorities */
+		_rt_emit_pending = true;
+	}
+
 	if (_rt_emit_pending) {
 		if (!_rt_thread_active) {
 			emit_route_signals ();
@@ -1107,6 +1112,9 @@ Session::emit_thread_run ()
 	pthread_mutex_lock (&_rt_emit_mutex);
 	while (_rt_thread_active) {
 		emit_route_signals();
+		if (_process_graph) {
+			_process_graph->update_priorities ();
+		}
 		pthread_cond_wait (&_rt_emit_cond, &_rt_emit_mutex);
 	}
 	pthread_mutex_unlock (&_rt_emit_mutex);
@@ -691,6 +691,9 @@ Session::maybe_write_autosave()
 void
 Session::remove_pending_capture_state ()
 {
+	/* a pending save that is still being written must not re-create the file */
+	wait_for_state_writer ();
+
 	std::string pending_state_file_path(_session_dir->root_path());
 
 	pending_state_file_path = Glib::build_filename (pending_state_file_path, legalize_for_path (_current_snapshot_name) + pending_suffix);
@@ -794,6 +797,9 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 		return 1;
 	}
 
+	/* the previous pending save may still be in progress */
+	wait_for_state_writer ();
+
 	if (g_atomic_int_get(&_suspend_save)) {
 		/* StateProtector cannot be used for templates or save-as */
 		assert (!template_only && !switch_to_snapshot && !for_archive && (snapshot_name.empty () || snapshot_name == _current_snapshot_name));
@@ -876,33 +882,24 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 	std::string tmp_path(_session_dir->root_path());
 	tmp_path = Glib::build_filename (tmp_path, legalize_for_path (snapshot_name) + temp_suffix);
 
+	if (pending && !Profile->get_mixbus()) {
+		/* nobody waits for the pending state. The tree is complete and
+		 * no longer refers to any session object, so it can be
+		 * formatted and written by a background thread.
+		 */
+		XMLTree* snapshot = new XMLTree;
+		snapshot->set_root (tree.root ());
+		tree.set_root (0);
+		write_state_file_in_background (snapshot, tmp_path, xml_path);
 #ifndef NDEBUG
-	cerr << "actually writing state to " << tmp_path << endl;
+		const int64_t elapsed_time_us = g_get_monotonic_time() - save_start_time;
+		cerr << "prepared pending state in " << fixed << setprecision (1) << elapsed_time_us / 1000. << " ms\n";
 #endif
+		return 0;
+	}
 
-	if (!tree.write (tmp_path)) {
-		error << string_compose (_("state could not be saved to %1"), tmp_path) << endmsg;
-		if (g_remove (tmp_path.c_str()) != 0) {
-			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
-					tmp_path, g_strerror (errno)) << endmsg;
-		}
+	if (write_state_file (tree, tmp_path, xml_path)) {
 		return -1;
-
-	} else {
-
-#ifndef NDEBUG
-		cerr << "renaming state to " << xml_path << endl;
-#endif
-
-		if (::g_rename (tmp_path.c_str(), xml_path.c_str()) != 0) {
-			error << string_compose (_("could not rename temporary session file %1 to %2 (%3)"),
-					tmp_path, xml_path, g_strerror(errno)) << endmsg;
-			if (g_remove (tmp_path.c_str()) != 0) {
-				error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
-						tmp_path, g_strerror (errno)) << endmsg;
-			}
-			return -1;
-		}
 	}
 
 	//Mixbus auto-backup mechanism
@@ -953,6 +950,64 @@ Session::save_state (string snapshot_name, bool pending, bool switch_to_snapshot
 	return 0;
 }
 
+int
+Session::write_state_file (XMLTree& tree, std::string const& tmp_path, std::string const& xml_path)
+{
+#ifndef NDEBUG
+	cerr << "actually writing state to " << tmp_path << endl;
+#endif
+
+	if (!tree.write (tmp_path)) {
+		error << string_compose (_("state could not be saved to %1"), tmp_path) << endmsg;
+		if (g_remove (tmp_path.c_str()) != 0) {
+			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
+					tmp_path, g_strerror (errno)) << endmsg;
+		}
+		return -1;
+	}
+
+#ifndef NDEBUG
+	cerr << "renaming state to " << xml_path << endl;
+#endif
+
+	if (::g_rename (tmp_path.c_str(), xml_path.c_str()) != 0) {
+		error << string_compose (_("could not rename temporary session file %1 to %2 (%3)"),
+				tmp_path, xml_path, g_strerror(errno)) << endmsg;
+		if (g_remove (tmp_path.c_str()) != 0) {
+			error << string_compose(_("Could not remove temporary session file at path \"%1\" (%2)"),
+					tmp_path, g_strerror (errno)) << endmsg;
+		}
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+Session::write_state_file_in_background (XMLTree* tree, std::string tmp_path, std::string xml_path)
+{
+	Glib::Threads::Mutex::Lock lm (_state_writer_lock);
+	assert (!_state_writer_thread);
+	_state_writer_thread = Glib::Threads::Thread::create (boost::bind (&Session::background_state_write, this, tree, tmp_path, xml_path));
+}
+
+void
+Session::background_state_write (XMLTree* tree, std::string tmp_path, std::string xml_path)
+{
+	write_state_file (*tree, tmp_path, xml_path);
+	delete tree;
+}
+
+void
+Session::wait_for_state_writer ()
+{
+	Glib::Threads::Mutex::Lock lm (_state_writer_lock);
+	if (_state_writer_thread) {
+		_state_writer_thread->join ();
+		_state_writer_thread = 0;
+	}
+}
+
 int
 Session::restore_state (string snapshot_name)
 {
@@ -1660,6 +1715,11 @@ Session::set_state (const XMLNode& node, int version)
 		AudioFileSource::set_header_position_offset (_session_range_location->start());
 	}
 
+	/* MIDI models of the sources above are loaded in parallel in the
+	 * background, regions and playlists need them.
+	 */
+	SourceFactory::wait_for_midi_models ();
+
 	if ((child = find_named_node (node, "Regions")) == 0) {
 		error << _("Session: XML state has no Regions section") << endmsg;
 		goto out;
@@ -1802,6 +1862,9 @@ Session::set_state (const XMLNode& node, int version)
 	return 0;
 
 out:
+	/* do not leave models of the sources loaded above still loading */
+	SourceFactory::wait_for_midi_models ();
+
 	delete state_tree;
 	state_tree = 0;
 	return ret;
@@ -2134,6 +2197,8 @@ Session::load_nested_sources (const XMLNode& node)
 			}
 		}
 	}
+
+	SourceFactory::wait_for_midi_models ();
 }
 
 boost::shared_ptr<Region>
@@ -4345,6 +4410,9 @@ Session::rename (const std::string& new_name)
 
 	StateProtector stp (this);
 
+	/* finish writing the pending state before moving files */
+	wait_for_state_writer ();
+
 	/* Rename:
 
 	 * session directory
@@ -23,6 +23,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <vector>
 
 #include <sys/time.h>
@@ -615,11 +616,17 @@ SMFSource::safe_midi_file_extension (const string& file)
 	return true;
 }
 
-static bool compare_eventlist (
-	const std::pair< const Evoral::Event<Temporal::Beats>*, gint >& a,
-	const std::pair< const Evoral::Event<Temporal::Beats>*, gint >& b) {
-	return ( a.first->time() < b.first->time() );
-}
+/** An event read by load_model(), its data lives in a shared buffer */
+struct LoadedEvent {
+	Temporal::Beats time;
+	gint            id;
+	uint32_t        offset;
+	uint32_t        size;
+
+	bool operator< (LoadedEvent const& other) const {
+		return time < other.time;
+	}
+};
 
 void
 SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload)
@@ -649,7 +656,6 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 	Evoral::SMF::seek_to_start();
 
 	uint64_t time = 0; /* in SMF ticks */
-	Evoral::Event<Temporal::Beats> ev;
 
 	uint32_t scratch_size = 0; // keep track of scratch and minimize reallocs
 
@@ -660,8 +666,12 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 	gint event_id;
 	bool have_event_id;
 
-	// TODO simplify event allocation
-	std::list< std::pair< Evoral::Event<Temporal::Beats>*, gint > > eventlist;
+	/* Events of all tracks are collected in one buffer rather than
+	 * allocated one by one. Each track is already in time order, so only
+	 * files with more than one track need sorting.
+	 */
+	std::vector<LoadedEvent> events;
+	std::vector<uint8_t>     data;
 
 	for (unsigned i = 1; i <= num_tracks(); ++i) {
 		if (seek_to_track(i)) continue;
@@ -701,11 +711,13 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 							delta_t, time, size, ss, event_id, name()));
 #endif
 
-				eventlist.push_back(make_pair (
-							new Evoral::Event<Temporal::Beats> (
-								Evoral::MIDI_EVENT, event_time,
-								size, buf, true)
-							, event_id));
+				LoadedEvent ev;
+				ev.time   = event_time;
+				ev.id     = event_id;
+				ev.offset = data.size ();
+				ev.size   = size;
+				events.push_back (ev);
+				data.insert (data.end (), buf, buf + size);
 
 				// Set size to max capacity to minimize allocs in read_event
 				scratch_size = std::max(size, scratch_size);
@@ -719,12 +731,15 @@ SMFSource::load_model (const Glib::Threads::Mutex::Lock& lock, bool force_reload
 		}
 	}
 
-	eventlist.sort(compare_eventlist);
+	if (num_tracks() > 1) {
+		std::stable_sort (events.begin(), events.end());
+	}
+
+	Evoral::Event<Temporal::Beats> ev (Evoral::MIDI_EVENT, Temporal::Beats(), 4, NULL, true);
 
-	std::list< std::pair< Evoral::Event<Temporal::Beats>*, gint > >::iterator it;
-	for (it=eventlist.begin(); it!=eventlist.end(); ++it) {
-		_model->append (*it->first, it->second);
-		delete it->first;
+	for (std::vector<LoadedEvent>::const_iterator it = events.begin(); it != events.end(); ++it) {
+		ev.set (&data[it->offset], it->size, it->time);
+		_model->append (ev, it->id);
 	}
 
         // cerr << "----SMF-SRC-----\n";
@@ -30,9 +30,14 @@
 #include <cerrno>
 #include <climits>
 #include <cstdarg>
+#include <limits>
 #include <fcntl.h>
 
 #include <sys/stat.h>
+#ifndef PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include <glib.h>
 #include "pbd/gstdio_compat.h"
@@ -41,6 +46,7 @@
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
+#include "ardour/rc_configuration.h"
 #include "ardour/runtime_functions.h"
 #include "ardour/sndfilesource.h"
 #include "ardour/sndfile_helpers.h"
@@ -64,7 +70,14 @@ SndFileSource::SndFileSource (Session& s, const XMLNode& node)
 	: Source(s, node)
 	, AudioFileSource (s, node)
 	, _sndfile (0)
+	, _fd (-1)
 	, _broadcast_info (0)
+	, _map_addr (0)
+	, _map_length (0)
+	, _map_data (0)
+	, _map_sample_bytes (0)
+	, _map_float (false)
+	, _map_tried (false)
 {
 	init_sndfile ();
 
@@ -84,7 +97,14 @@ SndFileSource::SndFileSource (Session& s, const string& path, int chn, Flag flag
           /* note that the origin of an external file is itself */
 	, AudioFileSource (s, path, Flag (flags & ~(Writable|Removable|RemovableIfEmpty|RemoveAtDestroy)))
 	, _sndfile (0)
+	, _fd (-1)
 	, _broadcast_info (0)
+	, _map_addr (0)
+	, _map_length (0)
+	, _map_data (0)
+	, _map_sample_bytes (0)
+	, _map_float (false)
+	, _map_tried (false)
 {
 	_channel = chn;
 
@@ -106,7 +126,14 @@ SndFileSource::SndFileSource (Session& s, const string& path, const string& orig
 	: Source(s, DataType::AUDIO, path, flags)
 	, AudioFileSource (s, path, origin, flags, sfmt, hf)
 	, _sndfile (0)
+	, _fd (-1)
 	, _broadcast_info (0)
+	, _map_addr (0)
+	, _map_length (0)
+	, _map_data (0)
+	, _map_sample_bytes (0)
+	, _map_float (false)
+	, _map_tried (false)
 {
 	int fmt = 0;
 
@@ -207,7 +234,14 @@ SndFileSource::SndFileSource (Session& s, const string& path, int chn)
 	  /* the final boolean argument is not used, its value is irrelevant. see audiofilesource.h for explanation */
 	, AudioFileSource (s, path, Flag (0))
 	, _sndfile (0)
+	, _fd (-1)
 	, _broadcast_info (0)
+	, _map_addr (0)
+	, _map_length (0)
+	, _map_data (0)
+	, _map_sample_bytes (0)
+	, _map_float (false)
+	, _map_tried (false)
 {
 	_channel = chn;
 
@@ -226,7 +260,14 @@ SndFileSource::SndFileSource (Session& s, const AudioFileSource& other, const st
 	: Source(s, DataType::AUDIO, path, Flag ((other.flags () | default_writable_flags | NoPeakFile) & ~RF64_RIFF))
 	, AudioFileSource (s, path, "", Flag ((other.flags () | default_writable_flags | NoPeakFile) & ~RF64_RIFF), /*unused*/ FormatFloat, /*unused*/ WAVE64)
 	, _sndfile (0)
+	, _fd (-1)
 	, _broadcast_info (0)
+	, _map_addr (0)
+	, _map_length (0)
+	, _map_data (0)
+	, _map_sample_bytes (0)
+	, _map_float (false)
+	, _map_tried (false)
 {
 	if (other.readable_length () == 0) {
 		throw failed_constructor();
@@ -255,6 +296,7 @@ SndFileSource::SndFileSource (Session& s, const AudioFileSource& other, const st
 	}
 
 	_sndfile = sf_open_fd (fd, SFM_WRITE, &_info, true);
+	_fd = _sndfile ? fd : -1;
 
 	if (_sndfile == 0) {
 		throw failed_constructor();
@@ -330,8 +372,10 @@ void
 SndFileSource::close ()
 {
 	if (_sndfile) {
+		unmap_file ();
 		sf_close (_sndfile);
 		_sndfile = 0;
+		_fd = -1;
 		file_closed ();
 	}
 }
@@ -372,12 +416,15 @@ SndFileSource::open ()
 		return -1;
 	}
 
+	_fd = fd;
+
 	if (_channel >= _info.channels) {
 #ifndef HAVE_COREAUDIO
 		error << string_compose(_("SndFileSource: file only contains %1 channels; %2 is invalid as a channel number"), _info.channels, _channel) << endmsg;
 #endif
 		sf_close (_sndfile);
 		_sndfile = 0;
+		_fd = -1;
 		return -1;
 	}
 
@@ -513,6 +560,10 @@ SndFileSource::read_unlocked (Sample *dst, samplepos_t start, samplecnt_t cnt) c
 		memset (dst+file_cnt, 0, sizeof (Sample) * delta);
 	}
 
+	if (file_cnt && map_file ()) {
+		return read_mapped (dst, start, file_cnt);
+	}
+
 	if (file_cnt) {
 
 		if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
@@ -563,6 +614,274 @@ SndFileSource::read_unlocked (Sample *dst, samplepos_t start, samplecnt_t cnt) c
 	return nread;
 }
 
+/** Map the file into memory, if it can be read without libsndfile.
+ *  @return true if the file is mapped.
+ */
+bool
+SndFileSource::map_file () const
+{
+#ifdef PLATFORM_WINDOWS
+	return false;
+#else
+	if (_map_data) {
+		return true;
+	}
+
+	if (_map_tried) {
+		return false;
+	}
+
+	/* only try once for every open() */
+	_map_tried = true;
+
+	if (writable () || !Config->get_mmap_audio_files () || _length == 0) {
+		return false;
+	}
+
+	int  sample_bytes;
+	bool is_float = false;
+
+	switch (_info.format & SF_FORMAT_SUBMASK) {
+	case SF_FORMAT_PCM_16:
+		sample_bytes = 2;
+		break;
+	case SF_FORMAT_PCM_24:
+		sample_bytes = 3;
+		break;
+	case SF_FORMAT_PCM_32:
+		sample_bytes = 4;
+		break;
+	case SF_FORMAT_FLOAT:
+		sample_bytes = 4;
+		is_float = true;
+		break;
+	default:
+		return false;
+	}
+
+	/* sample data must be in our byte order */
+	bool little_endian;
+
+	switch (_info.format & SF_FORMAT_ENDMASK) {
+	case SF_ENDIAN_LITTLE:
+		little_endian = true;
+		break;
+	case SF_ENDIAN_BIG:
+		little_endian = false;
+		break;
+	case SF_ENDIAN_FILE:
+		switch (_info.format & SF_FORMAT_TYPEMASK) {
+		case SF_FORMAT_WAV:
+		case SF_FORMAT_WAVEX:
+		case SF_FORMAT_W64:
+#ifdef HAVE_RF64_RIFF
+		case SF_FORMAT_RF64:
+#endif
+			little_endian = true;
+			break;
+		case SF_FORMAT_AIFF:
+		case SF_FORMAT_CAF:
+			little_endian = false;
+			break;
+		default:
+			return false;
+		}
+		break;
+	default:
+		return false;
+	}
+
+	if (little_endian != (G_BYTE_ORDER == G_LITTLE_ENDIAN)) {
+		return false;
+	}
+
+	/* let libsndfile find the start of the data */
+	if (sf_seek (_sndfile, 0, SEEK_SET|SFM_READ) != 0) {
+		return false;
+	}
+
+	off_t const data_offset = lseek (_fd, 0, SEEK_CUR);
+	uint64_t const data_length = (uint64_t) _length * _info.channels * sample_bytes;
+	struct stat statbuf;
+
+	if (data_offset <= 0 || fstat (_fd, &statbuf) != 0 || (uint64_t) data_offset + data_length > (uint64_t) statbuf.st_size) {
+		return false;
+	}
+
+	/* on 32-bit hosts large files do not fit into the address space */
+	if ((uint64_t) data_offset + data_length > (uint64_t) std::numeric_limits<size_t>::max ()) {
+		return false;
+	}
+
+	void* addr = mmap (0, (size_t) (data_offset + data_length), PROT_READ, MAP_SHARED, _fd, 0);
+
+	if (addr == MAP_FAILED) {
+		/* e.g. out of address space; libsndfile will do */
+		return false;
+	}
+
+	_map_addr         = addr;
+	_map_length       = (size_t) (data_offset + data_length);
+	_map_data         = (uint8_t const*) addr + data_offset;
+	_map_sample_bytes = sample_bytes;
+	_map_float        = is_float;
+
+	return true;
+#endif
+}
+
+void
+SndFileSource::unmap_file ()
+{
+#ifndef PLATFORM_WINDOWS
+	if (_map_addr) {
+		munmap (_map_addr, _map_length);
+	}
+#endif
+	_map_addr         = 0;
+	_map_length       = 0;
+	_map_data         = 0;
+	_map_sample_bytes = 0;
+	_map_tried        = false;
+}
+
+/** Read (and convert) samples of our channel straight from the memory map.
+ *  The caller has checked that start...start+cnt is within the file.
+ */
+samplecnt_t
+SndFileSource::read_mapped (Sample *dst, samplepos_t start, samplecnt_t cnt) const
+{
+	size_t const stride = _info.channels * _map_sample_bytes;
+	uint8_t const* src  = _map_data + start * stride + _channel * _map_sample_bytes;
+
+	/* The data is not necessarily aligned, so copy it out with memcpy(),
+	 * which compilers turn into plain (vectorizable) loads.
+	 */
+	if (_map_float) {
+		if (_info.channels == 1) {
+			memcpy (dst, src, cnt * sizeof (Sample));
+		} else {
+			for (samplecnt_t n = 0; n < cnt; ++n, src += stride) {
+				memcpy (dst + n, src, sizeof (Sample));
+			}
+		}
+	} else {
+		switch (_map_sample_bytes) {
+		case 2:
+			for (samplecnt_t n = 0; n < cnt; ++n, src += stride) {
+				int16_t v;
+				memcpy (&v, src, sizeof (v));
+				dst[n] = v * (1.f / 32768.f);
+			}
+			break;
+		case 3:
+			for (samplecnt_t n = 0; n < cnt; ++n, src += stride) {
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+				int32_t const v = (int32_t) (((uint32_t) src[0] << 8) | ((uint32_t) src[1] << 16) | ((uint32_t) src[2] << 24));
+#else
+				int32_t const v = (int32_t) (((uint32_t) src[2] << 8) | ((uint32_t) src[1] << 16) | ((uint32_t) src[0] << 24));
+#endif
+				dst[n] = v * (1.f / 2147483648.f);
+			}
+			break;
+		case 4:
+			for (samplecnt_t n = 0; n < cnt; ++n, src += stride) {
+				int32_t v;
+				memcpy (&v, src, sizeof (v));
+				dst[n] = v * (1.f / 2147483648.f);
+			}
+			break;
+		}
+	}
+
+	if (_gain != 1.f) {
+		for (samplecnt_t n = 0; n < cnt; ++n) {
+			dst[n] *= _gain;
+		}
+	}
+
+	return cnt;
+}
+
+void
+SndFileSource::prefetch_unlocked (samplepos_t start, samplecnt_t cnt) const
+{
+#if defined POSIX_FADV_WILLNEED || defined F_RDADVISE
+	/* files that are being written are in the page-cache anyway */
+	if (writable () || start >= _length) {
+		return;
+	}
+
+#ifndef PLATFORM_WINDOWS
+	if (map_file ()) {
+		/* page-align the range within the map */
+		size_t const  page   = sysconf (_SC_PAGESIZE);
+		size_t const  stride = _info.channels * _map_sample_bytes;
+		uint8_t const* from  = _map_data + start * stride;
+		uint8_t const* to    = from + min (cnt, _length - start) * stride;
+
+		from = (uint8_t const*) _map_addr + (((from - (uint8_t const*) _map_addr) / page) * page);
+		madvise (const_cast<uint8_t*> (from), to - from, MADV_WILLNEED);
+		return;
+	}
+#endif
+
+	int bytes_per_sample;
+
+	switch (_info.format & SF_FORMAT_SUBMASK) {
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
+		bytes_per_sample = 1;
+		break;
+	case SF_FORMAT_PCM_16:
+		bytes_per_sample = 2;
+		break;
+	case SF_FORMAT_PCM_24:
+		bytes_per_sample = 3;
+		break;
+	case SF_FORMAT_PCM_32:
+	case SF_FORMAT_FLOAT:
+		bytes_per_sample = 4;
+		break;
+	case SF_FORMAT_DOUBLE:
+		bytes_per_sample = 8;
+		break;
+	default:
+		/* compressed data, we don't know where it is */
+		return;
+	}
+
+	if (const_cast<SndFileSource*>(this)->open()) {
+		return;
+	}
+
+	/* let libsndfile take care of the header, and ask the
+	 * file descriptor where that left us.
+	 */
+	if (sf_seek (_sndfile, (sf_count_t) start, SEEK_SET|SFM_READ) != (sf_count_t) start) {
+		return;
+	}
+
+	off_t const offset = lseek (_fd, 0, SEEK_CUR);
+
+	if (offset < 0) {
+		return;
+	}
+
+	off_t const len = (off_t) min (cnt, _length - start) * _info.channels * bytes_per_sample;
+
+#ifdef POSIX_FADV_WILLNEED
+	posix_fadvise (_fd, offset, len, POSIX_FADV_WILLNEED);
+#else
+	struct radvisory ra;
+	ra.ra_offset = offset;
+	ra.ra_count  = len > INT_MAX ? INT_MAX : (int) len;
+	fcntl (_fd, F_RDADVISE, &ra);
+#endif
+
+#endif
+}
+
 samplecnt_t
 SndFileSource::write_unlocked (Sample *data, samplecnt_t cnt)
 {
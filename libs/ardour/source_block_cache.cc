@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "ardour/audio_track.h"
+#include "ardour/audioregion.h"
+#include "ardour/audiosource.h"
+#include "ardour/location.h"
+#include "ardour/playlist.h"
+#include "ardour/rc_configuration.h"
+#include "ardour/session.h"
+#include "ardour/source_block_cache.h"
+
+using namespace ARDOUR;
+using namespace std;
+
+/** maximum number of blocks that update() reads at a time */
+static const size_t fill_batch = 16;
+
+const samplecnt_t SourceBlockCache::block_samples;
+
+SourceBlockCache::SourceBlockCache ()
+	: _active (0)
+	, _capacity (0)
+	, _n_pinned (0)
+	, _signature (0)
+	, _generation (0)
+	, _hits (0)
+	, _misses (0)
+{
+}
+
+SourceBlockCache::~SourceBlockCache ()
+{
+	clear ();
+}
+
+bool
+SourceBlockCache::read (AudioSource const& src, Sample* dst, samplepos_t start, samplecnt_t cnt)
+{
+	if (cnt <= 0 || !g_atomic_int_get (&_active)) {
+		return false;
+	}
+
+	/* never block the caller on the cache */
+	Glib::Threads::Mutex::Lock lm (_lock, Glib::Threads::TRY_LOCK);
+
+	if (!lm.locked () || _capacity == 0) {
+		return false;
+	}
+
+	PBD::ID const& id (src.id ());
+	samplepos_t const first = start / block_samples;
+	samplepos_t const last  = (start + cnt - 1) / block_samples;
+
+	for (samplepos_t b = first; b <= last; ++b) {
+		Blocks::const_iterator i = _blocks.find (BlockKey (id, b));
+		samplepos_t const end = min ((b + 1) * block_samples, start + cnt) - b * block_samples;
+		if (i == _blocks.end () || (samplepos_t) i->second->data.size () < end) {
+			if (_pins.find (BlockKey (id, b)) != _pins.end ()) {
+				++_misses;
+			}
+			return false;
+		}
+	}
+
+	for (samplepos_t b = first; b <= last; ++b) {
+		Block* blk = _blocks[BlockKey (id, b)];
+		samplepos_t const from = max (start, b * block_samples);
+		samplepos_t const to   = min (start + cnt, (b + 1) * block_samples);
+		copy (blk->data.begin () + (from - b * block_samples), blk->data.begin () + (to - b * block_samples), dst + (from - start));
+		_lru.splice (_lru.begin (), _lru, blk->lru);
+	}
+
+	++_hits;
+	return true;
+}
+
+bool
+SourceBlockCache::update (Session& s)
+{
+	size_t const capacity = (size_t) Config->get_loop_cache_mbytes () * 1048576 / (block_samples * sizeof (Sample));
+
+	if (capacity == 0) {
+		if (_capacity != 0) {
+			clear ();
+		}
+		return false;
+	}
+
+	uint64_t const sig = signature (s);
+
+	if (capacity != _capacity || sig != _signature) {
+		Pins pins;
+		find_pins (s, capacity, pins);
+		{
+			Glib::Threads::Mutex::Lock lm (_lock);
+			_capacity  = capacity;
+			_signature = sig;
+			set_pins (pins);
+			evict ();
+		}
+		g_atomic_int_set (&_active, 1);
+	}
+
+	Pins batch;
+	uint64_t generation;
+	{
+		Glib::Threads::Mutex::Lock lm (_lock);
+		generation = _generation;
+		Pins::iterator i = _to_fill.begin ();
+		while (i != _to_fill.end () && batch.size () < fill_batch) {
+			batch.insert (*i);
+			_to_fill.erase (i++);
+		}
+	}
+
+	/* read without holding the cache lock, so that the disk readers are
+	 * not held up by a slow disk
+	 */
+	for (Pins::iterator i = batch.begin (); i != batch.end (); ++i) {
+		boost::shared_ptr<AudioSource> src = i->second.lock ();
+		if (!src) {
+			continue;
+		}
+		samplepos_t const start = i->first.second * block_samples;
+		samplecnt_t const cnt   = min (block_samples, src->readable_length () - start);
+		if (cnt <= 0) {
+			continue;
+		}
+		vector<Sample> data (cnt);
+		samplecnt_t n;
+		{
+			Glib::Threads::Mutex::Lock lm (src->_lock);
+			n = src->read_unlocked (&data[0], start, cnt);
+		}
+		if (n != cnt) {
+			continue;
+		}
+		Glib::Threads::Mutex::Lock lm (_lock);
+		if (_generation != generation) {
+			/* drop() was called while reading, the data may be stale */
+			if (_pins.find (i->first) != _pins.end ()) {
+				_to_fill.insert (*i);
+			}
+			continue;
+		}
+		insert (i->first, data);
+	}
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+	evict ();
+	return !_to_fill.empty ();
+}
+
+void
+SourceBlockCache::drop (AudioSource const& src)
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+
+	PBD::ID const& id (src.id ());
+	Blocks::iterator i = _blocks.lower_bound (BlockKey (id, 0));
+
+	while (i != _blocks.end () && i->first.first == id) {
+		Pins::const_iterator p = _pins.find (i->first);
+		if (p != _pins.end ()) {
+			_to_fill.insert (*p);
+		}
+		_lru.erase (i->second->lru);
+		delete i->second;
+		_blocks.erase (i++);
+	}
+
+	++_generation;
+}
+
+void
+SourceBlockCache::clear ()
+{
+	g_atomic_int_set (&_active, 0);
+
+	Glib::Threads::Mutex::Lock lm (_lock);
+	for (Blocks::iterator i = _blocks.begin (); i != _blocks.end (); ++i) {
+		delete i->second;
+	}
+	_blocks.clear ();
+	_lru.clear ();
+	_pins.clear ();
+	_to_fill.clear ();
+	_capacity  = 0;
+	_n_pinned  = 0;
+	_signature = 0;
+}
+
+SourceBlockCache::Stats
+SourceBlockCache::stats () const
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	Stats st;
+	st.hits          = _hits;
+	st.misses        = _misses;
+	st.blocks        = _blocks.size ();
+	st.pinned_blocks = _pins.size ();
+	st.bytes         = 0;
+	for (Blocks::const_iterator i = _blocks.begin (); i != _blocks.end (); ++i) {
+		st.bytes += i->second->data.size () * sizeof (Sample);
+	}
+	return st;
+}
+
+void
+SourceBlockCache::reset_stats ()
+{
+	Glib::Threads::Mutex::Lock lm (_lock);
+	_hits   = 0;
+	_misses = 0;
+}
+
+/** @return a value that changes whenever the pinned blocks may have to change */
+uint64_t
+SourceBlockCache::signature (Session& s) const
+{
+	uint64_t sig = 14695981039346656037ULL;
+#define MIX(v) sig = (sig ^ (uint64_t) (v)) * 1099511628211ULL
+
+	Location* loop  = s.locations ()->auto_loop_location ();
+	Location* punch = s.locations ()->auto_punch_location ();
+
+	if (loop) {
+		MIX (loop->start ());
+		MIX (loop->end ());
+	}
+	if (punch) {
+		MIX (punch->start ());
+		MIX (punch->end ());
+	}
+
+	boost::shared_ptr<RouteList> rl = s.get_tracks ();
+	for (RouteList::const_iterator r = rl->begin (); r != rl->end (); ++r) {
+		boost::shared_ptr<AudioTrack> tr = boost::dynamic_pointer_cast<AudioTrack> (*r);
+		if (!tr) {
+			continue;
+		}
+		boost::shared_ptr<Playlist> pl = tr->playlist ();
+		MIX ((uintptr_t) pl.get ());
+		if (pl) {
+			MIX (pl->contents_generation ());
+		}
+	}
+#undef MIX
+	return sig;
+}
+
+void
+SourceBlockCache::find_pins (Session& s, size_t capacity, Pins& pins) const
+{
+	vector<Location*> ranges;
+
+	if (Location* loop = s.locations ()->auto_loop_location ()) {
+		ranges.push_back (loop);
+	}
+	if (Location* punch = s.locations ()->auto_punch_location ()) {
+		ranges.push_back (punch);
+	}
+
+	if (ranges.empty ()) {
+		return;
+	}
+
+	boost::shared_ptr<RouteList> rl = s.get_tracks ();
+
+	for (vector<Location*>::const_iterator l = ranges.begin (); l != ranges.end (); ++l) {
+		samplepos_t const start = (*l)->start ();
+		samplepos_t const end   = (*l)->end ();
+
+		for (RouteList::const_iterator r = rl->begin (); r != rl->end (); ++r) {
+			boost::shared_ptr<AudioTrack> tr = boost::dynamic_pointer_cast<AudioTrack> (*r);
+			if (!tr || !tr->playlist ()) {
+				continue;
+			}
+
+			boost::shared_ptr<RegionList> regions = tr->playlist ()->regions_touched (start, end);
+
+			for (RegionList::const_iterator i = regions->begin (); i != regions->end (); ++i) {
+				boost::shared_ptr<AudioRegion> ar = boost::dynamic_pointer_cast<AudioRegion> (*i);
+				if (!ar) {
+					continue;
+				}
+
+				/* the part of the region inside the range, in source samples */
+				samplepos_t const from = max (start, ar->position ()) - ar->position () + ar->start ();
+				samplepos_t const to   = min (end, ar->last_sample ()) - ar->position () + ar->start ();
+
+				for (uint32_t c = 0; c < ar->n_channels (); ++c) {
+					boost::shared_ptr<AudioSource> src = ar->audio_source (c);
+					if (!src || src->writable ()) {
+						/* files that are being recorded to change under us */
+						continue;
+					}
+					for (samplepos_t b = from / block_samples; b <= to / block_samples; ++b) {
+						if (pins.size () >= capacity) {
+							return;
+						}
+						pins.insert (make_pair (BlockKey (src->id (), b), boost::weak_ptr<AudioSource> (src)));
+					}
+				}
+			}
+		}
+	}
+}
+
+/* Caller must hold _lock */
+void
+SourceBlockCache::set_pins (Pins const& pins)
+{
+	for (Blocks::iterator i = _blocks.begin (); i != _blocks.end (); ++i) {
+		i->second->pinned = false;
+	}
+
+	_pins = pins;
+	_to_fill.clear ();
+
+	for (Pins::const_iterator i = _pins.begin (); i != _pins.end (); ++i) {
+		Blocks::iterator b = _blocks.find (i->first);
+		if (b != _blocks.end ()) {
+			b->second->pinned = true;
+		} else {
+			_to_fill.insert (*i);
+		}
+	}
+}
+
+/* Caller must hold _lock */
+void
+SourceBlockCache::insert (BlockKey const& key, vector<Sample>& data)
+{
+	if (_pins.find (key) == _pins.end ()) {
+		/* no longer wanted, the ranges changed while reading */
+		return;
+	}
+
+	Blocks::iterator i = _blocks.find (key);
+	Block* blk;
+
+	if (i == _blocks.end ()) {
+		blk = new Block;
+		_lru.push_front (key);
+		blk->lru = _lru.begin ();
+		_blocks.insert (make_pair (key, blk));
+	} else {
+		blk = i->second;
+		_lru.splice (_lru.begin (), _lru, blk->lru);
+	}
+
+	blk->data.swap (data);
+	blk->pinned = true;
+}
+
+/* Caller must hold _lock */
+void
+SourceBlockCache::evict ()
+{
+	list<BlockKey>::iterator i = _lru.end ();
+
+	while (_blocks.size () > _capacity && i != _lru.begin ()) {
+		--i;
+		Blocks::iterator b = _blocks.find (*i);
+		assert (b != _blocks.end ());
+		if (b->second->pinned) {
+			continue;
+		}
+		delete b->second;
+		_blocks.erase (b);
+		i = _lru.erase (i);
+	}
+}
@@ -24,8 +24,12 @@
 #include "libardour-config.h"
 #endif
 
+#include <map>
+
 #include "pbd/error.h"
 #include "pbd/convert.h"
+#include "pbd/cpus.h"
+#include "pbd/gstdio_compat.h"
 #include "pbd/pthread_utils.h"
 #include "pbd/stacktrace.h"
 
@@ -35,6 +39,7 @@
 #include "ardour/midi_playlist.h"
 #include "ardour/midi_playlist_source.h"
 #include "ardour/mp3filesource.h"
+#include "ardour/rc_configuration.h"
 #include "ardour/source.h"
 #include "ardour/source_factory.h"
 #include "ardour/sndfilesource.h"
@@ -55,9 +60,51 @@ using namespace PBD;
 PBD::Signal1<void,boost::shared_ptr<Source> > SourceFactory::SourceCreated;
 Glib::Threads::Cond SourceFactory::PeaksToBuild;
 Glib::Threads::Mutex SourceFactory::peak_building_lock;
-std::list<boost::weak_ptr<AudioSource> > SourceFactory::files_with_peaks;
+std::list<SourceFactory::PeakBuildRequest> SourceFactory::files_with_peaks;
 
+/* all protected by peak_building_lock */
 static int active_threads = 0;
+static int peak_work_done = 0;
+static int peak_work_total = 0;
+static std::map<uint64_t, int> active_per_device;
+
+static void
+peak_work_finished ()
+{
+	if (++peak_work_done >= peak_work_total && active_threads == 0 && SourceFactory::files_with_peaks.empty ()) {
+		peak_work_done = peak_work_total = 0;
+	}
+}
+
+/** Take the first queued source whose disk is not yet busy with
+ *  Config->get_peak_builder_threads_per_disk() other sources.
+ *  peak_building_lock must be held.
+ */
+static bool
+next_peak_work (boost::shared_ptr<AudioSource>& as, uint64_t& device, bool& levels_only)
+{
+	int const per_device = max (1, (int) Config->get_peak_builder_threads_per_disk ());
+
+	std::list<SourceFactory::PeakBuildRequest>::iterator i = SourceFactory::files_with_peaks.begin ();
+
+	while (i != SourceFactory::files_with_peaks.end ()) {
+		if (i->source.expired ()) {
+			i = SourceFactory::files_with_peaks.erase (i);
+			peak_work_finished ();
+			continue;
+		}
+		if (active_per_device[i->device] < per_device) {
+			as = i->source.lock ();
+			device = i->device;
+			levels_only = i->levels_only;
+			SourceFactory::files_with_peaks.erase (i);
+			return true;
+		}
+		++i;
+	}
+
+	return false;
+}
 
 static void
 peak_thread_work ()
@@ -67,33 +114,96 @@ peak_thread_work ()
 
 	while (true) {
 
+		boost::shared_ptr<AudioSource> as;
+		uint64_t device;
+		bool levels_only;
+
 		SourceFactory::peak_building_lock.lock ();
 
-	  wait:
-		if (SourceFactory::files_with_peaks.empty()) {
+		/* also woken up when a build on a busy disk completes */
+		while (!next_peak_work (as, device, levels_only)) {
 			SourceFactory::PeaksToBuild.wait (SourceFactory::peak_building_lock);
 		}
 
-		if (SourceFactory::files_with_peaks.empty()) {
-			goto wait;
-		}
-
-		boost::shared_ptr<AudioSource> as (SourceFactory::files_with_peaks.front().lock());
-		SourceFactory::files_with_peaks.pop_front ();
 		++active_threads;
+		++active_per_device[device];
 		SourceFactory::peak_building_lock.unlock ();
 
-		if (!as) {
-			continue;
+		if (as) {
+			if (levels_only) {
+				as->build_peak_levels ();
+			} else {
+				as->setup_peakfile ();
+			}
+			as.reset ();
 		}
 
-		as->setup_peakfile ();
 		SourceFactory::peak_building_lock.lock ();
 		--active_threads;
+		--active_per_device[device];
+		peak_work_finished ();
+		SourceFactory::PeaksToBuild.broadcast ();
 		SourceFactory::peak_building_lock.unlock ();
 	}
 }
 
+/* background loading of MIDI models, all protected by midi_model_lock */
+static Glib::Threads::Mutex midi_model_lock;
+static Glib::Threads::Cond  midi_model_cond;
+static std::list<boost::weak_ptr<SMFSource> > midi_models_to_load;
+static int midi_models_loading = 0;
+
+static void
+midi_model_thread_work ()
+{
+	pthread_set_name ("MidiModelLoader");
+
+	while (true) {
+
+		boost::shared_ptr<SMFSource> src;
+
+		midi_model_lock.lock ();
+
+		while (midi_models_to_load.empty ()) {
+			midi_model_cond.wait (midi_model_lock);
+		}
+
+		src = midi_models_to_load.front ().lock ();
+		midi_models_to_load.pop_front ();
+		++midi_models_loading;
+		midi_model_lock.unlock ();
+
+		if (src) {
+			Source::Lock lock (src->mutex ());
+			src->load_model (lock, true);
+		}
+		src.reset ();
+
+		midi_model_lock.lock ();
+		--midi_models_loading;
+		midi_model_cond.broadcast ();
+		midi_model_lock.unlock ();
+	}
+}
+
+static void
+queue_midi_model (boost::shared_ptr<SMFSource> src)
+{
+	Glib::Threads::Mutex::Lock lm (midi_model_lock);
+	midi_models_to_load.push_back (src);
+	midi_model_cond.broadcast ();
+}
+
+void
+SourceFactory::wait_for_midi_models ()
+{
+	Glib::Threads::Mutex::Lock lm (midi_model_lock);
+
+	while (!midi_models_to_load.empty () || midi_models_loading > 0) {
+		midi_model_cond.wait (midi_model_lock);
+	}
+}
+
 int
 SourceFactory::peak_work_queue_length ()
 {
@@ -102,12 +212,60 @@ SourceFactory::peak_work_queue_length ()
 	return SourceFactory::files_with_peaks.size () + active_threads;
 }
 
+void
+SourceFactory::peak_work_progress (int& done, int& total)
+{
+	Glib::Threads::Mutex::Lock lm (peak_building_lock);
+	done  = peak_work_done;
+	total = peak_work_total;
+}
+
 void
 SourceFactory::init ()
 {
-	for (int n = 0; n < 2; ++n) {
+	uint32_t n_threads = Config->get_peak_builder_threads ();
+
+	if (n_threads == 0) {
+		n_threads = max (2U, hardware_concurrency ());
+	}
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
 		Glib::Threads::Thread::create (sigc::ptr_fun (::peak_thread_work));
 	}
+
+	/* MIDI model loading is CPU bound, use one thread per core */
+	n_threads = max (2U, hardware_concurrency ());
+
+	for (uint32_t n = 0; n < n_threads; ++n) {
+		Glib::Threads::Thread::create (sigc::ptr_fun (::midi_model_thread_work));
+	}
+}
+
+/** Peakfiles of sources on the same disk compete for I/O, so they are
+ *  grouped by device (sources that are not files share one).
+ */
+static uint64_t
+source_device (boost::shared_ptr<AudioSource> as)
+{
+	boost::shared_ptr<FileSource> fs (boost::dynamic_pointer_cast<FileSource> (as));
+	GStatBuf statbuf;
+
+	if (fs && g_stat (fs->path ().c_str (), &statbuf) == 0) {
+		return statbuf.st_dev;
+	}
+
+	return 0;
+}
+
+void
+SourceFactory::queue_peak_levels (boost::shared_ptr<AudioSource> as)
+{
+	uint64_t const device = source_device (as);
+
+	Glib::Threads::Mutex::Lock lm (peak_building_lock);
+	files_with_peaks.push_back (PeakBuildRequest (boost::weak_ptr<AudioSource> (as), device, true));
+	++peak_work_total;
+	PeaksToBuild.broadcast ();
 }
 
 int
@@ -120,8 +278,11 @@ SourceFactory::setup_peakfile (boost::shared_ptr<Source> s, bool async)
 		// immediately set 'peakfile-path' for empty and NoPeakFile sources
 		if (async && !as->empty() && !(as->flags() & Source::NoPeakFile)) {
 
+			uint64_t const device = source_device (as);
+
 			Glib::Threads::Mutex::Lock lm (peak_building_lock);
-			files_with_peaks.push_back (boost::weak_ptr<AudioSource> (as));
+			files_with_peaks.push_back (PeakBuildRequest (boost::weak_ptr<AudioSource> (as), device));
+			++peak_work_total;
 			PeaksToBuild.broadcast ();
 
 		} else {
@@ -215,10 +376,18 @@ SourceFactory::create (Session& s, const XMLNode& node, bool defer_peaks)
 	} else if (type == DataType::MIDI) {
 		try {
 			boost::shared_ptr<SMFSource> src (new SMFSource (s, node));
-			Source::Lock lock(src->mutex());
-			src->load_model (lock, true);
+			if (defer_peaks) {
+				/* as with peaks, build the model in the background
+				 * while the session loads, see wait_for_midi_models()
+				 */
+				queue_midi_model (src);
+			} else {
+				Source::Lock lock(src->mutex());
+				src->load_model (lock, true);
+			}
 			BOOST_MARK_SOURCE (src);
 			src->check_for_analysis_data_on_disk ();
+			/* the model may still be loading, see SourceCreated */
 			SourceCreated (src);
 			return src;
 		} catch (...) {
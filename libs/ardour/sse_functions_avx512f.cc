@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ardour/mix.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+#ifndef __AVX512F__
+#error "__AVX512F__ must be enabled for this module to work"
+#endif
+
+#ifdef __cplusplus
+#define C_FUNC extern "C"
+#else
+#define C_FUNC
+#endif
+
+/* All routines use unaligned loads and stores: on CPUs with AVX-512 these
+ * are as fast as aligned ones when the data happens to be aligned, and a
+ * masked load/store handles the remaining 1..15 samples without a scalar
+ * loop.
+ */
+
+static inline __mmask16
+tail_mask (uint32_t nframes)
+{
+	return (__mmask16) ((1U << nframes) - 1);
+}
+
+/**
+ * @brief x86-64 AVX-512F optimized routine for compute peak procedure
+ * @param src Pointer to source buffer
+ * @param nframes Number of frames to process
+ * @param current Current peak value
+ * @return float New peak value
+ */
+C_FUNC float
+x86_avx512f_compute_peak (const float *src, uint32_t nframes, float current)
+{
+	__m512 vmax0 = _mm512_set1_ps (current);
+	__m512 vmax1 = vmax0;
+
+	while (nframes >= 32) {
+		__builtin_prefetch (src + 64, 0, 0);
+		vmax0 = _mm512_max_ps (vmax0, _mm512_abs_ps (_mm512_loadu_ps (src + 0)));
+		vmax1 = _mm512_max_ps (vmax1, _mm512_abs_ps (_mm512_loadu_ps (src + 16)));
+		src += 32;
+		nframes -= 32;
+	}
+
+	if (nframes >= 16) {
+		vmax0 = _mm512_max_ps (vmax0, _mm512_abs_ps (_mm512_loadu_ps (src)));
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes > 0) {
+		/* masked-off lanes load as 0, which does not affect the peak */
+		vmax1 = _mm512_max_ps (vmax1, _mm512_abs_ps (_mm512_maskz_loadu_ps (tail_mask (nframes), src)));
+	}
+
+	current = _mm512_reduce_max_ps (_mm512_max_ps (vmax0, vmax1));
+
+	_mm256_zeroupper ();
+
+	return current;
+}
+
+/**
+ * @brief x86-64 AVX-512F optimized routine for find peak procedure
+ * @param src Pointer to source buffer
+ * @param nframes Number of frames to process
+ * @param[in,out] minf Current minimum value, updated
+ * @param[in,out] maxf Current maximum value, updated
+ */
+C_FUNC void
+x86_avx512f_find_peaks (const float *src, uint32_t nframes, float *minf, float *maxf)
+{
+	__m512 vmin = _mm512_set1_ps (*minf);
+	__m512 vmax = _mm512_set1_ps (*maxf);
+
+	while (nframes >= 32) {
+		__builtin_prefetch (src + 64, 0, 0);
+		__m512 vsrc0 = _mm512_loadu_ps (src + 0);
+		__m512 vsrc1 = _mm512_loadu_ps (src + 16);
+		vmin = _mm512_min_ps (vmin, _mm512_min_ps (vsrc0, vsrc1));
+		vmax = _mm512_max_ps (vmax, _mm512_max_ps (vsrc0, vsrc1));
+		src += 32;
+		nframes -= 32;
+	}
+
+	if (nframes >= 16) {
+		__m512 vsrc = _mm512_loadu_ps (src);
+		vmin = _mm512_min_ps (vmin, vsrc);
+		vmax = _mm512_max_ps (vmax, vsrc);
+		src += 16;
+		nframes -= 16;
+	}
+
+	if (nframes > 0) {
+		/* lanes that are masked off keep their current min/max */
+		__mmask16 m = tail_mask (nframes);
+		__m512 vsrc = _mm512_maskz_loadu_ps (m, src);
+		vmin = _mm512_mask_min_ps (vmin, m, vmin, vsrc);
+		vmax = _mm512_mask_max_ps (vmax, m, vmax, vsrc);
+	}
+
+	*minf = _mm512_reduce_min_ps (vmin);
+	*maxf = _mm512_reduce_max_ps (vmax);
+
+	_mm256_zeroupper ();
+}
+
+/**
+ * @brief x86-64 AVX-512F optimized routine for apply gain routine
+ * @param[in,out] dst Pointer to the destination buffer, which gets updated
+ * @param nframes Number of frames (or samples) to process
+ * @param gain Gain to apply
+ */
+C_FUNC void
+x86_avx512f_apply_gain_to_buffer (float *dst, uint32_t nframes, float gain)
+{
+	const __m512 vgain = _mm512_set1_ps (gain);
+
+	while (nframes >= 32) {
+		__builtin_prefetch (dst + 64, 0, 0);
+		__m512 d0 = _mm512_loadu_ps (dst + 0);
+		__m512 d1 = _mm512_loadu_ps (dst + 16);
+		_mm512_storeu_ps (dst + 0, _mm512_mul_ps (vgain, d0));
+		_mm512_storeu_ps (dst + 16, _mm512_mul_ps (vgain, d1));
+		dst += 32;
+		nframes -= 32;
+	}
+
+	if (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_mul_ps (vgain, _mm512_loadu_ps (dst)));
+		dst += 16;
+		nframes -= 16;
+	}
+
+	if (nframes > 0) {
+		__mmask16 m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_mul_ps (vgain, _mm512_maskz_loadu_ps (m, dst)));
+	}
+
+	_mm256_zeroupper ();
+}
+
+/**
+ * @brief x86-64 AVX-512F optimized routine for mixing buffer with gain.
+ *
+ * dst = dst + (gain * src), computed with a fused multiply-add. The
+ * result may differ from the unfused routines in the last bit.
+ *
+ * @param[in,out] dst Pointer to destination buffer, which gets updated
+ * @param[in] src Pointer to source buffer (not updated)
+ * @param nframes Number of samples to process
+ * @param gain Gain to apply
+ */
+C_FUNC void
+x86_avx512f_mix_buffers_with_gain (float *dst, const float *src, uint32_t nframes, float gain)
+{
+	const __m512 vgain = _mm512_set1_ps (gain);
+
+	while (nframes >= 32) {
+		__builtin_prefetch (src + 64, 0, 0);
+		__builtin_prefetch (dst + 64, 0, 0);
+		__m512 d0 = _mm512_fmadd_ps (vgain, _mm512_loadu_ps (src + 0), _mm512_loadu_ps (dst + 0));
+		__m512 d1 = _mm512_fmadd_ps (vgain, _mm512_loadu_ps (src + 16), _mm512_loadu_ps (dst + 16));
+		_mm512_storeu_ps (dst + 0, d0);
+		_mm512_storeu_ps (dst + 16, d1);
+		src += 32;
+		dst += 32;
+		nframes -= 32;
+	}
+
+	if (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_fmadd_ps (vgain, _mm512_loadu_ps (src), _mm512_loadu_ps (dst)));
+		src += 16;
+		dst += 16;
+		nframes -= 16;
+	}
+
+	if (nframes > 0) {
+		__mmask16 m = tail_mask (nframes);
+		__m512 d = _mm512_fmadd_ps (vgain, _mm512_maskz_loadu_ps (m, src), _mm512_maskz_loadu_ps (m, dst));
+		_mm512_mask_storeu_ps (dst, m, d);
+	}
+
+	_mm256_zeroupper ();
+}
+
+/**
+ * @brief x86-64 AVX-512F optimized routine for mixing buffer with no gain.
+ * @param[in,out] dst Pointer to destination buffer, which gets updated
+ * @param[in] src Pointer to source buffer (not updated)
+ * @param nframes Number of samples to process
+ */
+C_FUNC void
+x86_avx512f_mix_buffers_no_gain (float *dst, const float *src, uint32_t nframes)
+{
+	while (nframes >= 32) {
+		__builtin_prefetch (src + 64, 0, 0);
+		__builtin_prefetch (dst + 64, 0, 0);
+		__m512 d0 = _mm512_add_ps (_mm512_loadu_ps (dst + 0), _mm512_loadu_ps (src + 0));
+		__m512 d1 = _mm512_add_ps (_mm512_loadu_ps (dst + 16), _mm512_loadu_ps (src + 16));
+		_mm512_storeu_ps (dst + 0, d0);
+		_mm512_storeu_ps (dst + 16, d1);
+		src += 32;
+		dst += 32;
+		nframes -= 32;
+	}
+
+	if (nframes >= 16) {
+		_mm512_storeu_ps (dst, _mm512_add_ps (_mm512_loadu_ps (dst), _mm512_loadu_ps (src)));
+		src += 16;
+		dst += 16;
+		nframes -= 16;
+	}
+
+	if (nframes > 0) {
+		__mmask16 m = tail_mask (nframes);
+		_mm512_mask_storeu_ps (dst, m, _mm512_add_ps (_mm512_maskz_loadu_ps (m, dst), _mm512_maskz_loadu_ps (m, src)));
+	}
+
+	_mm256_zeroupper ();
+}
+
+/**
+ * @brief Copy vector from one location to another
+ *
+ * As with the AVX variant, the C library's memcpy is at least as fast as
+ * a hand-written loop.
+ *
+ * @param[out] dst Pointer to destination buffer
+ * @param[in] src Pointer to source buffer
+ * @param nframes Number of samples to copy
+ */
+C_FUNC void
+x86_avx512f_copy_vector (float *dst, const float *src, uint32_t nframes)
+{
+	(void) memcpy (dst, src, nframes * sizeof (float));
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ardour/mix.h"
+
+#include <immintrin.h>
+
+#ifndef __FMA__
+#error "__FMA__ must be enabled for this module to work"
+#endif
+
+#ifdef __cplusplus
+#define C_FUNC extern "C"
+#else
+#define C_FUNC
+#endif
+
+/**
+ * @brief x86-64 AVX/FMA optimized routine for mixing buffer with gain.
+ *
+ * dst = dst + (gain * src), computed with a fused multiply-add. The
+ * result may differ from the unfused routines in the last bit.
+ *
+ * The other routines do not multiply and add, so the AVX versions are
+ * used for them.
+ *
+ * @param[in,out] dst Pointer to destination buffer, which gets updated
+ * @param[in] src Pointer to source buffer (not updated)
+ * @param nframes Number of samples to process
+ * @param gain Gain to apply
+ */
+C_FUNC void
+x86_fma_mix_buffers_with_gain (float *dst, const float *src, uint32_t nframes, float gain)
+{
+	const __m256 vgain = _mm256_set1_ps (gain);
+
+	while (nframes >= 16) {
+		__builtin_prefetch (src + 64, 0, 0);
+		__builtin_prefetch (dst + 64, 0, 0);
+		__m256 d0 = _mm256_fmadd_ps (vgain, _mm256_loadu_ps (src + 0), _mm256_loadu_ps (dst + 0));
+		__m256 d1 = _mm256_fmadd_ps (vgain, _mm256_loadu_ps (src + 8), _mm256_loadu_ps (dst + 8));
+		_mm256_storeu_ps (dst + 0, d0);
+		_mm256_storeu_ps (dst + 8, d1);
+		src += 16;
+		dst += 16;
+		nframes -= 16;
+	}
+
+	if (nframes >= 8) {
+		_mm256_storeu_ps (dst, _mm256_fmadd_ps (vgain, _mm256_loadu_ps (src), _mm256_loadu_ps (dst)));
+		src += 8;
+		dst += 8;
+		nframes -= 8;
+	}
+
+	_mm256_zeroupper ();
+
+	const __m128 g0 = _mm_set1_ps (gain);
+
+	while (nframes > 0) {
+		_mm_store_ss (dst, _mm_fmadd_ss (g0, _mm_load_ss (src), _mm_load_ss (dst)));
+		++src;
+		++dst;
+		--nframes;
+	}
+}
@@ -18,12 +18,16 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <sstream>
+
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
 
 #include "pbd/properties.h"
 #include "pbd/stateful_diff_command.h"
 #include "ardour/automation_list.h"
+#include "ardour/evoral_types_convert.h"
+#include "ardour/types_convert.h"
 #include "automation_list_property_test.h"
 #include "test_util.h"
 
@@ -164,3 +168,73 @@ AutomationListPropertyTest::undoTest ()
 	write_automation_list_xml (&sheila->get_state(), test_data_filename);
 	check_xml (&sheila->get_state(), test_data_file4, ignore_properties);
 }
+
+/** @return number of events in a serialized AutomationList */
+static size_t
+n_events (XMLNode const& node)
+{
+	XMLNode const* events = node.child (X_("events"));
+	if (!events || events->children ().empty ()) {
+		return 0;
+	}
+	std::stringstream str (events->children ().front ()->content ());
+	size_t n = 0;
+	double when, value;
+	while (str >> when >> value) {
+		++n;
+	}
+	return n;
+}
+
+void
+AutomationListPropertyTest::cachedStateTest ()
+{
+	AutomationList list (Evoral::Parameter (GainAutomation));
+	XMLNode* node;
+
+	list.add (1, 0.5, false, false);
+
+	node = &list.get_cached_state ();
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1, n_events (*node));
+	delete node;
+
+	/* unchanged */
+	node = &list.get_cached_state ();
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1, n_events (*node));
+	delete node;
+
+	/* edits */
+	list.add (3, 1.0, false, false);
+	node = &list.get_cached_state ();
+	CPPUNIT_ASSERT_EQUAL ((size_t) 2, n_events (*node));
+	delete node;
+
+	/* appends that only extend the flat copy of the events */
+	list.fast_simple_add (5, 0.25);
+	node = &list.get_cached_state ();
+	CPPUNIT_ASSERT_EQUAL ((size_t) 3, n_events (*node));
+	delete node;
+
+	/* changes other than the events */
+	list.set_automation_state (Play);
+	node = &list.get_cached_state ();
+	AutoState state;
+	CPPUNIT_ASSERT (node->get_property ("state", state));
+	CPPUNIT_ASSERT_EQUAL (Play, state);
+	delete node;
+
+	list.set_interpolation (Evoral::ControlList::Discrete);
+	node = &list.get_cached_state ();
+	Evoral::ControlList::InterpolationStyle style;
+	CPPUNIT_ASSERT (node->get_property ("interpolation-style", style));
+	CPPUNIT_ASSERT_EQUAL (Evoral::ControlList::Discrete, style);
+	delete node;
+
+	/* a new ID */
+	list.reset_id ();
+	node = &list.get_cached_state ();
+	PBD::ID id;
+	CPPUNIT_ASSERT (node->get_property ("id", id));
+	CPPUNIT_ASSERT (id == list.id ());
+	delete node;
+}
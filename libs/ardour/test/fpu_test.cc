@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstring>
 #include "pbd/compose.h"
 #include "pbd/fpu.h"
 #include "pbd/malign.h"
@@ -36,8 +37,12 @@ FPUTest::tearDown ()
 	cache_aligned_free (_test2);
 }
 
+/** @param fma_tolerance error allowed for functions that use fused
+ *  multiply-add, which rounds differently than the default implementation.
+ *  All other functions must match exactly.
+ */
 void
-FPUTest::run (size_t align_max)
+FPUTest::run (size_t align_max, float fma_tolerance)
 {
 	apply_gain_to_buffer (_test1, _size, 1.33);
 	default_apply_gain_to_buffer (_comp1, _size, 1.33);
@@ -61,7 +66,12 @@ FPUTest::run (size_t align_max)
 			/* mix buffers w/gain */
 			mix_buffers_with_gain (&_test1[off], &_test2[off], cnt, 0.45);
 			default_mix_buffers_with_gain (&_comp1[off], &_comp2[off], cnt, 0.45);
-			compare (string_compose ("Mix Buffers w/gain not aligned off: %1 cnt: %2", off, cnt), cnt);
+			compare (string_compose ("Mix Buffers w/gain not aligned off: %1 cnt: %2", off, cnt), cnt, fma_tolerance);
+			if (fma_tolerance > 0) {
+				/* continue with identical data, so that the following
+				 * functions can be compared exactly */
+				memcpy (_test1, _comp1, sizeof (float) * _size);
+			}
 
 			/* mix buffers w/o gain */
 			mix_buffers_no_gain (&_test1[off], &_test2[off], cnt);
@@ -85,12 +95,15 @@ FPUTest::run (size_t align_max)
 	}
 }
 
+/** @param tolerance if > 0, the absolute plus relative error that is allowed
+ *  (a purely relative bound can not be met by values close to zero)
+ */
 void
-FPUTest::compare (std::string msg, size_t cnt)
+FPUTest::compare (std::string msg, size_t cnt, float tolerance)
 {
 	size_t err = 0;
 	for (size_t i = 0; i < cnt; ++i) {
-		if (_test1[i] != _comp1[i]) {
+		if (tolerance > 0 ? fabsf (_test1[i] - _comp1[i]) > tolerance * (1.f + fabsf (_comp1[i])) : _test1[i] != _comp1[i]) {
 			++err;
 		}
 	}
@@ -125,6 +138,64 @@ FPUTest::avxTest ()
 	run (align_max);
 }
 
+#ifdef FPU_AVX_FMA_SUPPORT
+void
+FPUTest::fmaTest ()
+{
+	PBD::FPU* fpu = PBD::FPU::instance ();
+	if (!fpu->has_fma ()) {
+		printf ("FMA is not available at run-time\n");
+		return;
+	}
+
+#if ( defined(__x86_64__) || defined(_M_X64) )
+	size_t align_max = 64;
+#else
+	size_t align_max = 16;
+#endif
+	CPPUNIT_ASSERT_MESSAGE ("Aligned Malloc", (((intptr_t)_test1) % align_max) == 0);
+	CPPUNIT_ASSERT_MESSAGE ("Aligned Malloc", (((intptr_t)_test2) % align_max) == 0);
+
+	compute_peak          = x86_sse_avx_compute_peak;
+	find_peaks            = x86_sse_avx_find_peaks;
+	apply_gain_to_buffer  = x86_sse_avx_apply_gain_to_buffer;
+	mix_buffers_with_gain = x86_fma_mix_buffers_with_gain;
+	mix_buffers_no_gain   = x86_sse_avx_mix_buffers_no_gain;
+	copy_vector           = x86_sse_avx_copy_vector;
+
+	run (align_max, 1e-6);
+}
+#endif
+
+#ifdef FPU_AVX512F_SUPPORT
+void
+FPUTest::avx512fTest ()
+{
+	PBD::FPU* fpu = PBD::FPU::instance ();
+	if (!fpu->has_avx512f ()) {
+		printf ("AVX512F is not available at run-time\n");
+		return;
+	}
+
+#if ( defined(__x86_64__) || defined(_M_X64) )
+	size_t align_max = 64;
+#else
+	size_t align_max = 16;
+#endif
+	CPPUNIT_ASSERT_MESSAGE ("Aligned Malloc", (((intptr_t)_test1) % align_max) == 0);
+	CPPUNIT_ASSERT_MESSAGE ("Aligned Malloc", (((intptr_t)_test2) % align_max) == 0);
+
+	compute_peak          = x86_avx512f_compute_peak;
+	find_peaks            = x86_avx512f_find_peaks;
+	apply_gain_to_buffer  = x86_avx512f_apply_gain_to_buffer;
+	mix_buffers_with_gain = x86_avx512f_mix_buffers_with_gain;
+	mix_buffers_no_gain   = x86_avx512f_mix_buffers_no_gain;
+	copy_vector           = x86_avx512f_copy_vector;
+
+	run (align_max, 1e-6);
+}
+#endif
+
 void
 FPUTest::sseTest ()
 {
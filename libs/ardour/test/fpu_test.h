@@ -9,6 +9,12 @@ class FPUTest : public CppUnit::TestFixture
 #if defined(ARCH_X86) && defined(BUILD_SSE_OPTIMIZATIONS)
 	CPPUNIT_TEST (sseTest);
 	CPPUNIT_TEST (avxTest);
+#ifdef FPU_AVX_FMA_SUPPORT
+	CPPUNIT_TEST (fmaTest);
+#endif
+#ifdef FPU_AVX512F_SUPPORT
+	CPPUNIT_TEST (avx512fTest);
+#endif
 #elif defined ARM_NEON_SUPPORT
 	CPPUNIT_TEST (neonTest);
 #elif defined(__APPLE__) && defined(BUILD_VECLIB_OPTIMIZATIONS)
@@ -25,6 +31,12 @@ public:
 #if defined(ARCH_X86) && defined(BUILD_SSE_OPTIMIZATIONS)
 	void avxTest ();
 	void sseTest ();
+#ifdef FPU_AVX_FMA_SUPPORT
+	void fmaTest ();
+#endif
+#ifdef FPU_AVX512F_SUPPORT
+	void avx512fTest ();
+#endif
 #elif defined ARM_NEON_SUPPORT
 	void neonTest ();
 #elif defined(__APPLE__) && defined(BUILD_VECLIB_OPTIMIZATIONS)
@@ -34,8 +46,8 @@ public:
 #endif
 
 private:
-	void run (size_t);
-	void compare (std::string, size_t);
+	void run (size_t, float fma_tolerance = 0);
+	void compare (std::string, size_t, float tolerance = 0);
 
 	ARDOUR::compute_peak_t          compute_peak;
 	ARDOUR::find_peaks_t            find_peaks;
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "evoral/midi_events.h"
+
+#include "ardour/midi_buffer.h"
+#include "midi_buffer_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MidiBufferTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+static void
+push (MidiBuffer& buf, MidiBuffer::TimeType time, uint8_t status, uint8_t data)
+{
+	uint8_t const msg[3] = { status, data, 64 };
+	CPPUNIT_ASSERT (buf.push_back (time, Evoral::MIDI_EVENT, 3, msg));
+}
+
+/** Fill @param buf with @param n random events at times @param parity, @param parity + 2, ...
+ * and add them to @param all
+ */
+static void
+fill_random (MidiBuffer& buf, int n, int parity, vector<pair<MidiBuffer::TimeType, uint8_t> >& all)
+{
+	vector<MidiBuffer::TimeType> times;
+	for (int i = 0; i < n; ++i) {
+		times.push_back ((rand () % 32) * 2 + parity);
+	}
+	sort (times.begin (), times.end ());
+
+	uint8_t const status[] = { MIDI_CMD_NOTE_ON, MIDI_CMD_NOTE_OFF, MIDI_CMD_CONTROL, MIDI_CMD_BENDER };
+
+	for (int i = 0; i < n; ++i) {
+		uint8_t const s = status[rand () % 4];
+		push (buf, times[i], s, i);
+		all.push_back (make_pair (times[i], s));
+	}
+}
+
+static bool
+earlier (pair<MidiBuffer::TimeType, uint8_t> const& a, pair<MidiBuffer::TimeType, uint8_t> const& b)
+{
+	return a.first < b.first;
+}
+
+void
+MidiBufferTest::mergeTest ()
+{
+	srand (42);
+
+	for (int iter = 0; iter < 200; ++iter) {
+		MidiBuffer ours (8192);
+		MidiBuffer theirs (8192);
+		vector<pair<MidiBuffer::TimeType, uint8_t> > all;
+
+		fill_random (ours, rand () % 100, 0, all);
+		fill_random (theirs, rand () % 100, 1, all);
+
+		/* events of either buffer never share a time with the other's,
+		 * so the result must be the stable sort of all events.
+		 */
+		stable_sort (all.begin (), all.end (), earlier);
+
+		CPPUNIT_ASSERT (ours.merge_in_place (theirs));
+
+		size_t n = 0;
+		for (MidiBuffer::iterator i = ours.begin (); i != ours.end (); ++i, ++n) {
+			CPPUNIT_ASSERT (n < all.size ());
+			CPPUNIT_ASSERT_EQUAL (all[n].first, (*i).time ());
+			CPPUNIT_ASSERT_EQUAL (all[n].second, (*i).buffer ()[0]);
+		}
+		CPPUNIT_ASSERT_EQUAL (all.size (), n);
+	}
+
+	/* simultaneous events: note-off before note-on, whichever buffer they are in */
+	for (int swap = 0; swap < 2; ++swap) {
+		MidiBuffer ours (1024);
+		MidiBuffer theirs (1024);
+		push (ours, 10, swap ? MIDI_CMD_NOTE_OFF : MIDI_CMD_NOTE_ON, 60);
+		push (theirs, 10, swap ? MIDI_CMD_NOTE_ON : MIDI_CMD_NOTE_OFF, 60);
+
+		CPPUNIT_ASSERT (ours.merge_in_place (theirs));
+
+		MidiBuffer::iterator i = ours.begin ();
+		CPPUNIT_ASSERT_EQUAL ((uint8_t) MIDI_CMD_NOTE_OFF, (*i).buffer ()[0]);
+		++i;
+		CPPUNIT_ASSERT_EQUAL ((uint8_t) MIDI_CMD_NOTE_ON, (*i).buffer ()[0]);
+	}
+
+	/* not enough room: nothing is merged */
+	MidiBuffer small (64);
+	MidiBuffer big (1024);
+	vector<pair<MidiBuffer::TimeType, uint8_t> > ignored;
+	push (small, 0, MIDI_CMD_CONTROL, 1);
+	fill_random (big, 10, 1, ignored);
+	size_t const size = small.size ();
+	CPPUNIT_ASSERT (!small.merge_in_place (big));
+	CPPUNIT_ASSERT_EQUAL (size, small.size ());
+}
+
+void
+MidiBufferTest::mergeRangeTest ()
+{
+	MidiBuffer ours (1024);
+	MidiBuffer theirs (1024);
+
+	for (int i = 0; i < 10; ++i) {
+		push (ours, i * 2, MIDI_CMD_CONTROL, 1);
+		push (theirs, i * 2 + 1, MIDI_CMD_CONTROL, 2);
+	}
+
+	/* merge the events of "theirs" at 5, 7 and 9 */
+	MidiBuffer const& cref (theirs);
+	MidiBuffer::const_iterator first = cref.begin ();
+	while ((*first).time () < 5) {
+		++first;
+	}
+	MidiBuffer::const_iterator last = first;
+	while ((*last).time () < 10) {
+		++last;
+	}
+
+	CPPUNIT_ASSERT (ours.merge_in_place (first, last));
+
+	MidiBuffer::TimeType const expected[] = { 0, 2, 4, 5, 6, 7, 8, 9, 10, 12, 14, 16, 18 };
+	size_t n = 0;
+
+	for (MidiBuffer::iterator i = ours.begin (); i != ours.end (); ++i, ++n) {
+		CPPUNIT_ASSERT (n < sizeof (expected) / sizeof (expected[0]));
+		CPPUNIT_ASSERT_EQUAL (expected[n], (*i).time ());
+	}
+	CPPUNIT_ASSERT_EQUAL (sizeof (expected) / sizeof (expected[0]), n);
+}
+
+void
+MidiBufferTest::eraseRangeTest ()
+{
+	MidiBuffer buf (1024);
+
+	for (int i = 0; i < 10; ++i) {
+		push (buf, i, MIDI_CMD_CONTROL, i);
+	}
+
+	MidiBuffer::iterator first = buf.begin ();
+	++first;
+	MidiBuffer::iterator last = first;
+	for (int i = 0; i < 5; ++i) {
+		++last;
+	}
+
+	/* removes the events at 1 .. 5 */
+	MidiBuffer::iterator next = buf.erase (first, last);
+	CPPUNIT_ASSERT_EQUAL ((MidiBuffer::TimeType) 6, (*next).time ());
+
+	MidiBuffer::TimeType const expected[] = { 0, 6, 7, 8, 9 };
+	size_t n = 0;
+
+	for (MidiBuffer::iterator i = buf.begin (); i != buf.end (); ++i, ++n) {
+		CPPUNIT_ASSERT_EQUAL (expected[n], (*i).time ());
+	}
+	CPPUNIT_ASSERT_EQUAL ((size_t) 5, n);
+
+	buf.erase (buf.begin (), buf.end ());
+	CPPUNIT_ASSERT (buf.empty ());
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <glibmm/miscutils.h>
+
+#include "evoral/Note.h"
+
+#include "ardour/midi_model.h"
+#include "ardour/midi_source.h"
+#include "ardour/rc_configuration.h"
+#include "ardour/session.h"
+#include "ardour/source_factory.h"
+
+#include "midi_model_test.h"
+#include "test_util.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MidiModelTest);
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+typedef Evoral::Note<Temporal::Beats> Note;
+typedef MidiModel::NoteDiffCommand NoteDiffCommand;
+
+void
+MidiModelTest::setUp ()
+{
+	TestNeedingSession::setUp ();
+
+	std::string const path = Glib::build_filename (new_test_output_dir (), "model.mid");
+	_source = boost::dynamic_pointer_cast<MidiSource> (
+		SourceFactory::createWritable (DataType::MIDI, *_session, path, _session->sample_rate ()));
+	CPPUNIT_ASSERT (_source);
+
+	{
+		Source::Lock lm (_source->mutex ());
+		_source->load_model (lm);
+	}
+
+	_model = _source->model ();
+	CPPUNIT_ASSERT (_model);
+
+	NoteDiffCommand* cmd = _model->new_note_diff_command ("add");
+	for (int i = 0; i < 8; ++i) {
+		cmd->add (MidiModel::NotePtr (new Note (0, Temporal::Beats (i, 0), Temporal::Beats (0, 480), 60 + i, 100)));
+	}
+	(*cmd) ();
+	delete cmd;
+}
+
+void
+MidiModelTest::tearDown ()
+{
+	Config->set_save_binary_midi_history (false);
+
+	_model.reset ();
+	_source.reset ();
+
+	TestNeedingSession::tearDown ();
+}
+
+void
+MidiModelTest::valueTest ()
+{
+	Temporal::Beats const times[] = {
+		Temporal::Beats (0, 0),
+		Temporal::Beats (2, 17),
+		Temporal::Beats (0, -5),
+		Temporal::Beats (-3, -1919),
+		Temporal::Beats (-1, 0)
+	};
+
+	for (size_t i = 0; i < sizeof (times) / sizeof (times[0]); ++i) {
+		NoteDiffCommand::Value const v (times[i]);
+		CPPUNIT_ASSERT_EQUAL (times[i].to_ticks (), v.packed ());
+		CPPUNIT_ASSERT (v.get_beats () == times[i]);
+		CPPUNIT_ASSERT (NoteDiffCommand::Value::from_packed (v.packed ()).get_beats () == times[i]);
+	}
+
+	CPPUNIT_ASSERT_EQUAL ((int32_t) -7, NoteDiffCommand::Value (-7).get_int ());
+}
+
+/** Save a command in the binary form, load it, and check that it matches
+ *  the original, both directly and in the XML form.
+ */
+void
+MidiModelTest::binaryRoundTripTest ()
+{
+	MidiModel::NotePtr notes[8];
+	{
+		MidiModel::ReadLock lock (_model->read_lock ());
+		int n = 0;
+		for (MidiModel::Notes::const_iterator i = _model->notes ().begin (); i != _model->notes ().end (); ++i) {
+			notes[n++] = *i;
+		}
+		CPPUNIT_ASSERT_EQUAL (8, n);
+	}
+
+	NoteDiffCommand* cmd = _model->new_note_diff_command ("edit");
+	cmd->change (notes[0], NoteDiffCommand::StartTime, Temporal::Beats (0, 17));
+	cmd->change (notes[1], NoteDiffCommand::Length, Temporal::Beats (1, 1919));
+	cmd->change (notes[2], NoteDiffCommand::NoteNumber, (uint8_t) 0);
+	cmd->change (notes[3], NoteDiffCommand::Velocity, (uint8_t) 127);
+	cmd->change (notes[4], NoteDiffCommand::Channel, (uint8_t) 15);
+	cmd->add (MidiModel::NotePtr (new Note (9, Temporal::Beats (8, 3), Temporal::Beats (0, 1), 127, 1)));
+	cmd->remove (notes[5]);
+	cmd->side_effect_remove (notes[6]);
+
+	Config->set_save_binary_midi_history (false);
+	XMLNode& xml (cmd->get_state ());
+
+	Config->set_save_binary_midi_history (true);
+	XMLNode& binary (cmd->get_state ());
+
+	char const * children[] = { "ChangedNotes", "AddedNotes", "RemovedNotes", "SideEffectRemovals" };
+	for (size_t i = 0; i < sizeof (children) / sizeof (children[0]); ++i) {
+		XMLNode const* child = binary.child (children[i]);
+		CPPUNIT_ASSERT (child);
+		std::string encoding;
+		CPPUNIT_ASSERT (child->get_property ("encoding", encoding));
+		CPPUNIT_ASSERT_EQUAL (std::string ("binary"), encoding);
+	}
+
+	NoteDiffCommand loaded (_model, binary);
+
+	CPPUNIT_ASSERT_EQUAL (cmd->changes ().size (), loaded.changes ().size ());
+	for (size_t i = 0; i < cmd->changes ().size (); ++i) {
+		NoteDiffCommand::NoteChange const & a (cmd->changes ()[i]);
+		NoteDiffCommand::NoteChange const & b (loaded.changes ()[i]);
+		CPPUNIT_ASSERT_EQUAL (a.property, b.property);
+		CPPUNIT_ASSERT (a.note == b.note);
+		CPPUNIT_ASSERT (a.old_value == b.old_value);
+		CPPUNIT_ASSERT (a.new_value == b.new_value);
+	}
+
+	CPPUNIT_ASSERT (loaded.changes ()[0].new_value.get_beats () == Temporal::Beats (0, 17));
+	CPPUNIT_ASSERT (loaded.changes ()[1].new_value.get_beats () == Temporal::Beats (1, 1919));
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1, loaded.added_notes ().size ());
+	MidiModel::NotePtr added = loaded.added_notes ().front ();
+	MidiModel::NotePtr original = cmd->added_notes ().front ();
+	CPPUNIT_ASSERT_EQUAL (original->id (), added->id ());
+	CPPUNIT_ASSERT (*original == *added);
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1, loaded.removed_notes ().size ());
+	CPPUNIT_ASSERT_EQUAL (notes[5]->id (), loaded.removed_notes ().front ()->id ());
+	CPPUNIT_ASSERT (*notes[5] == *loaded.removed_notes ().front ());
+
+	/* side effect removals are only visible through the state */
+	Config->set_save_binary_midi_history (false);
+	XMLNode& reloaded (loaded.get_state ());
+	CPPUNIT_ASSERT (xml == reloaded);
+
+	delete &xml;
+	delete &binary;
+	delete &reloaded;
+	delete cmd;
+}
+
+/** Load binary data that is out of range */
+void
+MidiModelTest::binaryRangeTest ()
+{
+	XMLNode node ("NoteDiffCommand");
+
+	/* a change of property 9 to note 1, then a note with id 1, note 200,
+	 * channel 20, velocity 300, time -960 ticks and length 960 ticks.
+	 */
+	XMLNode* changes = node.add_child ("ChangedNotes");
+	changes->set_property ("encoding", "binary");
+	changes->add_content ("AhIAAA==");
+
+	XMLNode* added = node.add_child ("AddedNotes");
+	added->set_property ("encoding", "binary");
+	added->add_content ("ApADKNgE/w6ADw==");
+
+	NoteDiffCommand loaded (_model, node);
+
+	CPPUNIT_ASSERT (loaded.changes ().empty ());
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1, loaded.added_notes ().size ());
+	MidiModel::NotePtr note = loaded.added_notes ().front ();
+	CPPUNIT_ASSERT_EQUAL ((Evoral::event_id_t) 1, note->id ());
+	CPPUNIT_ASSERT_EQUAL ((uint8_t) 127, note->note ());
+	CPPUNIT_ASSERT_EQUAL ((uint8_t) 0, note->channel ());
+	CPPUNIT_ASSERT_EQUAL ((uint8_t) 127, note->velocity ());
+	CPPUNIT_ASSERT (note->time () == Temporal::Beats (0, -960));
+	CPPUNIT_ASSERT (note->length () == Temporal::Beats (0, 960));
+}
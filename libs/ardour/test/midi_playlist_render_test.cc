@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cstring>
+
+#include <glibmm/miscutils.h>
+
+#include "evoral/EventList.h"
+#include "evoral/Note.h"
+
+#include "ardour/midi_buffer.h"
+#include "ardour/midi_model.h"
+#include "ardour/midi_playlist.h"
+#include "ardour/midi_source.h"
+#include "ardour/midi_state_tracker.h"
+#include "ardour/playlist_factory.h"
+#include "ardour/region_factory.h"
+#include "ardour/rt_midibuffer.h"
+#include "ardour/session.h"
+#include "ardour/source_factory.h"
+#include "ardour/tempo.h"
+
+#include "midi_playlist_render_test.h"
+#include "test_util.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (MidiPlaylistRenderTest);
+
+using namespace std;
+using namespace PBD;
+using namespace ARDOUR;
+
+typedef Evoral::Note<Temporal::Beats> Note;
+
+/** Check that @param a and @param b hold the same events before @param end */
+static void
+check_equal (RTMidiBuffer& a, RTMidiBuffer& b, samplepos_t end)
+{
+	CPPUNIT_ASSERT_EQUAL (a.size (), b.size ());
+
+	MidiBuffer ma (8192);
+	MidiBuffer mb (8192);
+	MidiStateTracker ta;
+	MidiStateTracker tb;
+
+	a.read (ma, 0, end, ta);
+	b.read (mb, 0, end, tb);
+
+	MidiBuffer::iterator i = ma.begin ();
+	MidiBuffer::iterator j = mb.begin ();
+
+	for (; i != ma.end () && j != mb.end (); ++i, ++j) {
+		CPPUNIT_ASSERT_EQUAL ((*i).time (), (*j).time ());
+		CPPUNIT_ASSERT_EQUAL ((*i).size (), (*j).size ());
+		CPPUNIT_ASSERT (memcmp ((*i).buffer (), (*j).buffer (), (*i).size ()) == 0);
+	}
+
+	CPPUNIT_ASSERT (i == ma.end ());
+	CPPUNIT_ASSERT (j == mb.end ());
+}
+
+/** Edit the notes in one span of a rendered playlist, and check that
+ *  re-rendering just that span gives the same result as rendering a fresh
+ *  playlist.
+ */
+void
+MidiPlaylistRenderTest::incrementalTest ()
+{
+	std::string const path = Glib::build_filename (new_test_output_dir (), "incremental.mid");
+	boost::shared_ptr<MidiSource> src = boost::dynamic_pointer_cast<MidiSource> (
+		SourceFactory::createWritable (DataType::MIDI, *_session, path, _session->sample_rate ()));
+	CPPUNIT_ASSERT (src);
+
+	{
+		Source::Lock lm (src->mutex ());
+		src->load_model (lm);
+	}
+
+	boost::shared_ptr<MidiModel> model = src->model ();
+	CPPUNIT_ASSERT (model);
+
+	/* a note every half beat, a long note that is still sounding during
+	 * the edit below, and one that is cut off by the region end.
+	 */
+	MidiModel::NoteDiffCommand* cmd = model->new_note_diff_command ("add");
+	for (int i = 0; i < 16; ++i) {
+		cmd->add (MidiModel::NotePtr (new Note (0, Temporal::Beats (i * 0.5), Temporal::Beats (0.25), 60 + i, 100)));
+	}
+	cmd->add (MidiModel::NotePtr (new Note (1, Temporal::Beats (1.0), Temporal::Beats (4.0), 40, 100)));
+	cmd->add (MidiModel::NotePtr (new Note (1, Temporal::Beats (7.0), Temporal::Beats (4.0), 41, 100)));
+	(*cmd) ();
+	delete cmd;
+
+	samplecnt_t const length = _session->tempo_map ().sample_at_quarter_note (8.0);
+
+	PropertyList plist;
+	plist.add (Properties::start, 0);
+	plist.add (Properties::length, length);
+	boost::shared_ptr<Region> region = RegionFactory::create (src, plist);
+
+	boost::shared_ptr<MidiPlaylist> incremental = boost::dynamic_pointer_cast<MidiPlaylist> (
+		PlaylistFactory::create (DataType::MIDI, *_session, "incremental"));
+	incremental->add_region (region, 0);
+	incremental->render (0);
+
+	/* move the note at beat 4 and change the velocity of the one after it */
+	MidiModel::NotePtr moved;
+	MidiModel::NotePtr changed;
+	{
+		MidiModel::ReadLock lock (model->read_lock ());
+		for (MidiModel::Notes::const_iterator n = model->notes ().begin (); n != model->notes ().end (); ++n) {
+			if ((*n)->note () == 68) {
+				moved = *n;
+			} else if ((*n)->note () == 69) {
+				changed = *n;
+			}
+		}
+	}
+	CPPUNIT_ASSERT (moved);
+	CPPUNIT_ASSERT (changed);
+
+	cmd = model->new_note_diff_command ("edit");
+	cmd->change (moved, MidiModel::NoteDiffCommand::StartTime, Temporal::Beats (4.25));
+	cmd->change (changed, MidiModel::NoteDiffCommand::Velocity, (uint8_t) 50);
+	(*cmd) ();
+	delete cmd;
+
+	incremental->render (0);
+
+	boost::shared_ptr<MidiPlaylist> fresh = boost::dynamic_pointer_cast<MidiPlaylist> (
+		PlaylistFactory::create (DataType::MIDI, *_session, "fresh"));
+	fresh->add_region (RegionFactory::create (region, false, false), 0);
+	fresh->render (0);
+
+	/* on and off for every note, the last one resolved at the region end */
+	CPPUNIT_ASSERT_EQUAL ((size_t) 36, fresh->rendered ()->size ());
+
+	check_equal (*incremental->rendered (), *fresh->rendered (), length + 2);
+}
+
+/** Replace a span holding a sysex many times, and check that the blobs of
+ *  the replaced events are reclaimed.
+ */
+void
+MidiPlaylistRenderTest::replaceTest ()
+{
+	RTMidiBuffer rtb;
+
+	uint8_t const on[3] = { 0x90, 60, 100 };
+	uint8_t sysex[6] = { 0xf0, 0x7e, 0x7f, 0x06, 0x01, 0xf7 };
+
+	rtb.write (0, Evoral::MIDI_EVENT, sizeof (on), on);
+	rtb.write (10, Evoral::MIDI_EVENT, sizeof (sysex), sysex);
+	rtb.write (20, Evoral::MIDI_EVENT, sizeof (on), on);
+
+	for (int i = 0; i < 1000; ++i) {
+		sysex[4] = i % 128;
+
+		Evoral::EventList<samplepos_t> events;
+		events.write (10, Evoral::MIDI_EVENT, sizeof (sysex), sysex);
+
+		{
+			RTMidiBuffer::WriteProtectRender wpr (rtb);
+			wpr.acquire ();
+			rtb.replace (5, 15, events);
+		}
+
+		delete events.front ();
+	}
+
+	CPPUNIT_ASSERT_EQUAL ((size_t) 3, rtb.size ());
+
+	/* no more than the live blob and one replaced one */
+	CPPUNIT_ASSERT (rtb._pool_size <= 2 * RTMidiBuffer::blob_space (sizeof (sysex)));
+
+	MidiBuffer mb (1024);
+	MidiStateTracker tracker;
+	rtb.read (mb, 0, 30, tracker);
+
+	MidiBuffer::iterator i = mb.begin ();
+	CPPUNIT_ASSERT (i != mb.end ());
+	++i;
+	CPPUNIT_ASSERT (i != mb.end ());
+	CPPUNIT_ASSERT_EQUAL ((samplepos_t) 10, (samplepos_t) (*i).time ());
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) sizeof (sysex), (*i).size ());
+	CPPUNIT_ASSERT (memcmp ((*i).buffer (), sysex, sizeof (sysex)) == 0);
+}
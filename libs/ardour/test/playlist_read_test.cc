@@ -288,3 +288,36 @@ PlaylistReadTest::enclosedTransparentReadTest ()
 
 	}
 }
+
+/* Check that reads follow changes made to the playlist after it has
+ * already been read from; _ar[1] covers most of _ar[0] and is on top.
+ */
+void
+PlaylistReadTest::changedReadTest ()
+{
+	_audio_playlist->add_region (_ar[0], 0);
+	_ar[0]->set_default_fade_in ();
+	_ar[0]->set_default_fade_out ();
+	_ar[0]->set_length (1024, 0);
+
+	_audio_playlist->add_region (_ar[1], 100);
+	_ar[1]->set_default_fade_in ();
+	_ar[1]->set_default_fade_out ();
+	_ar[1]->set_length (1024, 0);
+
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 300, 64, 0);
+	check_staircase (_buf, 200, 64);
+
+	_ar[1]->set_muted (true);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 300, 64, 0);
+	check_staircase (_buf, 300, 64);
+
+	_ar[1]->set_muted (false);
+	_ar[1]->set_position (50);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 300, 64, 0);
+	check_staircase (_buf, 250, 64);
+
+	_audio_playlist->remove_region (_ar[1]);
+	_audio_playlist->read (_buf, _mbuf, _gbuf, 300, 64, 0);
+	check_staircase (_buf, 300, 64);
+}
@@ -27,6 +27,7 @@ class PlaylistReadTest : public AudioRegionTest
 	CPPUNIT_TEST (transparentReadTest);
 	CPPUNIT_TEST (enclosedTransparentReadTest);
 	CPPUNIT_TEST (miscReadTest);
+	CPPUNIT_TEST (changedReadTest);
 	CPPUNIT_TEST_SUITE_END ();
 
 public:
@@ -38,6 +39,7 @@ public:
 	void transparentReadTest ();
 	void enclosedTransparentReadTest ();
 	void miscReadTest ();
+	void changedReadTest ();
 
 private:
 	int _N;
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <set>
+
+#include "ardour/playlist.h"
+#include "ardour/region.h"
+#include "playlist_region_index_test.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (PlaylistRegionIndexTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+/** Compare the indexed lookups of the playlist with a linear scan of all regions */
+void
+PlaylistRegionIndexTest::check (samplepos_t start, samplepos_t end)
+{
+	RegionList const& all (_playlist->region_list_property ().rlist ());
+
+	set<boost::shared_ptr<Region> > expected_touched;
+	set<boost::shared_ptr<Region> > expected_at;
+	boost::shared_ptr<Region> expected_top;
+
+	for (RegionList::const_iterator i = all.begin (); i != all.end (); ++i) {
+		if ((*i)->coverage (start, end) != Evoral::OverlapNone) {
+			expected_touched.insert (*i);
+		}
+		if ((*i)->covers (start)) {
+			expected_at.insert (*i);
+			if (!expected_top || (*i)->layer () > expected_top->layer ()) {
+				expected_top = *i;
+			}
+		}
+	}
+
+	boost::shared_ptr<RegionList> touched = _playlist->regions_touched (start, end);
+	CPPUNIT_ASSERT_EQUAL (expected_touched.size (), touched->size ());
+	CPPUNIT_ASSERT (expected_touched == set<boost::shared_ptr<Region> > (touched->begin (), touched->end ()));
+
+	boost::shared_ptr<RegionList> at = _playlist->regions_at (start);
+	CPPUNIT_ASSERT_EQUAL (expected_at.size (), at->size ());
+	CPPUNIT_ASSERT (expected_at == set<boost::shared_ptr<Region> > (at->begin (), at->end ()));
+	CPPUNIT_ASSERT_EQUAL ((uint32_t) expected_at.size (), _playlist->count_regions_at (start));
+
+	CPPUNIT_ASSERT (expected_top == _playlist->top_region_at (start));
+}
+
+void
+PlaylistRegionIndexTest::check_all ()
+{
+	for (samplepos_t p = 0; p < 2000; p += 7) {
+		check (p, p);
+		check (p, p + 150);
+	}
+}
+
+void
+PlaylistRegionIndexTest::lookupTest ()
+{
+	/* an empty playlist */
+	check (0, 1000);
+
+	/* a mix of disjoint, overlapping and enclosed regions */
+	for (int i = 0; i < 16; ++i) {
+		_playlist->add_region (_r[i], (i * 397) % 1600);
+	}
+
+	check_all ();
+}
+
+void
+PlaylistRegionIndexTest::editTest ()
+{
+	for (int i = 0; i < 16; ++i) {
+		_playlist->add_region (_r[i], i * 50);
+	}
+
+	check_all ();
+
+	/* moves must invalidate the index */
+	_r[3]->set_position (1500);
+	_r[9]->set_position (0);
+	check_all ();
+
+	/* as must trims */
+	_r[5]->set_length (400, 0);
+	_r[12]->trim_front (640);
+	check_all ();
+
+	/* also while property changes are suspended, e.g. during a trim drag */
+	_r[6]->suspend_property_changes ();
+	_r[6]->trim_end (1800);
+	check_all ();
+	_r[6]->set_position (20);
+	check_all ();
+	_r[6]->resume_property_changes ();
+	check_all ();
+
+	/* and layering changes */
+	_r[0]->raise_to_top ();
+	check_all ();
+
+	_playlist->remove_region (_r[7]);
+	_playlist->remove_region (_r[9]);
+	check_all ();
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glib.h>
+
+#include "evoral/midi_events.h"
+
+#include "ardour/midi_buffer.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/* Compare merging a dense controller stream into a busy MIDI buffer event
+ * by event (insert_event) and in one pass (merge_in_place), for a range of
+ * process cycle sizes.
+ *
+ * usage: midi_buffer [cycles]
+ */
+
+/** fill @param buf with a controller message every @param step samples, starting at @param first */
+static void
+fill (MidiBuffer& buf, uint32_t nframes, uint32_t first, uint32_t step, uint8_t cc)
+{
+	buf.silence (nframes);
+	for (uint32_t t = first; t < nframes; t += step) {
+		uint8_t const msg[3] = { MIDI_CMD_CONTROL, cc, (uint8_t) (t & 0x7f) };
+		buf.push_back (t, Evoral::MIDI_EVENT, 3, msg);
+	}
+}
+
+/** @return time per cycle in usec */
+static double
+bench (bool merge, uint32_t nframes, int cycles)
+{
+	/* two interleaved streams, each with an event every other sample */
+	MidiBuffer ours (nframes * 64);
+	MidiBuffer theirs (nframes * 64);
+
+	fill (theirs, nframes, 1, 2, 2);
+
+	gint64 elapsed = 0;
+
+	for (int i = 0; i < cycles; ++i) {
+		fill (ours, nframes, 0, 2, 1);
+
+		gint64 const start = g_get_monotonic_time ();
+
+		if (merge) {
+			ours.merge_in_place (theirs);
+		} else {
+			for (MidiBuffer::iterator e = theirs.begin (); e != theirs.end (); ++e) {
+				ours.insert_event (*e);
+			}
+		}
+
+		elapsed += g_get_monotonic_time () - start;
+	}
+
+	return (double) elapsed / cycles;
+}
+
+int
+main (int argc, char* argv[])
+{
+	int const cycles = argc > 1 ? atoi (argv[1]) : 1000;
+
+	uint32_t const periods[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+	printf ("%8s %8s %14s %14s    (usec per cycle)\n", "period", "events", "insert_event", "merge_in_place");
+
+	for (size_t p = 0; p < sizeof (periods) / sizeof (periods[0]); ++p) {
+		/* keep the total amount of work roughly constant for the slow variant */
+		int const n = max (10, (int) (cycles * 32LL * 32LL / ((int64_t) periods[p] * periods[p])));
+
+		double const inserted = bench (false, periods[p], n);
+		double const merged = bench (true, periods[p], n);
+
+		printf ("%8u %8u %14.2f %14.2f\n", periods[p], periods[p] / 2, inserted, merged);
+	}
+
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "pbd/fpu.h"
+#include "pbd/malign.h"
+
+#include "ardour/mix.h"
+
+using namespace std;
+using namespace ARDOUR;
+
+/* Compare the mix function variants that the CPU supports, for a range of
+ * buffer sizes and buffer alignments.
+ *
+ * usage: mix_functions [iterations]
+ */
+
+struct Variant {
+	Variant (string const& n,
+	         compute_peak_t cp, find_peaks_t fp, apply_gain_to_buffer_t ag,
+	         mix_buffers_with_gain_t mg, mix_buffers_no_gain_t mn, copy_vector_t cv)
+		: name (n), compute_peak (cp), find_peaks (fp), apply_gain_to_buffer (ag)
+		, mix_buffers_with_gain (mg), mix_buffers_no_gain (mn), copy_vector (cv)
+	{}
+
+	string                  name;
+	compute_peak_t          compute_peak;
+	find_peaks_t            find_peaks;
+	apply_gain_to_buffer_t  apply_gain_to_buffer;
+	mix_buffers_with_gain_t mix_buffers_with_gain;
+	mix_buffers_no_gain_t   mix_buffers_no_gain;
+	copy_vector_t           copy_vector;
+};
+
+static float* src;
+static float* dst;
+static float  sink;
+
+/** @return time per call in ns */
+static double
+bench (Variant const& v, int fn, uint32_t nframes, uint32_t offset, int iterations)
+{
+	float* s = src + offset;
+	float* d = dst + offset;
+	float  mn = 0;
+	float  mx = 0;
+
+	gint64 const start = g_get_monotonic_time ();
+
+	for (int i = 0; i < iterations; ++i) {
+		switch (fn) {
+		case 0:
+			sink += v.compute_peak (s, nframes, 0);
+			break;
+		case 1:
+			v.find_peaks (s, nframes, &mn, &mx);
+			break;
+		case 2:
+			/* alternate so that the values neither grow nor vanish */
+			v.apply_gain_to_buffer (d, nframes, (i & 1) ? 2.f : .5f);
+			break;
+		case 3:
+			v.mix_buffers_with_gain (d, s, nframes, (i & 1) ? 1.f : -1.f);
+			break;
+		case 4:
+			v.mix_buffers_no_gain (d, s, nframes);
+			break;
+		case 5:
+			v.copy_vector (d, s, nframes);
+			break;
+		}
+	}
+
+	sink += mn + mx;
+
+	return (g_get_monotonic_time () - start) * 1000.0 / iterations;
+}
+
+int
+main (int argc, char* argv[])
+{
+	int const iterations = argc > 1 ? atoi (argv[1]) : 100000;
+
+	char const* const fn_names[] = {
+		"compute_peak", "find_peaks", "apply_gain_to_buffer",
+		"mix_buffers_with_gain", "mix_buffers_no_gain", "copy_vector"
+	};
+
+	uint32_t const sizes[]   = { 16, 64, 256, 1024, 4096, 8192 };
+	uint32_t const offsets[] = { 0, 1, 4, 8 };
+
+	vector<Variant> variants;
+
+	variants.push_back (Variant ("default",
+	                             default_compute_peak, default_find_peaks, default_apply_gain_to_buffer,
+	                             default_mix_buffers_with_gain, default_mix_buffers_no_gain, default_copy_vector));
+
+#if defined(ARCH_X86) && defined(BUILD_SSE_OPTIMIZATIONS)
+	PBD::FPU* fpu = PBD::FPU::instance ();
+
+	if (fpu->has_sse ()) {
+		variants.push_back (Variant ("sse",
+		                             x86_sse_compute_peak, x86_sse_find_peaks, x86_sse_apply_gain_to_buffer,
+		                             x86_sse_mix_buffers_with_gain, x86_sse_mix_buffers_no_gain, default_copy_vector));
+	}
+	if (fpu->has_avx ()) {
+		variants.push_back (Variant ("avx",
+		                             x86_sse_avx_compute_peak, x86_sse_avx_find_peaks, x86_sse_avx_apply_gain_to_buffer,
+		                             x86_sse_avx_mix_buffers_with_gain, x86_sse_avx_mix_buffers_no_gain, x86_sse_avx_copy_vector));
+	}
+#ifdef FPU_AVX_FMA_SUPPORT
+	if (fpu->has_fma ()) {
+		variants.push_back (Variant ("avx+fma",
+		                             x86_sse_avx_compute_peak, x86_sse_avx_find_peaks, x86_sse_avx_apply_gain_to_buffer,
+		                             x86_fma_mix_buffers_with_gain, x86_sse_avx_mix_buffers_no_gain, x86_sse_avx_copy_vector));
+	}
+#endif
+#ifdef FPU_AVX512F_SUPPORT
+	if (fpu->has_avx512f ()) {
+		variants.push_back (Variant ("avx512f",
+		                             x86_avx512f_compute_peak, x86_avx512f_find_peaks, x86_avx512f_apply_gain_to_buffer,
+		                             x86_avx512f_mix_buffers_with_gain, x86_avx512f_mix_buffers_no_gain, x86_avx512f_copy_vector));
+	}
+#endif
+#endif
+
+	uint32_t const max_size = 8192 + 16;
+	cache_aligned_malloc ((void**) &src, max_size * sizeof (float));
+	cache_aligned_malloc ((void**) &dst, max_size * sizeof (float));
+
+	for (uint32_t i = 0; i < max_size; ++i) {
+		src[i] = dst[i] = (float) rand () / RAND_MAX - .5f;
+	}
+
+	printf ("%-22s %6s %6s", "function", "size", "offset");
+	for (vector<Variant>::const_iterator v = variants.begin (); v != variants.end (); ++v) {
+		printf (" %10s", v->name.c_str ());
+	}
+	printf ("    (ns per call)\n");
+
+	for (int fn = 0; fn < 6; ++fn) {
+		for (size_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s) {
+			for (size_t o = 0; o < sizeof (offsets) / sizeof (offsets[0]); ++o) {
+				/* keep the total amount of work roughly constant */
+				int const n = max (1, (int) (iterations * 64LL / sizes[s]));
+				printf ("%-22s %6u %6u", fn_names[fn], sizes[s], offsets[o]);
+				for (vector<Variant>::const_iterator v = variants.begin (); v != variants.end (); ++v) {
+					bench (*v, fn, sizes[s], offsets[o], n / 10 + 1); // warm up
+					printf (" %10.1f", bench (*v, fn, sizes[s], offsets[o], n));
+				}
+				printf ("\n");
+			}
+		}
+	}
+
+	cache_aligned_free (src);
+	cache_aligned_free (dst);
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cstring>
+#include <sndfile.h>
+
+#include <glibmm/miscutils.h>
+
+#include "pbd/compose.h"
+#include "ardour/rc_configuration.h"
+#include "ardour/sndfilesource.h"
+#include "sndfile_source_test.h"
+#include "test_util.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION (SndFileSourceTest);
+
+using namespace std;
+using namespace ARDOUR;
+
+/** Write a file in the given format and check that reading it via the memory
+ *  map gives the same result as reading it via libsndfile.
+ */
+void
+SndFileSourceTest::check_format (int format, int channels)
+{
+	int const N = 4096;
+
+	string const path = Glib::build_filename (new_test_output_dir (), string_compose ("mapped_%1_%2.wav", format, channels));
+
+	SF_INFO info;
+	memset (&info, 0, sizeof (info));
+	info.samplerate = 48000;
+	info.channels = channels;
+	info.format = SF_FORMAT_WAV | format;
+
+	SNDFILE* sf = sf_open (path.c_str (), SFM_WRITE, &info);
+	CPPUNIT_ASSERT (sf);
+
+	float* data = new float[N * channels];
+	for (int i = 0; i < N * channels; ++i) {
+		/* something that covers the whole range, and differs between channels */
+		data[i] = ((i * 7919) % 2001 - 1000) / 1000.5f;
+	}
+	CPPUNIT_ASSERT_EQUAL ((sf_count_t) N, sf_writef_float (sf, data, N));
+	sf_close (sf);
+	delete[] data;
+
+	Sample mapped[N + 64];
+	Sample unmapped[N + 64];
+
+	for (int c = 0; c < channels; ++c) {
+		Config->set_mmap_audio_files (true);
+		SndFileSource a (*_session, path, c, Source::Flag (0));
+
+		Config->set_mmap_audio_files (false);
+		SndFileSource b (*_session, path, c, Source::Flag (0));
+
+		/* whole file, some odd chunk in the middle, and reading past the end */
+		CPPUNIT_ASSERT_EQUAL ((samplecnt_t) N, a.read (mapped, 0, N));
+		CPPUNIT_ASSERT_EQUAL ((samplecnt_t) N, b.read (unmapped, 0, N));
+#ifndef PLATFORM_WINDOWS
+		/* make sure we really compare the map against libsndfile */
+		CPPUNIT_ASSERT (a.mapped ());
+#endif
+		CPPUNIT_ASSERT (!b.mapped ());
+		for (int i = 0; i < N; ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (unmapped[i], mapped[i], 1e-7);
+		}
+
+		a.read (mapped, 1001, 333);
+		b.read (unmapped, 1001, 333);
+		for (int i = 0; i < 333; ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (unmapped[i], mapped[i], 1e-7);
+		}
+
+		a.read (mapped, N - 32, 64);
+		b.read (unmapped, N - 32, 64);
+		for (int i = 0; i < 64; ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL (unmapped[i], mapped[i], 1e-7);
+		}
+	}
+
+	Config->set_mmap_audio_files (true);
+}
+
+void
+SndFileSourceTest::mappedReadTest ()
+{
+	int const formats[] = { SF_FORMAT_PCM_16, SF_FORMAT_PCM_24, SF_FORMAT_PCM_32, SF_FORMAT_FLOAT };
+
+	for (size_t f = 0; f < sizeof (formats) / sizeof (formats[0]); ++f) {
+		check_format (formats[f], 1);
+		check_format (formats[f], 2);
+	}
+}
@@ -499,6 +499,24 @@ Track::do_refill ()
 	return _disk_reader->do_refill ();
 }
 
+int
+Track::do_refill (Sample* sum_buffer, Sample* mixdown_buffer, gain_t* gain_buffer)
+{
+	return _disk_reader->do_refill (sum_buffer, mixdown_buffer, gain_buffer);
+}
+
+void
+Track::prefetch ()
+{
+	_disk_reader->prefetch ();
+}
+
+void
+Track::prefetch_seek (samplepos_t p)
+{
+	_disk_reader->prefetch_seek (p);
+}
+
 int
 Track::do_flush (RunContext c, bool force)
 {
@@ -1,5 +1,6 @@
 #include <sys/time.h>
-#include "canvas/group.h"
+#include <limits>
+#include "canvas/lookup_table.h"
 #include "canvas/canvas.h"
 #include "canvas/root_group.h"
 #include "canvas/rectangle.h"
@@ -8,10 +9,13 @@
 using namespace std;
 using namespace ArdourCanvas;
 
+/** @param min_items minimum number of children for a SpatialLookupTable
+ *  @param moves number of rectangles to move between lookups
+ */
 static void
-test (int items_per_cell)
+test (size_t min_items, int moves)
 {
-	Group::default_items_per_cell = items_per_cell;
+	SpatialLookupTable::min_items = min_items;
 
 	int const n_rectangles = 10000;
 	int const n_tests = 1000;
@@ -20,7 +24,7 @@ test (int items_per_cell)
 
 	ImageCanvas canvas;
 
-	list<Item*> rectangles;
+	vector<Item*> rectangles;
 
 	for (int i = 0; i < n_rectangles; ++i) {
 		rectangles.push_back (new Rectangle (canvas.root(), rect_random (rough_size)));
@@ -29,6 +33,12 @@ test (int items_per_cell)
 	for (int i = 0; i < n_tests; ++i) {
 		Duple test (double_random() * rough_size, double_random() * rough_size);
 
+		/* like dragging items around */
+		for (int m = 0; m < moves; ++m) {
+			Item* r = rectangles[rand () % n_rectangles];
+			r->set_position (Duple (double_random() * rough_size / 2, double_random() * rough_size / 2));
+		}
+
 		/* ask the group what's at this point */
 		vector<Item const *> items;
 		canvas.root()->add_items_at_point (test, items);
@@ -37,14 +47,16 @@ test (int items_per_cell)
 
 int main ()
 {
-	int tests[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+	size_t const dumb = numeric_limits<size_t>::max ();
+	size_t tests[] = { dumb, 0, dumb, 0 };
+	int moves[] = { 0, 0, 10, 10 };
 
-	for (unsigned int i = 0; i < sizeof (tests) / sizeof (int); ++i) {
+	for (unsigned int i = 0; i < sizeof (tests) / sizeof (size_t); ++i) {
 		timeval start;
 		timeval stop;
 
 		gettimeofday (&start, 0);
-		test (tests[i]);
+		test (tests[i], moves[i]);
 		gettimeofday (&stop, 0);
 
 		int sec = stop.tv_sec - start.tv_sec;
@@ -56,7 +68,7 @@ int main ()
 
 		double seconds = sec + ((double) usec / 1e6);
 
-		cout << "Test " << tests[i] << ": " << seconds << "\n";
+		cout << "Test " << (tests[i] == dumb ? "dumb" : "spatial") << " moves " << moves[i] << ": " << seconds << "\n";
 	}
 }
 
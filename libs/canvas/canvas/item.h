@@ -309,6 +309,8 @@ protected:
 	/* nesting ("grouping") API */
 
 	void invalidate_lut () const;
+	/** update our ancestors' lookup tables after our bounding box may have changed */
+	void lut_changed () const;
 	void clear_items (bool with_delete);
 
 	void ensure_lut () const;
@@ -20,6 +20,7 @@
 #ifndef __CANVAS_LOOKUP_TABLE_H__
 #define __CANVAS_LOOKUP_TABLE_H__
 
+#include <map>
 #include <vector>
 #include <boost/multi_array.hpp>
 
@@ -27,6 +28,7 @@
 #include "canvas/types.h"
 
 class OptimizingLookupTableTest;
+class SpatialLookupTableTest;
 
 namespace ArdourCanvas {
 
@@ -42,6 +44,11 @@ public:
     virtual std::vector<Item*> items_at_point (Duple const &) const = 0;
     virtual bool has_item_at_point (Duple const & point) const = 0;
 
+    /** Called when the bounding box of one of our item's children may have changed.
+     *  @return false if the table cannot follow the change and must be rebuilt.
+     */
+    virtual bool item_changed (Item *) { return false; }
+
 protected:
 
     Item const & _item;
@@ -55,6 +62,69 @@ public:
     std::vector<Item*> get (Rect const &);
     std::vector<Item*> items_at_point (Duple const &) const;
     bool has_item_at_point (Duple const & point) const;
+    bool item_changed (Item *) { return true; }
+};
+
+/** A uniform grid of fixed-size cells in the coordinates of the owning item.
+ *
+ *  Unlike OptimizingLookupTable the grid is not sized from the item's
+ *  bounding box, so a child that moves or changes size only has to be
+ *  moved between cells. Changes are queued and applied on the next lookup.
+ *  Items are returned in stacking order.
+ */
+class LIBCANVAS_API SpatialLookupTable : public LookupTable
+{
+public:
+    SpatialLookupTable (Item const &);
+
+    std::vector<Item*> get (Rect const &);
+    std::vector<Item*> items_at_point (Duple const &) const;
+    bool has_item_at_point (Duple const & point) const;
+    bool item_changed (Item *);
+
+    /** items with at least this many children use a SpatialLookupTable */
+    static size_t min_items;
+    /** width and height of a cell */
+    static Coord cell_size;
+
+  private:
+
+    friend class ::SpatialLookupTableTest;
+
+    /** an item and its position in the stacking order */
+    typedef std::pair<int, Item*> Slot;
+    typedef std::vector<Slot> Cell;
+    typedef std::map<int64_t, Cell> Cells;
+
+    struct Entry {
+	    Entry () : order (0), indexed (false), large (false), dirty (false), x0 (0), y0 (0), x1 (0), y1 (0) {}
+
+	    int order;
+	    bool indexed;
+	    bool large;
+	    bool dirty;
+	    /* cells covered by the item, inclusive */
+	    int x0, y0, x1, y1;
+    };
+
+    typedef std::map<Item const *, Entry> Entries;
+
+    /** cells sorted by x, then y */
+    static int64_t key (int x, int y) { return (int64_t) x * 4294967296LL + ((uint32_t) y ^ 0x80000000u); }
+    static int key_x (int64_t k) { return (int) ((k - ((uint32_t) (k & 0xffffffff))) / 4294967296LL); }
+    static int key_y (int64_t k) { return (int) ((uint32_t) (k & 0xffffffff) ^ 0x80000000u); }
+
+    void insert (Item *, Entry &) const;
+    void erase (Item *, Entry &) const;
+    void update () const;
+    Rect window_to_table (Rect const &) const;
+    void candidates (Rect const &, std::vector<Item*> &) const;
+
+    mutable Cells _cells;
+    mutable Entries _entries;
+    /** items covering too many cells to be stored in each of them, sorted */
+    mutable Cell _large;
+    mutable std::vector<Item*> _dirty;
 };
 
 class LIBCANVAS_API OptimizingLookupTable : public LookupTable
@@ -271,6 +271,8 @@ Item::set_position (Duple p)
 
 	_position = p;
 
+	lut_changed ();
+
 	/* only update canvas and parent if visible. Otherwise, this
 	   will be done when ::show() is called.
 	*/
@@ -377,6 +379,8 @@ Item::propagate_show_hide ()
 {
 	/* bounding box may have changed while we were hidden */
 
+	lut_changed ();
+
 	if (_parent) {
 		_parent->child_changed ();
 	}
@@ -636,6 +640,8 @@ Item::begin_change ()
 void
 Item::end_change ()
 {
+	lut_changed ();
+
 	if (visible()) {
 		_canvas->item_changed (this, _pre_change_bounding_box);
 
@@ -916,6 +922,9 @@ Item::add (Item* i)
 	i->reparent (this, true);
 	invalidate_lut ();
 	_bounding_box_dirty = true;
+
+	/* our bounding box may have grown */
+	lut_changed ();
 }
 
 void
@@ -927,6 +936,9 @@ Item::add_front (Item* i)
 	i->reparent (this, true);
 	invalidate_lut ();
 	_bounding_box_dirty = true;
+
+	/* our bounding box may have grown */
+	lut_changed ();
 }
 
 void
@@ -1049,7 +1061,11 @@ void
 Item::ensure_lut () const
 {
 	if (!_lut) {
-		_lut = new DumbLookupTable (*this);
+		if (_items.size () >= SpatialLookupTable::min_items) {
+			_lut = new SpatialLookupTable (*this);
+		} else {
+			_lut = new DumbLookupTable (*this);
+		}
 	}
 }
 
@@ -1060,10 +1076,26 @@ Item::invalidate_lut () const
 	_lut = 0;
 }
 
+void
+Item::lut_changed () const
+{
+	/* our bounding box, and hence those of all our ancestors, may have
+	 * changed. This is done even while we are not visible, as the lookup
+	 * tables are not rebuilt when we are shown again.
+	 */
+	for (Item const * i = this; i->_parent; i = i->_parent) {
+		if (i->_parent->_lut && !i->_parent->_lut->item_changed (const_cast<Item*> (i))) {
+			i->_parent->invalidate_lut ();
+		}
+	}
+}
+
 void
 Item::child_changed ()
 {
-	invalidate_lut ();
+	/* the lookup table was already updated by the child that changed,
+	 * see lut_changed()
+	 */
 	_bounding_box_dirty = true;
 
 	if (_parent) {
@@ -18,6 +18,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <limits>
+
 #include "canvas/item.h"
 #include "canvas/lookup_table.h"
 
@@ -326,3 +329,270 @@ OptimizingLookupTable::get (Rect const & area)
 	return vitems;
 }
 
+
+size_t SpatialLookupTable::min_items = 128;
+Coord SpatialLookupTable::cell_size = 64.0;
+
+SpatialLookupTable::SpatialLookupTable (Item const & item)
+	: LookupTable (item)
+{
+	list<Item*> const & items = _item.items ();
+	int order = 0;
+
+	for (list<Item*>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		Entry& e (_entries[*i]);
+		e.order = order++;
+		insert (*i, e);
+	}
+}
+
+/** Add an item to the cells covered by its current bounding box */
+void
+SpatialLookupTable::insert (Item* item, Entry& e) const
+{
+	e.indexed = false;
+	e.large = false;
+	e.dirty = false;
+
+	Rect const item_bbox = item->bounding_box ();
+	if (!item_bbox) {
+		return;
+	}
+
+	Rect const r = item->item_to_parent (item_bbox);
+
+	/* very large items (or those using COORD_MAX) would cover too many
+	 * cells, and might not even have valid cell indices.
+	 */
+	double const limit = numeric_limits<int>::max () / 2;
+	double const cx0 = floor (r.x0 / cell_size);
+	double const cy0 = floor (r.y0 / cell_size);
+	double const cx1 = floor (r.x1 / cell_size);
+	double const cy1 = floor (r.y1 / cell_size);
+
+	e.indexed = true;
+
+	if (fabs (cx0) > limit || fabs (cy0) > limit || fabs (cx1) > limit || fabs (cy1) > limit ||
+	    (cx1 - cx0 + 1) * (cy1 - cy0 + 1) > 64) {
+		e.large = true;
+		/* kept sorted, so that candidates() can merge it */
+		Slot const s (e.order, item);
+		_large.insert (lower_bound (_large.begin (), _large.end (), s), s);
+		return;
+	}
+
+	e.x0 = cx0;
+	e.y0 = cy0;
+	e.x1 = cx1;
+	e.y1 = cy1;
+
+	for (int x = e.x0; x <= e.x1; ++x) {
+		for (int y = e.y0; y <= e.y1; ++y) {
+			_cells[key (x, y)].push_back (Slot (e.order, item));
+		}
+	}
+}
+
+/** Remove an item from all cells it was added to by insert() */
+void
+SpatialLookupTable::erase (Item* item, Entry& e) const
+{
+	if (!e.indexed) {
+		return;
+	}
+
+	if (e.large) {
+		Cell::iterator i = lower_bound (_large.begin (), _large.end (), Slot (e.order, item));
+		assert (i != _large.end () && i->second == item);
+		_large.erase (i);
+		e.indexed = false;
+		return;
+	}
+
+	for (int x = e.x0; x <= e.x1; ++x) {
+		for (int y = e.y0; y <= e.y1; ++y) {
+			Cells::iterator c = _cells.find (key (x, y));
+			assert (c != _cells.end ());
+			c->second.erase (find (c->second.begin (), c->second.end (), Slot (e.order, item)));
+			if (c->second.empty ()) {
+				_cells.erase (c);
+			}
+		}
+	}
+
+	e.indexed = false;
+}
+
+bool
+SpatialLookupTable::item_changed (Item* item)
+{
+	Entries::iterator e = _entries.find (item);
+
+	if (e == _entries.end ()) {
+		/* not one of ours (yet) */
+		return false;
+	}
+
+	/* Do not ask for the item's bounding box now, it is likely to
+	 * change again (e.g. during a drag) before the next lookup.
+	 */
+	if (!e->second.dirty) {
+		e->second.dirty = true;
+		_dirty.push_back (item);
+	}
+
+	return true;
+}
+
+void
+SpatialLookupTable::update () const
+{
+	for (vector<Item*>::const_iterator i = _dirty.begin(); i != _dirty.end(); ++i) {
+		Entry& e (_entries[*i]);
+		erase (*i, e);
+		insert (*i, e);
+	}
+	_dirty.clear ();
+}
+
+/** @return @a area (in window coordinates) in the coordinates of our item's
+ *  children's positions, which is what the table is indexed by.
+ */
+Rect
+SpatialLookupTable::window_to_table (Rect const & area) const
+{
+	/* Our item and its children do not necessarily share a scroll group,
+	 * (our item may be the scroll group) so convert via one of the
+	 * children, all of which use the same one.
+	 */
+	Item const * child = _item.items ().front ();
+	return child->item_to_parent (child->window_to_item (area));
+}
+
+/** Collect items whose cells intersect @a r, in stacking order */
+void
+SpatialLookupTable::candidates (Rect const & r, vector<Item*>& items) const
+{
+	Cell slots;
+
+	/* window coordinates are rounded, so look one unit further */
+	double const cx0 = floor ((r.x0 - 1.0) / cell_size);
+	double const cy0 = floor ((r.y0 - 1.0) / cell_size);
+	double const cx1 = floor ((r.x1 + 1.0) / cell_size);
+	double const cy1 = floor ((r.y1 + 1.0) / cell_size);
+
+	if (cx1 - cx0 < 4096 && fabs (cx0) < numeric_limits<int>::max () && fabs (cx1) < numeric_limits<int>::max ()) {
+		int const y0 = max (cy0, (double) numeric_limits<int>::min ());
+		int const y1 = min (cy1, (double) numeric_limits<int>::max ());
+		for (int x = cx0; x <= (int) cx1; ++x) {
+			Cells::const_iterator c = _cells.lower_bound (key (x, y0));
+			Cells::const_iterator const end = _cells.upper_bound (key (x, y1));
+			for (; c != end; ++c) {
+				slots.insert (slots.end (), c->second.begin (), c->second.end ());
+			}
+		}
+	} else {
+		/* very wide area, check all cells */
+		for (Cells::const_iterator c = _cells.begin (); c != _cells.end (); ++c) {
+			int const x = key_x (c->first);
+			int const y = key_y (c->first);
+			if (x >= cx0 && x <= cx1 && y >= cy0 && y <= cy1) {
+				slots.insert (slots.end (), c->second.begin (), c->second.end ());
+			}
+		}
+	}
+
+	sort (slots.begin (), slots.end ());
+	slots.erase (unique (slots.begin (), slots.end ()), slots.end ());
+
+	/* large items are never in a cell, merge them in stacking order */
+	items.reserve (slots.size () + _large.size ());
+
+	Cell::const_iterator s = slots.begin ();
+	Cell::const_iterator l = _large.begin ();
+
+	while (s != slots.end () || l != _large.end ()) {
+		if (l == _large.end () || (s != slots.end () && *s < *l)) {
+			items.push_back ((s++)->second);
+		} else {
+			items.push_back ((l++)->second);
+		}
+	}
+}
+
+vector<Item *>
+SpatialLookupTable::get (Rect const & area)
+{
+	vector<Item *> vitems;
+
+	if (_item.items ().empty ()) {
+		return vitems;
+	}
+
+	update ();
+
+	vector<Item *> items;
+	candidates (window_to_table (area), items);
+
+	for (vector<Item *>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		Rect item_bbox = (*i)->bounding_box ();
+		if (!item_bbox) continue;
+		Rect item = (*i)->item_to_window (item_bbox);
+		if (item.intersection (area)) {
+			vitems.push_back (*i);
+		}
+	}
+
+	return vitems;
+}
+
+vector<Item *>
+SpatialLookupTable::items_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	vector<Item *> vitems;
+
+	if (_item.items ().empty ()) {
+		return vitems;
+	}
+
+	update ();
+
+	vector<Item *> items;
+	candidates (window_to_table (Rect (point.x, point.y, point.x, point.y)), items);
+
+	for (vector<Item *>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		if ((*i)->covers (point)) {
+			vitems.push_back (*i);
+		}
+	}
+
+	return vitems;
+}
+
+bool
+SpatialLookupTable::has_item_at_point (Duple const & point) const
+{
+	/* Point is in window coordinate system */
+
+	if (_item.items ().empty ()) {
+		return false;
+	}
+
+	update ();
+
+	vector<Item *> items;
+	candidates (window_to_table (Rect (point.x, point.y, point.x, point.y)), items);
+
+	for (vector<Item *>::const_iterator i = items.begin(); i != items.end(); ++i) {
+		if (!(*i)->visible()) {
+			continue;
+		}
+		if ((*i)->covers (point)) {
+			return true;
+		}
+	}
+
+	return false;
+}
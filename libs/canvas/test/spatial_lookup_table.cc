@@ -0,0 +1,156 @@
+#include <algorithm>
+
+#include "canvas/lookup_table.h"
+#include "canvas/types.h"
+#include "canvas/rectangle.h"
+#include "canvas/canvas.h"
+#include "spatial_lookup_table.h"
+#include "test_canvas.h"
+
+using namespace std;
+using namespace ArdourCanvas;
+
+CPPUNIT_TEST_SUITE_REGISTRATION (SpatialLookupTableTest);
+
+/** Items are stored in the cells that their bounding boxes touch */
+void
+SpatialLookupTableTest::cells ()
+{
+	TestCanvas canvas;
+	Rectangle a (canvas.root(), Rect (0, 0, 32, 32));
+	a.set_outline_width (0);
+	Rectangle b (canvas.root(), Rect (70, 0, 100, 32));
+	b.set_outline_width (0);
+	Rectangle c (canvas.root(), Rect (-100, -100, -70, -70));
+	c.set_outline_width (0);
+	Rectangle d (canvas.root(), Rect (32, 32, 96, 96));
+	d.set_outline_width (0);
+	SpatialLookupTable table (*canvas.root());
+
+	CPPUNIT_ASSERT (table._large.empty ());
+
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (0, 0)].size () == 2);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (0, 0)][0].second == &a);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (0, 0)][1].second == &d);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (1, 0)].size () == 2);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (1, 0)][0].second == &b);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (-2, -2)].size () == 1);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (-2, -2)][0].second == &c);
+	/* d covers 2x2 cells */
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (1, 1)].size () == 1);
+	CPPUNIT_ASSERT (table._cells[SpatialLookupTable::key (0, 1)].size () == 1);
+
+	CPPUNIT_ASSERT (SpatialLookupTable::key_x (SpatialLookupTable::key (-2, 3)) == -2);
+	CPPUNIT_ASSERT (SpatialLookupTable::key_y (SpatialLookupTable::key (-2, 3)) == 3);
+
+	vector<Item*> items = table.get (Rect (0, 0, 16, 16));
+	CPPUNIT_ASSERT (items.size () == 1);
+	CPPUNIT_ASSERT (items[0] == &a);
+
+	items = table.items_at_point (Duple (-80, -80));
+	CPPUNIT_ASSERT (items.size () == 1);
+	CPPUNIT_ASSERT (items[0] == &c);
+
+	/* a, b and d, in stacking order */
+	items = table.get (Rect (16, 16, 80, 40));
+	CPPUNIT_ASSERT (items.size () == 3);
+	CPPUNIT_ASSERT (items[0] == &a);
+	CPPUNIT_ASSERT (items[1] == &b);
+	CPPUNIT_ASSERT (items[2] == &d);
+}
+
+/** Items that cover many cells are kept in a separate, sorted list */
+void
+SpatialLookupTableTest::large ()
+{
+	TestCanvas canvas;
+	Rectangle a (canvas.root(), Rect (0, 0, 10000, 10000));
+	a.set_outline_width (0);
+	Rectangle b (canvas.root(), Rect (5000, 5000, 5010, 5010));
+	b.set_outline_width (0);
+	Rectangle c (canvas.root(), Rect (-10000, 0, 10000, 100));
+	c.set_outline_width (0);
+	SpatialLookupTable table (*canvas.root());
+
+	CPPUNIT_ASSERT (table._large.size () == 2);
+	CPPUNIT_ASSERT (table._large[0].second == &a);
+	CPPUNIT_ASSERT (table._large[1].second == &c);
+	CPPUNIT_ASSERT (table._cells.size () == 1);
+
+	/* large items are merged with the others in stacking order */
+	vector<Item*> items = table.items_at_point (Duple (5005, 5005));
+	CPPUNIT_ASSERT (items.size () == 2);
+	CPPUNIT_ASSERT (items[0] == &a);
+	CPPUNIT_ASSERT (items[1] == &b);
+
+	items = table.get (Rect (4990, 50, 5020, 5020));
+	CPPUNIT_ASSERT (items.size () == 3);
+	CPPUNIT_ASSERT (items[0] == &a);
+	CPPUNIT_ASSERT (items[1] == &b);
+	CPPUNIT_ASSERT (items[2] == &c);
+
+	/* re-inserting a changed large item keeps the list sorted */
+	CPPUNIT_ASSERT (table.item_changed (&a));
+	table.get (Rect (0, 0, 1, 1));
+	CPPUNIT_ASSERT (table._large.size () == 2);
+	CPPUNIT_ASSERT (table._large[0].second == &a);
+	CPPUNIT_ASSERT (table._large[1].second == &c);
+
+	/* b becomes large, a small */
+	b.set (Rect (0, 0, 20000, 20000));
+	a.set (Rect (0, 0, 10, 10));
+	CPPUNIT_ASSERT (table.item_changed (&a));
+	CPPUNIT_ASSERT (table.item_changed (&b));
+	items = table.items_at_point (Duple (5, 5));
+	CPPUNIT_ASSERT (items.size () == 3);
+	CPPUNIT_ASSERT (items[0] == &a);
+	CPPUNIT_ASSERT (items[1] == &b);
+	CPPUNIT_ASSERT (items[2] == &c);
+	CPPUNIT_ASSERT (table._large.size () == 2);
+	CPPUNIT_ASSERT (table._large[0].second == &b);
+	CPPUNIT_ASSERT (table._large[1].second == &c);
+}
+
+/** Items that move are found at their new position via Item::lut_changed() */
+void
+SpatialLookupTableTest::moved ()
+{
+	size_t const old_min_items = SpatialLookupTable::min_items;
+	SpatialLookupTable::min_items = 1;
+
+	TestCanvas canvas;
+	Rectangle a (canvas.root(), Rect (0, 0, 32, 32));
+	a.set_outline_width (0);
+	Rectangle b (canvas.root(), Rect (100, 100, 132, 132));
+	b.set_outline_width (0);
+
+	vector<Item const *> items;
+	canvas.root()->add_items_at_point (Duple (16, 16), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &a) != items.end ());
+
+	/* moving a marks its entry in the root's table as dirty */
+	a.set_position (Duple (200, 200));
+
+	items.clear ();
+	canvas.root()->add_items_at_point (Duple (16, 16), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &a) == items.end ());
+
+	items.clear ();
+	canvas.root()->add_items_at_point (Duple (216, 216), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &a) != items.end ());
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &b) == items.end ());
+
+	/* and again, now that the table exists */
+	a.set_position (Duple (100, 100));
+
+	items.clear ();
+	canvas.root()->add_items_at_point (Duple (116, 116), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &a) != items.end ());
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &b) != items.end ());
+
+	items.clear ();
+	canvas.root()->add_items_at_point (Duple (216, 216), items);
+	CPPUNIT_ASSERT (find (items.begin (), items.end (), &a) == items.end ());
+
+	SpatialLookupTable::min_items = old_min_items;
+}
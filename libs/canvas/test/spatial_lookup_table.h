@@ -0,0 +1,16 @@
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class SpatialLookupTableTest : public CppUnit::TestFixture
+{
+	CPPUNIT_TEST_SUITE (SpatialLookupTableTest);
+	CPPUNIT_TEST (cells);
+	CPPUNIT_TEST (large);
+	CPPUNIT_TEST (moved);
+	CPPUNIT_TEST_SUITE_END ();
+
+public:
+	void cells ();
+	void large ();
+	void moved ();
+};
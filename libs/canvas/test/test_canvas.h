@@ -0,0 +1,26 @@
+#include "canvas/canvas.h"
+
+/** A canvas that is not shown anywhere, for tests that only need items */
+class TestCanvas : public ArdourCanvas::Canvas
+{
+public:
+	void request_redraw (ArdourCanvas::Rect const &) {}
+	void request_size (ArdourCanvas::Duple) {}
+	void grab (ArdourCanvas::Item *) {}
+	void ungrab () {}
+	void focus (ArdourCanvas::Item *) {}
+	void unfocus (ArdourCanvas::Item *) {}
+
+	ArdourCanvas::Rect visible_area () const { return ArdourCanvas::Rect (0, 0, 4096, 4096); }
+	ArdourCanvas::Coord width () const { return 4096; }
+	ArdourCanvas::Coord height () const { return 4096; }
+
+	bool get_mouse_position (ArdourCanvas::Duple&) const { return false; }
+	void re_enter () {}
+
+	Glib::RefPtr<Pango::Context> get_pango_context () { return Glib::RefPtr<Pango::Context> (); }
+
+protected:
+	void pick_current_item (int) {}
+	void pick_current_item (ArdourCanvas::Duple const &, int) {}
+};
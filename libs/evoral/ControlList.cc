@@ -35,6 +35,7 @@
 
 #define GUARD_POINT_DELTA 64
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -79,6 +80,7 @@ ControlList::ControlList (const Parameter& id, const ParameterDescriptor& desc)
 	did_write_during_pass = false;
 	insert_position = -1;
 	most_recent_insert_iterator = _events.end();
+	_flat_events.valid = true;
 }
 
 ControlList::ControlList (const ControlList& other)
@@ -419,9 +421,18 @@ ControlList::fast_simple_add (double when, double value)
 {
 	Glib::Threads::RWLock::WriterLock lm (_lock);
 	/* to be used only for loading pre-sorted data from saved state */
-	_events.insert (_events.end(), new ControlEvent (when, value));
-
-	mark_dirty ();
+	iterator i = _events.insert (_events.end(), new ControlEvent (when, value));
+
+	if (!_frozen && _flat_events.valid && (_flat_events.when.empty () || _flat_events.when.back () <= when)) {
+		/* appending in order: extend the flat copy instead of rebuilding it */
+		_flat_events.when.push_back (when);
+		_flat_events.value.push_back (value);
+		_flat_events.iter.push_back (i);
+		invalidate_lookup_caches ();
+		events_changed ();
+	} else {
+		mark_dirty ();
+	}
 	if (_frozen) {
 		_sort_pending = true;
 	}
@@ -500,6 +511,11 @@ ControlList::write_pass_finished (double /*when*/, double thinning_factor)
 	}
 	new_write_pass = true;
 	_in_write_pass = false;
+
+	Glib::Threads::RWLock::WriterLock lm (_lock);
+	if (!_flat_events.valid) {
+		unlocked_rebuild_flat_events ();
+	}
 }
 
 void
@@ -1132,6 +1148,12 @@ ControlList::thaw ()
 			unlocked_remove_duplicates ();
 			unlocked_invalidate_insert_iterator ();
 			_sort_pending = false;
+			_flat_events.valid = false;
+		}
+
+		if (!_flat_events.valid) {
+			/* edits made while frozen are flattened once, here */
+			unlocked_rebuild_flat_events ();
 		}
 	}
 	maybe_signal_changed ();
@@ -1139,6 +1161,20 @@ ControlList::thaw ()
 
 void
 ControlList::mark_dirty () const
+{
+	invalidate_lookup_caches ();
+
+	/* Rebuilding the flat copy on every edit would make a write pass
+	 * quadratic. Readers fall back to the event list until it is rebuilt
+	 * by thaw(), write_pass_finished() or the next eval().
+	 */
+	_flat_events.valid = false;
+
+	events_changed ();
+}
+
+void
+ControlList::invalidate_lookup_caches () const
 {
 	_lookup_cache.left = -1;
 	_lookup_cache.range.first = _events.end();
@@ -1151,6 +1187,61 @@ ControlList::mark_dirty () const
 	}
 }
 
+double
+ControlList::eval (double where) const
+{
+	{
+		Glib::Threads::RWLock::ReaderLock lm (_lock);
+		if (_flat_events.valid) {
+			return unlocked_eval (where);
+		}
+	}
+
+	/* first read since the list was edited */
+	Glib::Threads::RWLock::WriterLock lm (_lock);
+	if (!_flat_events.valid) {
+		unlocked_rebuild_flat_events ();
+	}
+	return unlocked_eval (where);
+}
+
+void
+ControlList::unlocked_rebuild_flat_events () const
+{
+	/* called with the write-lock held (or from a c'tor) */
+	_flat_events.when.clear ();
+	_flat_events.value.clear ();
+	_flat_events.iter.clear ();
+
+	for (const_iterator i = _events.begin(); i != _events.end(); ++i) {
+		_flat_events.when.push_back ((*i)->when);
+		_flat_events.value.push_back ((*i)->value);
+		_flat_events.iter.push_back (i);
+	}
+
+	_flat_events.valid = true;
+}
+
+size_t
+ControlList::FlatEvents::lower_bound (double x) const
+{
+	if (when.empty ()) {
+		return 0;
+	}
+	const double* const w = &when[0];
+	return std::lower_bound (w, w + when.size (), x) - w;
+}
+
+size_t
+ControlList::FlatEvents::upper_bound (double x) const
+{
+	if (when.empty ()) {
+		return 0;
+	}
+	const double* const w = &when[0];
+	return std::upper_bound (w, w + when.size (), x) - w;
+}
+
 void
 ControlList::truncate_end (double last_coordinate)
 {
@@ -1362,10 +1453,14 @@ ControlList::unlocked_eval (double x) const
 	double lval, uval;
 	double fraction;
 
-	const_iterator length_check_iter = _events.begin();
-	for (npoints = 0; npoints < 4; ++npoints, ++length_check_iter) {
-		if (length_check_iter == _events.end()) {
-			break;
+	if (_flat_events.valid) {
+		npoints = std::min (_flat_events.size (), (size_t) 4);
+	} else {
+		const_iterator length_check_iter = _events.begin();
+		for (npoints = 0; npoints < 4; ++npoints, ++length_check_iter) {
+			if (length_check_iter == _events.end()) {
+				break;
+			}
 		}
 	}
 
@@ -1425,6 +1520,10 @@ ControlList::multipoint_eval (double x) const
 	double uval, lval;
 	double fraction;
 
+	if (_flat_events.valid) {
+		return flat_multipoint_eval (x);
+	}
+
 	/* "Stepped" lookup (no interpolation) */
 	/* FIXME: no cache.  significant? */
 	if (_interpolation == Discrete) {
@@ -1503,6 +1602,47 @@ ControlList::multipoint_eval (double x) const
 	return (*range.first)->value;
 }
 
+/** multipoint_eval() using the flat copy of the event list,
+ * a binary search on contiguous memory.
+ */
+double
+ControlList::flat_multipoint_eval (double x) const
+{
+	const size_t n = _flat_events.size ();
+	const size_t i = _flat_events.lower_bound (x);
+
+	if (i == n) {
+		/* we're after the last point */
+		return _flat_events.value[n - 1];
+	}
+
+	if (i == 0 || _flat_events.when[i] == x) {
+		/* before the first point, or x is a control point in the data */
+		return _flat_events.value[i];
+	}
+
+	const double lpos = _flat_events.when[i - 1];
+	const double lval = _flat_events.value[i - 1];
+	const double upos = _flat_events.when[i];
+	const double uval = _flat_events.value[i];
+
+	const double fraction = (double) (x - lpos) / (double) (upos - lpos);
+
+	switch (_interpolation) {
+		case Discrete:
+			return lval;
+		case Logarithmic:
+			return interpolate_logarithmic (lval, uval, fraction, _desc.lower, _desc.upper);
+		case Exponential:
+			return interpolate_gain (lval, uval, fraction, _desc.upper);
+		case Curved:
+			/* only used x-fade curves, never direct eval */
+			assert (0);
+		default: // Linear
+			return interpolate_linear (lval, uval, fraction);
+	}
+}
+
 void
 ControlList::build_search_cache_if_necessary (double start) const
 {
@@ -1514,9 +1654,13 @@ ControlList::build_search_cache_if_necessary (double start) const
 	} else if ((_search_cache.left < 0) || (_search_cache.left > start)) {
 		/* Marked dirty (left < 0), or we're too far forward, re-search. */
 
-		const ControlEvent start_point (start, 0);
-
-		_search_cache.first = lower_bound (_events.begin(), _events.end(), &start_point, time_comparator);
+		if (_flat_events.valid) {
+			const size_t i = _flat_events.lower_bound (start);
+			_search_cache.first = i < _flat_events.size () ? _flat_events.iter[i] : _events.end();
+		} else {
+			const ControlEvent start_point (start, 0);
+			_search_cache.first = lower_bound (_events.begin(), _events.end(), &start_point, time_comparator);
+		}
 		_search_cache.left = start;
 	}
 
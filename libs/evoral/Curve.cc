@@ -39,6 +39,90 @@ using namespace sigc;
 
 namespace Evoral {
 
+/* Segment renderers used by Curve::_get_vector().
+ *
+ * Each fills @a cnt samples of a single segment between two control
+ * points, where the interpolation fraction is f0 + i * df for sample i.
+ * The loops are kept free of per-sample branches and dependencies so
+ * that the compiler can vectorize them.
+ */
+
+static void
+render_constant (float* vec, int32_t cnt, double val)
+{
+	for (int32_t i = 0; i < cnt; ++i) {
+		vec[i] = val;
+	}
+}
+
+static void
+render_linear (float* vec, int32_t cnt, double from, double to, double f0, double df)
+{
+	const double delta = to - from;
+	for (int32_t i = 0; i < cnt; ++i) {
+		vec[i] = from + delta * (f0 + i * df);
+	}
+}
+
+static void
+render_logarithmic (float* vec, int32_t cnt, double from, double to, double f0, double df)
+{
+	/* from * (to / from) ^ fraction is a geometric sequence in i:
+	 * anchor every 8 samples with pow(), scale by precomputed ratios
+	 * in between.
+	 */
+	assert (from > 0 && from * to > 0);
+	const double r = to / from;
+
+	double q[8];
+	for (int k = 0; k < 8; ++k) {
+		q[k] = pow (r, k * df);
+	}
+
+	int32_t i = 0;
+	for (; i + 8 <= cnt; i += 8) {
+		const double base = from * pow (r, f0 + i * df);
+		for (int k = 0; k < 8; ++k) {
+			vec[i + k] = base * q[k];
+		}
+	}
+	for (; i < cnt; ++i) {
+		vec[i] = from * pow (r, f0 + i * df);
+	}
+}
+
+static void
+render_gain (float* vec, int32_t cnt, double from, double to, double f0, double df, double upper)
+{
+	/* interpolate_gain() is too expensive to call for every sample:
+	 * evaluate it every 8 samples and interpolate linearly in between
+	 * (well below the resolution of the 25Hz de-zipper in Amp::run()).
+	 */
+	double g0 = interpolate_gain (from, to, f0, upper);
+
+	int32_t i = 0;
+	for (; i + 8 <= cnt; i += 8) {
+		const double g1 = interpolate_gain (from, to, min (1.0, f0 + (i + 8) * df), upper);
+		const double dg = (g1 - g0) / 8.0;
+		for (int k = 0; k < 8; ++k) {
+			vec[i + k] = g0 + k * dg;
+		}
+		g0 = g1;
+	}
+	for (; i < cnt; ++i) {
+		vec[i] = interpolate_gain (from, to, f0 + i * df, upper);
+	}
+}
+
+static void
+render_cubic (float* vec, int32_t cnt, const double* coeff, double x0, double dx)
+{
+	for (int32_t i = 0; i < cnt; ++i) {
+		const double x = x0 + i * dx;
+		const double x2 = x * x;
+		vec[i] = coeff[0] + (coeff[1] * x) + (coeff[2] * x2) + (coeff[3] * x2 * x);
+	}
+}
 
 Curve::Curve (const ControlList& cl)
 	: _dirty (true)
@@ -205,7 +289,13 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen) const
 		return;
 	}
 
-	if ((npoints = _list.events().size()) == 0) {
+	if (_list.flat_events().valid) {
+		npoints = _list.flat_events().size();
+	} else {
+		npoints = _list.events().size();
+	}
+
+	if (npoints == 0) {
 		/* no events in list, so just fill the entire array with the default value */
 		for (int32_t i = 0; i < veclen; ++i) {
 			vec[i] = _list.descriptor().normal;
@@ -365,16 +455,154 @@ Curve::_get_vector (double x0, double x1, float *vec, int32_t veclen) const
 		dx = (hx - lx) / (veclen - 1);
 	}
 
+	if (_list.flat_events().valid && dx > 0) {
+		render_segments (lx, dx, vec, veclen);
+		return;
+	}
+
 	for (i = 0; i < veclen; ++i, rx += dx) {
 		vec[i] = multipoint_eval (rx);
 	}
 }
 
+/** Fill @a vec with the curve at lx + i * dx, rendering whole segments
+ * between control points at a time.
+ *
+ * The x position is monotonic: search the flat event list once, then
+ * walk it alongside.
+ */
+void
+Curve::render_segments (double lx, double dx, float* vec, int32_t veclen) const
+{
+	const ControlList::FlatEvents& flat = _list.flat_events();
+	const size_t n = flat.size();
+	size_t index = flat.lower_bound (lx);
+	int32_t i = 0;
+
+	while (i < veclen) {
+		const double rx = lx + i * dx;
+
+		while (index < n && flat.when[index] < rx) {
+			++index;
+		}
+
+		if (index == 0 || index == n || flat.when[index] == rx) {
+			/* outside the list, or on a control point */
+			vec[i] = flat_eval (index, rx);
+			++i;
+			continue;
+		}
+
+		/* samples [i, end) are in the segment [index - 1, index) */
+		const double lpos = flat.when[index - 1];
+		const double upos = flat.when[index];
+
+		int32_t end = (int32_t) min ((double) veclen, ceil ((upos - lx) / dx));
+		end = max (end, i + 1);
+		while (end > i + 1 && lx + (end - 1) * dx >= upos) {
+			--end;
+		}
+		while (end < veclen && lx + end * dx < upos) {
+			++end;
+		}
+
+		const int32_t cnt = end - i;
+		const double before = flat.value[index - 1];
+		const double after = flat.value[index];
+		const double trange = upos - lpos;
+		const double f0 = (rx - lpos) / trange;
+		const double df = dx / trange;
+
+		if (before == after) {
+			render_constant (vec + i, cnt, before);
+		} else {
+			switch (_list.interpolation()) {
+				case ControlList::Discrete:
+					render_constant (vec + i, cnt, before);
+					break;
+				case ControlList::Logarithmic:
+					render_logarithmic (vec + i, cnt, before, after, f0, df);
+					break;
+				case ControlList::Exponential:
+					render_gain (vec + i, cnt, before, after, f0, df, _list.descriptor().upper);
+					break;
+				case ControlList::Curved:
+					if ((*flat.iter[index])->coeff) {
+						render_cubic (vec + i, cnt, (*flat.iter[index])->coeff, rx, dx);
+						break;
+					}
+					/* fallthrough */
+				case ControlList::Linear:
+					render_linear (vec + i, cnt, before, after, f0, df);
+					break;
+			}
+		}
+
+		i = end;
+	}
+}
+
+/** Evaluate at @a x, given the index of the first event at or after @a x
+ * in the flat copy of the list (see ControlList::FlatEvents::lower_bound).
+ */
+double
+Curve::flat_eval (size_t index, double x) const
+{
+	const ControlList::FlatEvents& flat = _list.flat_events();
+
+	if (index == flat.size()) {
+		/* we're after the last point */
+		return flat.value.back();
+	}
+
+	if (index == 0 || flat.when[index] == x) {
+		/* before the first point, or x is a control point in the data */
+		return flat.value[index];
+	}
+
+	const double before = flat.value[index - 1];
+	const double after = flat.value[index];
+	const double vdelta = after - before;
+
+	if (vdelta == 0.0) {
+		return before;
+	}
+
+	const double tdelta = x - flat.when[index - 1];
+	const double trange = flat.when[index] - flat.when[index - 1];
+
+	switch (_list.interpolation()) {
+		case ControlList::Discrete:
+			return before;
+		case ControlList::Logarithmic:
+			return interpolate_logarithmic (before, after, tdelta / trange, _list.descriptor().lower, _list.descriptor().upper);
+		case ControlList::Exponential:
+			return interpolate_gain (before, after, tdelta / trange, _list.descriptor().upper);
+		case ControlList::Curved:
+			{
+				const ControlEvent* ev = *flat.iter[index];
+				if (ev->coeff) {
+					double x2 = x * x;
+					return ev->coeff[0] + (ev->coeff[1] * x) + (ev->coeff[2] * x2) + (ev->coeff[3] * x2 * x);
+				}
+			}
+			/* fallthrough */
+		case ControlList::Linear:
+			break;
+	}
+
+	return before + (vdelta * (tdelta / trange));
+}
+
 double
 Curve::multipoint_eval (double x) const
 {
 	pair<ControlList::EventList::const_iterator,ControlList::EventList::const_iterator> range;
 
+	if (_list.flat_events().valid) {
+		return flat_eval (_list.flat_events().lower_bound (x), x);
+	}
+
 	ControlList::LookupCache& lookup_cache = _list.lookup_cache();
 
 	if ((lookup_cache.left < 0) ||
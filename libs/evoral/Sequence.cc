@@ -28,6 +28,8 @@
 #include <stdint.h>
 #include <cstdio>
 
+#include <boost/make_shared.hpp>
+
 #if __clang__
 #include "evoral/Note.h"
 #endif
@@ -62,6 +64,13 @@ static double const time_between_interpolated_controller_outputs = 1.0 / 256;
 
 namespace Evoral {
 
+template<typename Time>
+static bool
+note_is_earlier (boost::shared_ptr<Note<Time> > const& note, Time const& t)
+{
+	return note->time() < t;
+}
+
 // Read iterator (const_iterator)
 
 template<typename Time>
@@ -87,7 +96,7 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	, _active_patch_change_message (0)
 	, _type(NIL)
 	, _is_end((t == DBL_MAX) || seq.empty())
-	, _note_iter(seq.notes().end())
+	, _note_iter(seq._note_index.end())
 	, _sysex_iter(seq.sysexes().end())
 	, _patch_change_iter(seq.patch_changes().end())
 	, _control_iter(_control_iters.end())
@@ -113,7 +122,8 @@ Sequence<Time>::const_iterator::const_iterator(const Sequence<Time>&
 	}
 
 	// Find first note which begins at or after t
-	_note_iter = seq.note_lower_bound(t);
+	const NoteIndex& notes (seq.note_index());
+	_note_iter = std::lower_bound (notes.begin(), notes.end(), t, note_is_earlier<Time>);
 
 	// Find first sysex event at or after t
 	for (typename Sequence<Time>::SysExes::const_iterator i = seq.sysexes().begin();
@@ -226,7 +236,7 @@ Sequence<Time>::const_iterator::invalidate(std::set< boost::weak_ptr< Note<Time>
 	_type = NIL;
 	_is_end = true;
 	if (_seq) {
-		_note_iter = _seq->notes().end();
+		_note_iter = _seq->_note_index.end();
 		_sysex_iter = _seq->sysexes().end();
 		_patch_change_iter = _seq->patch_changes().end();
 		_active_patch_change_message = 0;
@@ -243,7 +253,7 @@ Sequence<Time>::const_iterator::choose_next(Time earliest_t)
 	_type = NIL;
 
 	// Next earliest note on, if any
-	if (_note_iter != _seq->notes().end()) {
+	if (_note_iter != _seq->_note_index.end()) {
 		_type      = NOTE_ON;
 		earliest_t = (*_note_iter)->time();
 	}
@@ -472,6 +482,7 @@ Sequence<Time>::Sequence(const TypeMap& type_map)
 	, _overlap_pitch_resolution (FirstOnFirstOff)
 	, _writing(false)
 	, _type_map(type_map)
+	, _note_index_dirty(false)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(false)
 	, _lowest_note(127)
@@ -494,14 +505,15 @@ Sequence<Time>::Sequence(const Sequence<Time>& other)
 	, _overlap_pitch_resolution (other._overlap_pitch_resolution)
 	, _writing(false)
 	, _type_map(other._type_map)
+	, _note_index_dirty(true)
 	, _end_iter(*this, std::numeric_limits<Time>::max(), false, std::set<Evoral::Parameter> ())
 	, _percussive(other._percussive)
 	, _lowest_note(other._lowest_note)
 	, _highest_note(other._highest_note)
 {
 	for (typename Notes::const_iterator i = other._notes.begin(); i != other._notes.end(); ++i) {
-		NotePtr n (new Note<Time> (**i));
-		_notes.insert (n);
+		NotePtr n (boost::allocate_shared<Note<Time> > (NoteAllocator (), **i));
+		_notes.insert (_notes.end (), n);
 	}
 
 	for (typename SysExes::const_iterator i = other._sysexes.begin(); i != other._sysexes.end(); ++i) {
@@ -619,6 +631,8 @@ Sequence<Time>::clear()
 {
 	WriteLock lock(write_lock());
 	_notes.clear();
+	_note_index.clear();
+	_note_index_dirty = false;
 	for (Controls::iterator li = _controls.begin(); li != _controls.end(); ++li)
 		li->second->list()->clear();
 }
@@ -671,12 +685,14 @@ Sequence<Time>::end_write (StuckNoteOption option, Time when)
 			case DeleteStuckNotes:
 				cerr << "WARNING: Stuck note lost (end was " << when << "): " << (**n) << endl;
 				_notes.erase(n);
+				_note_index_dirty = true;
 				break;
 			case ResolveStuckNotes:
 				if (when <= (*n)->time()) {
 					cerr << "WARNING: Stuck note resolution - end time @ "
 					     << when << " is before note on: " << (**n) << endl;
 					_notes.erase (n);
+					_note_index_dirty = true;
 				} else {
 					(*n)->set_length (when - (*n)->time());
 					cerr << "WARNING: resolved note-on with no note-off to generate " << (**n) << endl;
@@ -719,9 +735,13 @@ Sequence<Time>::add_note_unlocked(const NotePtr note, void* arg)
 	if (note->note() > _highest_note)
 		_highest_note = note->note();
 
-	_notes.insert (note);
+	/* notes are usually appended in time order (e.g. when loading), so
+	 * hint that the note belongs at the end.
+	 */
+	_notes.insert (_notes.end(), note);
 	_pitches[note->channel()].insert (note);
 
+	_note_index_dirty = true;
 	_edited = true;
 
 	return true;
@@ -856,6 +876,7 @@ Sequence<Time>::remove_note_unlocked(const constNotePtr note)
 			warning << string_compose ("erased note %1 not found in pitches for channel %2", *note, (int) note->channel()) << endmsg;
 		}
 
+		_note_index_dirty = true;
 		_edited = true;
 
 	} else {
@@ -1000,7 +1021,7 @@ Sequence<Time>::append_note_on_unlocked (const Event<Time>& ev, event_id_t evid)
 	/* nascent (incoming notes without a note-off ...yet) have a duration
 	   that extends to Beats::max()
 	*/
-	NotePtr note(new Note<Time>(ev.channel(), ev.time(), std::numeric_limits<Temporal::Beats>::max() - ev.time(), ev.note(), ev.velocity()));
+	NotePtr note = new_note (ev.channel(), ev.time(), std::numeric_limits<Temporal::Beats>::max() - ev.time(), ev.note(), ev.velocity());
 	assert (note->end_time() == std::numeric_limits<Temporal::Beats>::max());
 	note->set_id (evid);
 
@@ -1200,6 +1221,34 @@ void
 Sequence<Time>::set_notes (const typename Sequence<Time>::Notes& n)
 {
 	_notes = n;
+	_note_index_dirty = true;
+}
+
+/** Return the notes in time order as a flat vector, rebuilding it from
+ * _notes if they have been edited since it was last used.
+ *
+ * The caller must hold the read lock: the vector is only rebuilt after
+ * a write, so it does not change under any live iterator.
+ */
+template<typename Time>
+const typename Sequence<Time>::NoteIndex&
+Sequence<Time>::note_index () const
+{
+	Glib::Threads::Mutex::Lock lm (_note_index_lock);
+
+	if (_note_index_dirty) {
+		_note_index.assign (_notes.begin(), _notes.end());
+		_note_index_dirty = false;
+	}
+
+	return _note_index;
+}
+
+template<typename Time>
+typename Sequence<Time>::NotePtr
+Sequence<Time>::new_note (uint8_t chan, Time time, Time len, uint8_t note, uint8_t vel) const
+{
+	return boost::allocate_shared<Note<Time> > (NoteAllocator (), chan, time, len, note, vel);
 }
 
 // CONST iterator implementations (x3)
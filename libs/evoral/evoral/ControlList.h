@@ -25,6 +25,7 @@
 
 #include <cassert>
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 #include <boost/pool/pool.hpp>
@@ -237,15 +238,13 @@ public:
 	}
 
 	/** Queries the event value at the given time (takes a read-lock, not safe
-	 * while writing automation).
+	 * while writing automation). The first call after the list was edited
+	 * takes the write-lock to rebuild the flat copy of the events.
 	 *
 	 * @param where absolute time in samples
 	 * @returns parameter value
 	 */
-	double eval (double where) const {
-		Glib::Threads::RWLock::ReaderLock lm (_lock);
-		return unlocked_eval (where);
-	}
+	double eval (double where) const;
 
 	/** Realtime safe version of eval(). This may fail if a read-lock cannot
 	 * be taken.
@@ -283,6 +282,25 @@ public:
 		ControlList::const_iterator first;
 	};
 
+	/** Flat copy of the event list: parallel arrays of event time, value
+	 * and list position, kept in sync with the list while it is not frozen.
+	 * Lookups binary-search the contiguous @a when array instead of walking
+	 * the list.  Only valid while holding (at least) a read-lock.
+	 */
+	struct FlatEvents {
+		FlatEvents () : valid (false) {}
+		std::vector<double>         when;
+		std::vector<double>         value;
+		std::vector<const_iterator> iter;
+		bool                        valid;
+
+		size_t size () const { return when.size (); }
+		/** @return index of the first event at or after @a x */
+		size_t lower_bound (double x) const;
+		/** @return index of the first event after @a x */
+		size_t upper_bound (double x) const;
+	};
+
 	/** @return the list of events */
 	const EventList& events() const { return _events; }
 
@@ -290,6 +308,7 @@ public:
 	Glib::Threads::RWLock& lock()       const { return _lock; }
 	LookupCache& lookup_cache() const { return _lookup_cache; }
 	SearchCache& search_cache() const { return _search_cache; }
+	const FlatEvents& flat_events() const { return _flat_events; }
 
 	/** Called by locked entry point and various private
 	 * locations where we already hold the lock.
@@ -359,6 +378,7 @@ protected:
 
 	/** Called by unlocked_eval() to handle cases of 3 or more control points. */
 	double multipoint_eval (double x) const;
+	double flat_multipoint_eval (double x) const;
 
 	void build_search_cache_if_necessary (double start) const;
 
@@ -371,10 +391,16 @@ protected:
 
 	virtual void maybe_signal_changed ();
 
+	/** Called whenever the events change, including appends that keep
+	 *  the flat copy valid (see fast_simple_add()).
+	 */
+	virtual void events_changed () const {}
+
 	void _x_scale (double factor);
 
 	mutable LookupCache   _lookup_cache;
 	mutable SearchCache   _search_cache;
+	mutable FlatEvents    _flat_events;
 
 	mutable Glib::Threads::RWLock _lock;
 
@@ -397,6 +423,8 @@ private:
 
 	void unlocked_remove_duplicates ();
 	void unlocked_invalidate_insert_iterator ();
+	void unlocked_rebuild_flat_events () const;
+	void invalidate_lookup_caches () const;
 	void add_guard_point (double when, double offset);
 
 	bool is_sorted () const;
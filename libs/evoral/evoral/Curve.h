@@ -42,6 +42,8 @@ public:
 
 private:
 	double multipoint_eval (double x) const;
+	double flat_eval (size_t index, double x) const;
+	void render_segments (double lx, double dx, float* vec, int32_t veclen) const;
 
 	void _get_vector (double x0, double x1, float *arg, int32_t veclen) const;
 
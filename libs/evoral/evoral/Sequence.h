@@ -29,6 +29,7 @@
 #include <list>
 #include <utility>
 #include <boost/shared_ptr.hpp>
+#include <boost/pool/pool_alloc.hpp>
 #include <glibmm/threads.h>
 
 #include "evoral/visibility.h"
@@ -220,6 +221,7 @@ public:
 
 private:
 	typedef std::priority_queue<NotePtr, std::deque<NotePtr>, LaterNoteEndComparator> ActiveNotes;
+	typedef std::vector<NotePtr> NoteIndex;
 public:
 
 	/** Read iterator */
@@ -265,7 +267,7 @@ public:
 		MIDIMessageType                       _type;
 		bool                                  _is_end;
 		typename Sequence::ReadLock           _lock;
-		typename Notes::const_iterator        _note_iter;
+		typename NoteIndex::const_iterator    _note_iter;
 		typename SysExes::const_iterator      _sysex_iter;
 		typename PatchChanges::const_iterator _patch_change_iter;
 		ControlIterators                      _control_iters;
@@ -336,6 +338,9 @@ protected:
 private:
 	friend class const_iterator;
 
+	const NoteIndex& note_index () const;
+	NotePtr new_note (uint8_t chan, Time time, Time len, uint8_t note, uint8_t vel) const;
+
 	bool overlaps_unlocked (const NotePtr& ev, const NotePtr& ignore_this_note) const;
 	bool contains_unlocked (const NotePtr& ev) const;
 
@@ -352,6 +357,25 @@ private:
 
 	Notes        _notes;       // notes indexed by time
 	Pitches      _pitches[16]; // notes indexed by channel+pitch
+
+	/** _notes as a flat vector in the same order, which is what the
+	 * const_iterator walks. Edits only mark it dirty, it is rebuilt by
+	 * note_index() the next time an iterator is created. Notes must be
+	 * added and removed with add_note_unlocked()/remove_note_unlocked()
+	 * or set_notes(), changes made directly to notes() are not seen.
+	 */
+	mutable NoteIndex            _note_index;
+	mutable bool                 _note_index_dirty;
+	mutable Glib::Threads::Mutex _note_index_lock;
+
+	/** Notes created by the sequence itself (on load or copy) come from
+	 * a pool rather than individual heap allocations. The pool is a
+	 * singleton shared by all sequences and never returns its memory to
+	 * the system: the space of deleted notes is reused for new ones, but
+	 * the pool stays at its largest size until the program exits.
+	 */
+	typedef boost::fast_pool_allocator<Note<Time> > NoteAllocator;
+
 	SysExes      _sysexes;
 	PatchChanges _patch_changes;
 
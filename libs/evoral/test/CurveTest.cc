@@ -474,3 +474,58 @@ CurveTest::constrainedCubic ()
 		CPPUNIT_ASSERT_DOUBLES_EQUAL(v, g[x], 0.000008);
 	}
 }
+
+void
+CurveTest::ctrlListFlatEvents ()
+{
+	boost::shared_ptr<Evoral::ControlList> cl = TestCtrlList();
+	cl->set_interpolation (ControlList::Linear);
+
+	for (int i = 0; i < 1000; ++i) {
+		cl->fast_simple_add (i * 10.0, (i % 2) ? 1.0 : 0.0);
+	}
+
+	CPPUNIT_ASSERT (cl->flat_events().valid);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1000, cl->flat_events().size());
+
+	CPPUNIT_ASSERT_EQUAL (0.0, cl->unlocked_eval (-5.));
+	CPPUNIT_ASSERT_EQUAL (1.0, cl->unlocked_eval (4990.));
+	CPPUNIT_ASSERT_EQUAL (0.5, cl->unlocked_eval (4995.));
+	CPPUNIT_ASSERT_EQUAL (1.0, cl->unlocked_eval (99999.));
+
+	/* edits while frozen are flattened on thaw */
+	cl->freeze ();
+	cl->add (5.0, 0.75, false, false);
+	CPPUNIT_ASSERT (!cl->flat_events().valid);
+	cl->thaw ();
+	CPPUNIT_ASSERT (cl->flat_events().valid);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1001, cl->flat_events().size());
+	CPPUNIT_ASSERT_EQUAL (0.75, cl->unlocked_eval (5.));
+	CPPUNIT_ASSERT_EQUAL (0.375, cl->unlocked_eval (2.5));
+
+	double x, y;
+	CPPUNIT_ASSERT (cl->rt_safe_earliest_event_discrete_unlocked (4.0, x, y, true));
+	CPPUNIT_ASSERT_EQUAL (5.0, x);
+	CPPUNIT_ASSERT_EQUAL (0.75, y);
+	CPPUNIT_ASSERT (cl->rt_safe_earliest_event_discrete_unlocked (5.0, x, y, false));
+	CPPUNIT_ASSERT_EQUAL (10.0, x);
+	CPPUNIT_ASSERT (cl->rt_safe_earliest_event_discrete_unlocked (5000.0, x, y, false) == false);
+
+	/* edits outside of freeze/thaw only invalidate the flat copy,
+	 * the next eval() rebuilds it
+	 */
+	cl->add (15.0, 0.25, false, false);
+	CPPUNIT_ASSERT (!cl->flat_events().valid);
+	CPPUNIT_ASSERT_EQUAL (0.25, cl->unlocked_eval (15.));
+	CPPUNIT_ASSERT_EQUAL (0.25, cl->eval (15.));
+	CPPUNIT_ASSERT (cl->flat_events().valid);
+	CPPUNIT_ASSERT_EQUAL ((size_t) 1002, cl->flat_events().size());
+
+	/* vector and point evaluation agree */
+	float vec[1000];
+	cl->create_curve ();
+	cl->curve().get_vector (0, 9990, vec, 1000);
+	for (int i = 0; i < 1000; ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL (cl->unlocked_eval (i * 10.0), vec[i], 1e-6);
+	}
+}
@@ -20,7 +20,7 @@ SequenceTest::copyTest ()
 	DummyTypeMap map;
 	MySequence<Time> a(map);
 	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
-		a.notes().insert(*i);
+		a.add_note_unlocked(*i);
 	}
 
 	MySequence<Time> b(a);
@@ -83,7 +83,7 @@ SequenceTest::iteratorSeekTest ()
 	seq->clear();
 
 	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
-		seq->notes().insert(*i);
+		seq->add_note_unlocked(*i);
 	}
 
 	// Iterate over all notes
@@ -134,6 +134,53 @@ SequenceTest::iteratorSeekTest ()
 	CPPUNIT_ASSERT(i == j);
 }
 
+void
+SequenceTest::iteratorEditTest ()
+{
+	seq->clear();
+
+	for (Notes::const_iterator i = test_notes.begin(); i != test_notes.end(); ++i) {
+		seq->add_note_unlocked(*i);
+	}
+
+	size_t num_notes = 0;
+	for (Sequence<Time>::const_iterator i = seq->begin(); i != seq->end(); ++i) {
+		if (i->is_note_on()) {
+			++num_notes;
+		}
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(12), num_notes);
+
+	// Edits made between iterations must be seen by the next iterator
+	seq->remove_note_unlocked(test_notes[3]);
+	seq->remove_note_unlocked(test_notes[4]);
+	seq->add_note_unlocked(boost::shared_ptr<Note<Time> >(new Note<Time>(0, Time(350), Time(10), 100, 64)));
+
+	num_notes = 0;
+	Time last_time;
+	bool found_new = false;
+	for (Sequence<Time>::const_iterator i = seq->begin(); i != seq->end(); ++i) {
+		if (!i->is_note_on()) {
+			continue;
+		}
+		CPPUNIT_ASSERT(i->time() >= last_time);
+		CPPUNIT_ASSERT(i->note() != 64 + 3 && i->note() != 64 + 4);
+		if (i->note() == 100) {
+			CPPUNIT_ASSERT_EQUAL(Time(350), i->time());
+			found_new = true;
+		}
+		last_time = i->time();
+		++num_notes;
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(11), num_notes);
+	CPPUNIT_ASSERT(found_new);
+
+	// Seeking uses the same index
+	Sequence<Time>::const_iterator i = seq->begin(Time(300));
+	CPPUNIT_ASSERT(i->is_note_on());
+	CPPUNIT_ASSERT_EQUAL(Time(350), i->time());
+}
+
 void
 SequenceTest::controlInterpolationTest ()
 {
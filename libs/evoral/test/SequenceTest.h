@@ -120,6 +120,7 @@ class SequenceTest : public CppUnit::TestFixture
 	CPPUNIT_TEST (copyTest);
 	CPPUNIT_TEST (preserveEventOrderingTest);
 	CPPUNIT_TEST (iteratorSeekTest);
+	CPPUNIT_TEST (iteratorEditTest);
 	CPPUNIT_TEST (controlInterpolationTest);
 	CPPUNIT_TEST_SUITE_END ();
 
@@ -150,6 +151,7 @@ public:
 	void copyTest ();
 	void preserveEventOrderingTest ();
 	void iteratorSeekTest ();
+	void iteratorEditTest ();
 	void controlInterpolationTest ();
 
 private:
@@ -115,6 +115,12 @@ UI::UI (string application_name, string thread_name, int *argc, char ***argv)
 
 	attach_request_source ();
 
+	/* do not let a flood of requests (e.g. during automation playback)
+	 * starve redraws and user input
+	 */
+
+	set_request_time_budget (20000);
+
 	errors = new TextViewer (800,600);
 	errors->text().set_editable (false);
 	errors->text().set_name ("ErrorText");
@@ -24,6 +24,7 @@
 #include <unistd.h>
 #include <iostream>
 #include <algorithm>
+#include <set>
 
 #include "pbd/stacktrace.h"
 #include "pbd/abstract_ui.h"
@@ -69,6 +70,7 @@ Glib::Threads::Private<typename AbstractUI<R>::RequestBuffer> AbstractUI<R>::per
 template <typename RequestObject>
 AbstractUI<RequestObject>::AbstractUI (const string& name)
 	: BaseUI (name)
+	, _request_time_budget (0)
 {
 	void (AbstractUI<RequestObject>::*pmf)(pthread_t,string,uint32_t) = &AbstractUI<RequestObject>::register_thread;
 
@@ -200,12 +202,43 @@ AbstractUI<RequestObject>::get_request (RequestType rt)
 	return req;
 }
 
+template <typename RequestObject> void
+AbstractUI<RequestObject>::coalesce_requests (RequestBuffer* rb)
+{
+	/* mark all but the most recent of the queued requests that share a
+	 * coalescing key as superseded. The readable part of the ringbuffer
+	 * belongs to us (the reader), the writing thread does not touch it.
+	 * The flag is kept in the request itself, so this remains correct if
+	 * a request runs a recursive main loop that handles later requests.
+	 */
+	RequestBufferVector vec;
+	rb->get_read_vector (&vec);
+
+	if (vec.len[0] + vec.len[1] < 2) {
+		return;
+	}
+
+	std::set<uint64_t> seen;
+
+	for (int n = 1; n >= 0; --n) {
+		for (size_t k = vec.len[n]; k > 0; --k) {
+			RequestObject* req = &vec.buf[n][k - 1];
+			if (req->coalesce_key && !seen.insert (req->coalesce_key).second) {
+				req->superseded = true;
+			}
+		}
+	}
+}
+
 template <typename RequestObject> void
 AbstractUI<RequestObject>::handle_ui_requests ()
 {
 	RequestBufferMapIterator i;
 	RequestBufferVector vec;
 
+	const int64_t deadline = _request_time_budget > 0 ? g_get_monotonic_time () + _request_time_budget : 0;
+	bool out_of_time = false;
+
 	/* check all registered per-thread buffers first */
 	Glib::Threads::Mutex::Lock rbml (request_buffer_map_lock);
 
@@ -233,7 +266,11 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 
 	DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1 check %2 request buffers for requests\n", event_loop_name(), request_buffers.size()));
 
-	for (i = request_buffers.begin(); i != request_buffers.end(); ++i) {
+	for (i = request_buffers.begin(); i != request_buffers.end() && !out_of_time; ++i) {
+
+		if (!(*i).second->dead) {
+			coalesce_requests ((*i).second);
+		}
 
 		while (!(*i).second->dead) {
 
@@ -258,6 +295,9 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 				if (vec.buf[0]->invalidation && !vec.buf[0]->invalidation->valid ()) {
 					DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: skipping invalidated request\n", event_loop_name()));
 					rbml.release ();
+				} else if (vec.buf[0]->superseded) {
+					DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: skipping superseded request\n", event_loop_name()));
+					rbml.release ();
 				} else {
 
 					DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1: valid request, unlocking before calling\n", event_loop_name()));
@@ -284,7 +324,14 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 					vec.buf[0]->invalidation->unref ();
 				}
 				vec.buf[0]->invalidation = NULL;
+				vec.buf[0]->coalesce_key = 0;
+				vec.buf[0]->superseded = false;
 				i->second->increment_read_ptr (1);
+
+				if (deadline && g_get_monotonic_time () > deadline) {
+					out_of_time = true;
+					break;
+				}
 			}
 		}
 	}
@@ -314,7 +361,7 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 
 	/* and now, the generic request buffer. same rules as above apply */
 
-	while (!request_list.empty()) {
+	while (!request_list.empty() && !out_of_time) {
 		assert (rbml.locked ());
 		RequestObject* req = request_list.front ();
 		request_list.pop_front ();
@@ -365,9 +412,19 @@ AbstractUI<RequestObject>::handle_ui_requests ()
 		/* re-acquire the list lock so that we check again */
 
 		rbml.acquire();
+
+		if (deadline && g_get_monotonic_time () > deadline) {
+			out_of_time = true;
+		}
 	}
 
 	rbml.release ();
+
+	if (out_of_time) {
+		/* come back for the remaining requests in the next iteration */
+		DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 request time budget exceeded, deferring remaining requests\n", event_loop_name(), pthread_name()));
+		signal_new_request ();
+	}
 }
 
 template <typename RequestObject> void
@@ -415,6 +472,16 @@ AbstractUI<RequestObject>::send_request (RequestObject *req)
 			 */
 			DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 send heap request type %3 IR %4\n", event_loop_name(), pthread_name(), req->type, req->invalidation));
 			Glib::Threads::Mutex::Lock lm (request_buffer_map_lock);
+			if (req->coalesce_key) {
+				/* replace a pending request with the same key */
+				for (typename std::list<RequestObject*>::iterator r = request_list.begin(); r != request_list.end(); ++r) {
+					if ((*r)->coalesce_key == req->coalesce_key) {
+						delete *r;
+						request_list.erase (r);
+						break;
+					}
+				}
+			}
 			request_list.push_back (req);
 		}
 
@@ -428,6 +495,12 @@ AbstractUI<RequestObject>::send_request (RequestObject *req)
 
 template<typename RequestObject> void
 AbstractUI<RequestObject>::call_slot (InvalidationRecord* invalidation, const boost::function<void()>& f)
+{
+	call_slot_coalesced (invalidation, f, 0);
+}
+
+template<typename RequestObject> void
+AbstractUI<RequestObject>::call_slot_coalesced (InvalidationRecord* invalidation, const boost::function<void()>& f, uint64_t coalesce_key)
 {
 	if (caller_is_self()) {
 		DEBUG_TRACE (PBD::DEBUG::AbstractUI, string_compose ("%1/%2 direct dispatch of call slot via functor @ %3, invalidation %4\n", event_loop_name(), pthread_name(), &f, invalidation));
@@ -479,6 +552,13 @@ AbstractUI<RequestObject>::call_slot (InvalidationRecord* invalidation, const bo
 
 	req->invalidation = invalidation;
 
+	/* requests with the same (non-zero) key that are still pending when
+	 * this one is queued, will not be executed.
+	 */
+
+	req->coalesce_key = coalesce_key;
+	req->superseded = false;
+
 	send_request (req);
 }
 
@@ -61,12 +61,21 @@ public:
 
 	void register_thread (pthread_t, std::string, uint32_t num_requests);
 	void call_slot (EventLoop::InvalidationRecord*, const boost::function<void()>&);
+	void call_slot_coalesced (EventLoop::InvalidationRecord*, const boost::function<void()>&, uint64_t);
 	Glib::Threads::Mutex& slot_invalidation_mutex() { return request_buffer_map_lock; }
 
 	Glib::Threads::Mutex request_buffer_map_lock;
 
 	static void* request_buffer_factory (uint32_t num_requests);
 
+	/** Limit the time spent handling queued requests per main loop
+	 * iteration. Requests that are left over are handled in the next
+	 * iteration, after other event sources had a chance to run.
+	 *
+	 * @param usecs time budget in microseconds, 0: unlimited (default)
+	 */
+	void set_request_time_budget (int64_t usecs) { _request_time_budget = usecs; }
+
 protected:
 	struct RequestBuffer : public PBD::RingBufferNPT<RequestObject> {
 		bool dead;
@@ -99,9 +108,13 @@ protected:
 	RequestObject* get_request (RequestType);
 	void handle_ui_requests ();
 	void send_request (RequestObject *);
+	void coalesce_requests (RequestBuffer*);
 
 	virtual void do_request (RequestObject *) = 0;
 	PBD::ScopedConnection new_thread_connection;
+
+private:
+	int64_t _request_time_budget;
 };
 
 #endif /* __pbd_abstract_ui_h__ */
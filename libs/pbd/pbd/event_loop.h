@@ -79,8 +79,10 @@ public:
 		RequestType             type;
 		InvalidationRecord*     invalidation;
 		boost::function<void()> the_slot;
+		uint64_t                coalesce_key;
+		bool                    superseded;
 
-		BaseRequestObject() : invalidation (0) {}
+		BaseRequestObject() : invalidation (0), coalesce_key (0), superseded (false) {}
 		~BaseRequestObject() {
 			if (invalidation) {
 				invalidation->unref ();
@@ -89,6 +91,17 @@ public:
 	};
 
 	virtual void call_slot (InvalidationRecord*, const boost::function<void()>&) = 0;
+
+	/** Like call_slot(), but if a request queued with the same @a coalesce_key
+	 * is still pending, only the most recent one will be executed.
+	 * Use this for requests where only the latest state matters (e.g. a
+	 * control's "value changed" notification). Keys are unique per
+	 * connection, see Connection::next_coalesce_key(). The default
+	 * implementation does not coalesce.
+	 */
+	virtual void call_slot_coalesced (InvalidationRecord* ir, const boost::function<void()>& f, uint64_t coalesce_key) {
+		call_slot (ir, f);
+	}
 	virtual Glib::Threads::Mutex& slot_invalidation_mutex() = 0;
 
 	std::string event_loop_name() const { return _name; }
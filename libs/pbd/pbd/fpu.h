@@ -33,6 +33,8 @@ class LIBPBD_API FPU {
 		HasSSE2 = 0x8,
 		HasAVX = 0x10,
 		HasNEON = 0x20,
+		HasAVX512F = 0x40,
+		HasFMA = 0x80,
 	};
 
   public:
@@ -47,6 +49,8 @@ class LIBPBD_API FPU {
 	bool has_sse2 () const { return _flags & HasSSE2; }
 	bool has_avx () const { return _flags & HasAVX; }
 	bool has_neon () const { return _flags & HasNEON; }
+	bool has_avx512f () const { return _flags & HasAVX512F; }
+	bool has_fma () const { return _flags & HasFMA; }
 
   private:
 	Flags _flags;
@@ -86,6 +86,7 @@ LIBPBD_API int pbd_realtime_pthread_create (
 LIBPBD_API int  pbd_absolute_rt_priority (int policy, int priority);
 LIBPBD_API int  pbd_set_thread_priority (pthread_t, const int policy, int priority);
 LIBPBD_API bool pbd_mach_set_realtime_policy (pthread_t thread_id, double period_ns);
+LIBPBD_API int  pbd_set_thread_affinity (pthread_t, int cpu);
 
 namespace PBD {
 	LIBPBD_API extern void notify_event_loops_about_thread_creation (pthread_t, const std::string&, int requests = 256);
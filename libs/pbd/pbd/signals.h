@@ -26,6 +26,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #ifdef nil
 #undef nil
@@ -42,6 +43,7 @@
 
 #include "pbd/libpbd_visibility.h"
 #include "pbd/event_loop.h"
+#include "pbd/rcu.h"
 
 #ifndef NDEBUG
 #define DEBUG_PBD_SIGNAL_CONNECTIONS
@@ -80,7 +82,7 @@ protected:
 class LIBPBD_API Connection : public boost::enable_shared_from_this<Connection>
 {
 public:
-	Connection (SignalBase* b, PBD::EventLoop::InvalidationRecord* ir) : _signal (b), _invalidation_record (ir)
+	Connection (SignalBase* b, PBD::EventLoop::InvalidationRecord* ir) : _signal (b), _invalidation_record (ir), _connected (1)
 	{
 		if (_invalidation_record) {
 			_invalidation_record->ref ();
@@ -96,8 +98,15 @@ public:
 		}
 	}
 
+	/** @return false once disconnected, may be called from any thread */
+	bool connected () const
+	{
+		return g_atomic_int_get (const_cast<gint*> (&_connected));
+	}
+
 	void disconnected ()
 	{
+		g_atomic_int_set (&_connected, 0);
 		if (_invalidation_record) {
 			_invalidation_record->unref ();
 		}
@@ -106,16 +115,24 @@ public:
 	void signal_going_away ()
 	{
 		Glib::Threads::Mutex::Lock lm (_mutex);
+		g_atomic_int_set (&_connected, 0);
 		if (_invalidation_record) {
 			_invalidation_record->unref ();
 		}
 		_signal = 0;
 	}
 
+	/** @return a new, non-zero key for EventLoop::call_slot_coalesced().
+	 *  Unlike the address of a Connection, keys are never reused, so a
+	 *  request can not be superseded by one for a later connection.
+	 */
+	static uint64_t next_coalesce_key ();
+
 private:
         Glib::Threads::Mutex _mutex;
 	SignalBase* _signal;
 	PBD::EventLoop::InvalidationRecord* _invalidation_record;
+	gint _connected; /* intended for atomic access */
 };
 
 template<typename R>
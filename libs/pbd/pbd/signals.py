@@ -101,18 +101,25 @@ def signal(f, n, v):
     print("private:", file=f)
 
     print("""
-	/** The slots that this signal will call on emission */
-	typedef std::map<boost::shared_ptr<Connection>, slot_function_type> Slots;
-	Slots _slots;
+	/** The slots that this signal will call on emission, in the order
+	    they were connected. The list is never modified, connecting and
+	    disconnecting replace it, so that emission does not need to lock
+	    or copy it.
+	*/
+	typedef std::vector<std::pair<boost::shared_ptr<Connection>, boost::shared_ptr<slot_function_type> > > Slots;
+	SerializedRCUManager<Slots> _slots;
 """, file=f)
 
     print("public:", file=f)
     print("", file=f)
+    print("\tSignal%d () : _slots (new Slots) {}" % n, file=f)
+    print("", file=f)
     print("\t~Signal%d () {" % n, file=f)
 
     print("\t\tGlib::Threads::Mutex::Lock lm (_mutex);", file=f)
     print("\t\t/* Tell our connection objects that we are going away, so they don't try to call us */", file=f)
-    print("\t\tfor (%sSlots::const_iterator i = _slots.begin(); i != _slots.end(); ++i) {" % typename, file=f)
+    print("\t\tboost::shared_ptr<Slots> s = _slots.reader ();", file=f)
+    print("\t\tfor (%sSlots::const_iterator i = s->begin(); i != s->end(); ++i) {" % typename, file=f)
 
     print("\t\t\ti->first->signal_going_away ();", file=f)
     print("\t\t}", file=f)
@@ -129,6 +136,10 @@ def signal(f, n, v):
     print("\tstatic void compositor (%sboost::function<void(%s)> f, EventLoop* event_loop, EventLoop::InvalidationRecord* ir%s) {" % (typename, comma_separated(An), p), file=f)
     print("\t\tevent_loop->call_slot (ir, boost::bind (f%s));" % q, file=f)
     print("\t}", file=f)
+    print("", file=f)
+    print("\tstatic void coalescing_compositor (%sboost::function<void(%s)> f, EventLoop* event_loop, EventLoop::InvalidationRecord* ir, uint64_t key%s) {" % (typename, comma_separated(An), p), file=f)
+    print("\t\tevent_loop->call_slot_coalesced (ir, boost::bind (f%s), key);" % q, file=f)
+    print("\t}", file=f)
 
     print("""
 	/** Arrange for @a slot to be executed whenever this signal is emitted. 
@@ -218,6 +229,43 @@ def signal(f, n, v):
     print("\t\tc = _connect (ir, boost::bind (&compositor, slot, event_loop, ir%s));" % p, file=f)
     print("\t}", file=f)
 
+    print("""
+	/** Like connect(), except that if @a event_loop still has a request
+	 *  pending from an earlier emission of this signal for this connection,
+	 *  only the most recent one will be executed.
+	 *
+	 *  Only use this if @a slot does not depend on receiving every emission,
+	 *  e.g. a slot that displays the current value of a control.
+	 */
+
+	void connect_coalesced (ScopedConnectionList& clist,
+		      PBD::EventLoop::InvalidationRecord* ir,
+		      const slot_function_type& slot,
+		      PBD::EventLoop* event_loop) {
+
+		if (ir) {
+			ir->event_loop = event_loop;
+		}
+		boost::shared_ptr<Connection> c (new Connection (this, ir));
+""", file=f)
+    print("\t\tclist.add_connection (_add_slot (c, boost::bind (&coalescing_compositor, slot, event_loop, ir, Connection::next_coalesce_key ()%s)));" % p, file=f)
+    print("""	}
+
+	/** See notes for the ScopedConnectionList variant of this function. */
+
+	void connect_coalesced (ScopedConnection& sc,
+		      PBD::EventLoop::InvalidationRecord* ir,
+		      const slot_function_type& slot,
+		      PBD::EventLoop* event_loop) {
+
+		if (ir) {
+			ir->event_loop = event_loop;
+		}
+		boost::shared_ptr<Connection> c (new Connection (this, ir));
+""", file=f)
+    print("\t\tsc = _add_slot (c, boost::bind (&coalescing_compositor, slot, event_loop, ir, Connection::next_coalesce_key ()%s));" % p, file=f)
+    print("\t}", file=f)
+
     print("""
 	/** Emit this signal. This will cause all slots connected to it be executed
 	    in the order that they were connected (cross-thread issues may alter
@@ -230,34 +278,27 @@ def signal(f, n, v):
     else:
         print("\ttypename C::result_type operator() (%s)" % comma_separated(Anan), file=f)
     print("\t{", file=f)
-    print("\t\t/* First, take a copy of our list of slots as it is now */", file=f)
+    print("""		/* First, get a reference to our list of slots as it is now. This does
+		   not lock or allocate, connecting and disconnecting replace the list
+		   instead of modifying it.
+		*/""", file=f)
     print("", file=f)
-    print("\t\tSlots s;", file=f)
-    print("\t\t{", file=f)
-    print("\t\t\tGlib::Threads::Mutex::Lock lm (_mutex);", file=f)
-    print("\t\t\ts = _slots;", file=f)
-    print("\t\t}", file=f)
+    print("\t\tboost::shared_ptr<Slots> s = _slots.reader ();", file=f)
     print("", file=f)
     if not v:
         print("\t\tstd::list<R> r;", file=f)
-    print("\t\tfor (%sSlots::const_iterator i = s.begin(); i != s.end(); ++i) {" % typename, file=f)
+    print("\t\tfor (%sSlots::const_iterator i = s->begin(); i != s->end(); ++i) {" % typename, file=f)
     print("""
 			/* We may have just called a slot, and this may have resulted in
-			   disconnection of other slots from us.  The list copy means that
-			   this won't cause any problems with invalidated iterators, but we
-			   must check to see if the slot we are about to call is still on the list.
+			   disconnection of other slots from us.  The list we hold does not
+			   change, but we must check to see if the slot we are about to call
+			   is still connected.
 			*/
-			bool still_there = false;
-			{
-				Glib::Threads::Mutex::Lock lm (_mutex);
-				still_there = _slots.find (i->first) != _slots.end ();
-			}
-
-			if (still_there) {""", file=f)
+			if (i->first->connected ()) {""", file=f)
     if v:
-        print("\t\t\t\t(i->second)(%s);" % comma_separated(an), file=f)
+        print("\t\t\t\t(*i->second)(%s);" % comma_separated(an), file=f)
     else:
-        print("\t\t\t\tr.push_back ((i->second)(%s));" % comma_separated(an), file=f)
+        print("\t\t\t\tr.push_back ((*i->second)(%s));" % comma_separated(an), file=f)
     print("\t\t\t}", file=f)
     print("\t\t}", file=f)
     print("", file=f)
@@ -269,14 +310,12 @@ def signal(f, n, v):
 
     print("""
 	bool empty () const {
-		Glib::Threads::Mutex::Lock lm (_mutex);
-		return _slots.empty ();
+		return _slots.reader ()->empty ();
 	}
 """, file=f)
     print("""
 	bool size () const {
-		Glib::Threads::Mutex::Lock lm (_mutex);
-		return _slots.size ();
+		return _slots.reader ()->size ();
 	}
 """, file=f)
 
@@ -292,12 +331,20 @@ def signal(f, n, v):
     print("""
 	boost::shared_ptr<Connection> _connect (PBD::EventLoop::InvalidationRecord* ir, slot_function_type f)
 	{
-		boost::shared_ptr<Connection> c (new Connection (this, ir));
+		return _add_slot (boost::shared_ptr<Connection> (new Connection (this, ir)), f);
+	}
+
+	boost::shared_ptr<Connection> _add_slot (boost::shared_ptr<Connection> c, slot_function_type f)
+	{
+		boost::shared_ptr<slot_function_type> sf (new slot_function_type (f));
 		Glib::Threads::Mutex::Lock lm (_mutex);
-		_slots[c] = f;
+		{
+			RCUWriter<Slots> writer (_slots);
+			writer.get_copy ()->push_back (std::make_pair (c, sf));
+		}
 #ifdef DEBUG_PBD_SIGNAL_CONNECTIONS
                 if (_debug_connection) {
-                        std::cerr << "+++++++ CONNECT " << this << " size now " << _slots.size() << std::endl;
+                        std::cerr << "+++++++ CONNECT " << this << " size now " << _slots.reader ()->size() << std::endl;
                         PBD::stacktrace (std::cerr, 10);
                 }
 #endif
@@ -309,18 +356,25 @@ def signal(f, n, v):
 	{
 		{
 			Glib::Threads::Mutex::Lock lm (_mutex);
-    			_slots.erase (c);
+			RCUWriter<Slots> writer (_slots);
+			boost::shared_ptr<Slots> s = writer.get_copy ();
+			for (%sSlots::iterator i = s->begin(); i != s->end(); ++i) {
+				if (i->first == c) {
+					s->erase (i);
+					break;
+				}
+			}
     		}
 		c->disconnected ();
 #ifdef DEBUG_PBD_SIGNAL_CONNECTIONS
                	if (_debug_connection) {
-    			std::cerr << "------- DISCCONNECT " << this << " size now " << _slots.size() << std::endl;
+    			std::cerr << "------- DISCCONNECT " << this << " size now " << _slots.reader ()->size() << std::endl;
                         PBD::stacktrace (std::cerr, 10);
 		}
 #endif
 	}
 };    
-""", file=f)
+""" % typename, file=f)
 
 for i in range(0, 6):
     signal(f, i, False)
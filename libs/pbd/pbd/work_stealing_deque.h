@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2020 Ardour Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _pbd_work_stealing_deque_h_
+#define _pbd_work_stealing_deque_h_
+
+#include <cassert>
+#include <cstddef>
+#include <glib.h>
+#include <stdint.h>
+
+namespace PBD {
+
+/** Bounded lock free work-stealing deque
+ *
+ * A single owner thread pushes and pops at the bottom (LIFO),
+ * any number of other threads may steal from the top (FIFO).
+ *
+ * Based on "Dynamic Circular Work-Stealing Deque" by David Chase and
+ * Yossi Lev, without dynamic growth: the buffer has to be large enough
+ * to hold all items that can be queued at the same time.
+ *
+ * glib atomic operations imply a full memory barrier, which also
+ * provides the store-load ordering required by pop_back().
+ *
+ * reset() must only be called while no other thread accesses the deque.
+ */
+template <typename T>
+class /*LIBPBD_API*/ WorkStealingDeque
+{
+public:
+	WorkStealingDeque (size_t buffer_size = 8)
+		: _buffer (0)
+		, _buffer_mask (0)
+	{
+		reserve (buffer_size);
+	}
+
+	~WorkStealingDeque ()
+	{
+		delete[] _buffer;
+	}
+
+	void
+	reserve (size_t buffer_size)
+	{
+		size_t sz = 2;
+		while (sz < buffer_size) {
+			sz <<= 1;
+		}
+		if (_buffer_mask >= sz - 1) {
+			return;
+		}
+		delete[] _buffer;
+		_buffer      = new T[sz];
+		_buffer_mask = sz - 1;
+		reset ();
+	}
+
+	void
+	reset ()
+	{
+		g_atomic_int_set (&_top, 0);
+		g_atomic_int_set (&_bottom, 0);
+	}
+
+	/** owner only */
+	bool
+	push_back (T const& data)
+	{
+		gint b = g_atomic_int_get (&_bottom);
+		gint t = g_atomic_int_get (&_top);
+		if ((size_t)(b - t) > _buffer_mask) {
+			assert (0);
+			return false;
+		}
+		_buffer[b & _buffer_mask] = data;
+		g_atomic_int_set (&_bottom, b + 1);
+		return true;
+	}
+
+	/** owner only */
+	bool
+	pop_back (T& data)
+	{
+		gint b = g_atomic_int_get (&_bottom) - 1;
+		g_atomic_int_set (&_bottom, b);
+		gint t = g_atomic_int_get (&_top);
+
+		if (t > b) {
+			/* empty */
+			g_atomic_int_set (&_bottom, t);
+			return false;
+		}
+
+		data = _buffer[b & _buffer_mask];
+
+		if (t < b) {
+			/* more than one item left, no race with thieves */
+			return true;
+		}
+
+		/* last item, compete with thieves */
+		bool rv = g_atomic_int_compare_and_exchange (&_top, t, t + 1);
+		g_atomic_int_set (&_bottom, t + 1);
+		return rv;
+	}
+
+	/** any thread */
+	bool
+	steal (T& data)
+	{
+		gint t = g_atomic_int_get (&_top);
+		gint b = g_atomic_int_get (&_bottom);
+		if (t >= b) {
+			return false;
+		}
+		data = _buffer[t & _buffer_mask];
+		return g_atomic_int_compare_and_exchange (&_top, t, t + 1);
+	}
+
+	bool
+	empty () const
+	{
+		return g_atomic_int_get (&_top) >= g_atomic_int_get (&_bottom);
+	}
+
+private:
+	T*     _buffer;
+	size_t _buffer_mask;
+
+	/* keep the thieves' end and the owner's end on separate cache-lines */
+	volatile gint _top;
+	char          _pad[64 - sizeof (gint)];
+	volatile gint _bottom;
+
+	/* prevent copy construction */
+	WorkStealingDeque (WorkStealingDeque const&);
+	WorkStealingDeque& operator= (WorkStealingDeque const&);
+};
+
+} /* end namespace */
+
+#endif
@@ -338,6 +338,25 @@ pbd_set_thread_priority (pthread_t thread, const int policy, int priority)
 	return pthread_setschedparam (thread, SCHED_FIFO, &param);
 }
 
+/** Restrict the given thread to run on a single CPU core
+ * @return 0 on success, non-zero on error or if this is not supported
+ */
+int
+pbd_set_thread_affinity (pthread_t thread, int cpu)
+{
+#if defined __linux__ && !defined PLATFORM_WINDOWS
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		return -1;
+	}
+	cpu_set_t cpuset;
+	CPU_ZERO (&cpuset);
+	CPU_SET (cpu, &cpuset);
+	return pthread_setaffinity_np (thread, sizeof (cpu_set_t), &cpuset);
+#else
+	return -1;
+#endif
+}
+
 bool
 pbd_mach_set_realtime_policy (pthread_t thread_id, double period_ns)
 {
@@ -22,6 +22,16 @@
 
 using namespace PBD;
 
+static Glib::Threads::Mutex coalesce_key_lock;
+static uint64_t coalesce_key_counter = 0;
+
+uint64_t
+Connection::next_coalesce_key ()
+{
+	Glib::Threads::Mutex::Lock lm (coalesce_key_lock);
+	return ++coalesce_key_counter;
+}
+
 ScopedConnectionList::ScopedConnectionList()
 {
 }
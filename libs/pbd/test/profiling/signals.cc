@@ -0,0 +1,119 @@
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+#include <glib.h>
+#include <glibmm/threads.h>
+
+#include "pbd/pbd.h"
+#include "pbd/signals.h"
+
+using namespace std;
+
+/* Compare emitting a PBD::Signal with copying the slots and locking once
+ * per slot, as PBD::Signal used to do, for a range of subscriber counts.
+ *
+ * usage: signals [emissions]
+ */
+
+/** The previous implementation of PBD::Signal emission, which copies the
+ * slots and locks once per slot, for comparison.
+ */
+class LockingSignal0
+{
+public:
+	typedef boost::function<void()> slot_function_type;
+	typedef std::map<boost::shared_ptr<int>, slot_function_type> Slots;
+
+	void connect (slot_function_type const& f) {
+		Glib::Threads::Mutex::Lock lm (_mutex);
+		_slots[boost::shared_ptr<int> (new int)] = f;
+	}
+
+	void operator() () {
+		Slots s;
+		{
+			Glib::Threads::Mutex::Lock lm (_mutex);
+			s = _slots;
+		}
+		for (Slots::const_iterator i = s.begin(); i != s.end(); ++i) {
+			bool still_there = false;
+			{
+				Glib::Threads::Mutex::Lock lm (_mutex);
+				still_there = _slots.find (i->first) != _slots.end ();
+			}
+			if (still_there) {
+				(i->second)();
+			}
+		}
+	}
+
+private:
+	mutable Glib::Threads::Mutex _mutex;
+	Slots _slots;
+};
+
+static int N = 0;
+
+static void
+receiver ()
+{
+	++N;
+}
+
+static double
+elapsed (gint64 start)
+{
+	return (g_get_monotonic_time () - start) / 1e6;
+}
+
+int
+main (int argc, char* argv[])
+{
+	int emissions = 200000;
+	int const subscribers[] = { 1, 4, 16, 64 };
+
+	if (argc > 1) {
+		emissions = atoi (argv[1]);
+	}
+
+	if (emissions <= 0) {
+		cerr << "usage: signals [emissions]" << endl;
+		return 1;
+	}
+
+	PBD::init ();
+
+	cout << "Signal emissions per second:" << endl;
+
+	for (size_t n = 0; n < sizeof (subscribers) / sizeof (int); ++n) {
+
+		PBD::Signal0<void> s;
+		LockingSignal0 l;
+		PBD::ScopedConnectionList c;
+
+		for (int i = 0; i < subscribers[n]; ++i) {
+			s.connect_same_thread (c, boost::bind (&receiver));
+			l.connect (boost::bind (&receiver));
+		}
+
+		gint64 start = g_get_monotonic_time ();
+		for (int i = 0; i < emissions; ++i) {
+			l ();
+		}
+		double const locking = elapsed (start);
+
+		start = g_get_monotonic_time ();
+		for (int i = 0; i < emissions; ++i) {
+			s ();
+		}
+		double const rcu = elapsed (start);
+
+		cout << "  " << subscribers[n] << " slots: locking " << (emissions / locking)
+		     << " rcu " << (emissions / rcu) << endl;
+	}
+
+	PBD::cleanup ();
+
+	return 0;
+}
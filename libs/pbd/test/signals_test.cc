@@ -1,3 +1,7 @@
+#include <list>
+#include <vector>
+#include <pthread.h>
+
 #include <glibmm/thread.h>
 
 #include "signals_test.h"
@@ -89,3 +93,174 @@ SignalsTest::testScopedConnectionList ()
 
 	CPPUNIT_ASSERT_EQUAL (1, N);
 }
+
+class Disconnector {
+public:
+	Disconnector (Emitter* e) {
+		e->Fred.connect_same_thread (a, boost::bind (&Disconnector::first, this));
+		e->Fred.connect_same_thread (b, boost::bind (&Disconnector::second, this));
+	}
+
+	void first () {
+		++N;
+		b.disconnect ();
+	}
+
+	void second () {
+		++N;
+	}
+
+	PBD::ScopedConnection a;
+	PBD::ScopedConnection b;
+};
+
+void
+SignalsTest::testDisconnectDuringEmission ()
+{
+	Emitter* e = new Emitter;
+	Disconnector d (e);
+
+	/* slots are called in the order they were connected, so the second
+	 * one is disconnected before it would be called.
+	 */
+	N = 0;
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (1, N);
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (2, N);
+	delete e;
+}
+
+static gint threaded_count = 0;
+static gint threaded_running = 0;
+
+static void
+threaded_receiver ()
+{
+	g_atomic_int_inc (&threaded_count);
+}
+
+static void*
+connect_thread (void* arg)
+{
+	Emitter* e = static_cast<Emitter*> (arg);
+	for (int i = 0; i < 1000; ++i) {
+		PBD::ScopedConnection c;
+		e->Fred.connect_same_thread (c, boost::bind (&threaded_receiver));
+	}
+	g_atomic_int_set (&threaded_running, 0);
+	return 0;
+}
+
+void
+SignalsTest::testThreadedConnect ()
+{
+	/* emit while another thread connects and disconnects */
+	Emitter* e = new Emitter;
+	PBD::ScopedConnection c;
+	e->Fred.connect_same_thread (c, boost::bind (&threaded_receiver));
+
+	g_atomic_int_set (&threaded_count, 0);
+	g_atomic_int_set (&threaded_running, 1);
+
+	pthread_t thread;
+	CPPUNIT_ASSERT (pthread_create (&thread, 0, connect_thread, e) == 0);
+
+	int emissions = 0;
+	while (g_atomic_int_get (&threaded_running)) {
+		e->emit ();
+		++emissions;
+	}
+	pthread_join (thread, 0);
+
+	/* every emission called at least the permanent slot */
+	CPPUNIT_ASSERT (g_atomic_int_get (&threaded_count) >= emissions);
+
+	g_atomic_int_set (&threaded_count, 0);
+	e->emit ();
+	CPPUNIT_ASSERT_EQUAL (1, (int) g_atomic_int_get (&threaded_count));
+
+	c.disconnect ();
+	delete e;
+}
+
+/** An event loop that queues requests until run() is called, and replaces
+ * pending requests that have the same coalescing key.
+ */
+class QueueingLoop : public PBD::EventLoop
+{
+public:
+	QueueingLoop () : PBD::EventLoop ("test") {}
+
+	void call_slot (InvalidationRecord* ir, const boost::function<void()>& f) {
+		call_slot_coalesced (ir, f, 0);
+	}
+
+	void call_slot_coalesced (InvalidationRecord*, const boost::function<void()>& f, uint64_t key) {
+		if (key) {
+			for (Queue::iterator i = _queue.begin(); i != _queue.end(); ++i) {
+				if (i->first == key) {
+					_queue.erase (i);
+					break;
+				}
+			}
+		}
+		_queue.push_back (std::make_pair (key, f));
+	}
+
+	Glib::Threads::Mutex& slot_invalidation_mutex () { return _mutex; }
+
+	void run () {
+		Queue q;
+		q.swap (_queue);
+		for (Queue::iterator i = q.begin(); i != q.end(); ++i) {
+			i->second ();
+		}
+	}
+
+private:
+	typedef std::list<std::pair<uint64_t, boost::function<void()> > > Queue;
+	Queue _queue;
+	Glib::Threads::Mutex _mutex;
+};
+
+static void
+value_receiver (std::vector<int>* values, int v)
+{
+	values->push_back (v);
+}
+
+void
+SignalsTest::testCoalescedConnect ()
+{
+	QueueingLoop loop;
+	PBD::Signal1<void, int> s;
+	PBD::ScopedConnectionList clist;
+
+	std::vector<int> all;
+	std::vector<int> latest_a;
+	std::vector<int> latest_b;
+
+	s.connect (clist, MISSING_INVALIDATOR, boost::bind (&value_receiver, &all, _1), &loop);
+	s.connect_coalesced (clist, MISSING_INVALIDATOR, boost::bind (&value_receiver, &latest_a, _1), &loop);
+	s.connect_coalesced (clist, MISSING_INVALIDATOR, boost::bind (&value_receiver, &latest_b, _1), &loop);
+
+	for (int i = 1; i <= 3; ++i) {
+		s (i);
+	}
+	loop.run ();
+
+	/* every emission is delivered to the plain connection,
+	 * each coalesced connection only sees the last one
+	 */
+	CPPUNIT_ASSERT_EQUAL (3, (int) all.size ());
+	CPPUNIT_ASSERT_EQUAL (1, (int) latest_a.size ());
+	CPPUNIT_ASSERT_EQUAL (3, latest_a[0]);
+	CPPUNIT_ASSERT_EQUAL (1, (int) latest_b.size ());
+	CPPUNIT_ASSERT_EQUAL (3, latest_b[0]);
+
+	s (4);
+	loop.run ();
+	CPPUNIT_ASSERT_EQUAL (2, (int) latest_a.size ());
+	CPPUNIT_ASSERT_EQUAL (4, latest_a[1]);
+}
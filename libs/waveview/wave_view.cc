@@ -18,6 +18,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <cmath>
 
 #include <boost/scoped_array.hpp>
@@ -85,6 +86,7 @@ WaveView::WaveView (Canvas* c, boost::shared_ptr<ARDOUR::AudioRegion> region)
 	, _shape_independent (false)
 	, _logscaled_independent (false)
 	, _gradient_depth_independent (false)
+	, _rendered (false)
 	, _draw_image_in_gui_thread (false)
 	, _always_draw_image_in_gui_thread (false)
 {
@@ -98,6 +100,7 @@ WaveView::WaveView (Item* parent, boost::shared_ptr<ARDOUR::AudioRegion> region)
 	, _shape_independent (false)
 	, _logscaled_independent (false)
 	, _gradient_depth_independent (false)
+	, _rendered (false)
 	, _draw_image_in_gui_thread (false)
 	, _always_draw_image_in_gui_thread (false)
 {
@@ -266,21 +269,21 @@ WaveView::prepare_for_render (Rect const& area) const
 	required_props.set_sample_positions_from_pixel_offsets (image_start_pixel_offset,
 	                                                        image_end_pixel_offset);
 
-	if (!required_props.is_valid ()) {
+	if (!required_props.is_valid () || required_props.get_length_samples () == 0) {
 		return;
 	}
 
-	if (_image) {
-		if (_image->props.is_equivalent (required_props)) {
-			return;
-		} else {
-			// Image does not contain sample area required
+	samplecnt_t const tile_samples = tile_width_samples ();
+	samplepos_t const first_tile = required_props.get_sample_start () / tile_samples;
+	samplepos_t const last_tile = (required_props.get_sample_end () - 1) / tile_samples;
+
+	for (samplepos_t n = first_tile; n <= last_tile; ++n) {
+		WaveViewProperties const tile_props = tile_properties (n);
+		boost::shared_ptr<WaveViewImage> image = lookup_tile (tile_props);
+		if (!image || !image->finished ()) {
+			queue_draw_request (tile_props, image);
 		}
 	}
-
-	boost::shared_ptr<WaveViewDrawRequest> request = create_draw_request (required_props);
-
-	queue_draw_request (request);
 }
 
 bool
@@ -330,39 +333,40 @@ WaveView::get_item_and_draw_rect_in_window_coords (Rect const& canvas_rect, Rect
 }
 
 void
-WaveView::queue_draw_request (boost::shared_ptr<WaveViewDrawRequest> const& request) const
+WaveView::queue_draw_request (WaveViewProperties const& props, boost::shared_ptr<WaveViewImage> image) const
 {
 	// Don't enqueue any requests without a thread to dequeue them.
 	assert (WaveViewThreads::enabled());
 
-	if (!request || !request->is_valid()) {
+	if (!props.is_valid ()) {
 		return;
 	}
 
-	if (current_request) {
-		current_request->cancel ();
+	if (image && image->region.expired ()) {
+		/* the image was added by another WaveView of the same source,
+		 * whose region is gone, so it could never be drawn. Replace
+		 * it with one for our region. */
+		image.reset ();
 	}
 
-	boost::shared_ptr<WaveViewImage> cached_image =
-	    get_cache_group ()->lookup_image (request->image->props);
-
-	if (cached_image) {
-		// The image may not be finished at this point but that is fine, great in
-		// fact as it means it should only need to be drawn once.
-		request->image = cached_image;
-		current_request = request;
+	if (image) {
+		boost::shared_ptr<WaveViewDrawRequest> pending = image->request.lock ();
+		if (pending && !pending->stopped ()) {
+			// Already queued, possibly by another WaveView of the same source
+			pending->touch ();
+			return;
+		}
 	} else {
-		// now we can finally set an optimal image now that we are not using the
-		// properties for comparisons.
-		request->image->props.set_width_samples (optimal_image_width_samples ());
-
-		current_request = request;
-
+		image.reset (new WaveViewImage (_region, props));
 		// Add it to the cache so that other WaveViews can refer to the same image
-		get_cache_group()->add_image (current_request->image);
-
-		WaveViewThreads::enqueue_draw_request (current_request);
+		get_cache_group ()->add_image (image);
 	}
+
+	boost::shared_ptr<WaveViewDrawRequest> request (new WaveViewDrawRequest);
+	request->image = image;
+	image->request = request;
+
+	WaveViewThreads::enqueue_draw_request (request);
 }
 
 void
@@ -848,77 +852,61 @@ WaveView::draw_image (Cairo::RefPtr<Cairo::ImageSurface>& image, PeakData* peaks
 }
 
 samplecnt_t
-WaveView::optimal_image_width_samples () const
+WaveView::tile_width_samples () const
 {
-	/* Compute how wide the image should be in samples.
-	 *
-	 * The resulting image should be wider than the canvas width so that the
-	 * image does not have to be redrawn each time the canvas offset changes, but
-	 * drawing too much unnecessarily, for instance when zooming into the canvas
-	 * the part of the image that is outside of the visible canvas area may never
-	 * be displayed and will just increase apparent render time and reduce
-	 * responsiveness in non-threaded rendering and cause "flashing" waveforms in
-	 * threaded rendering mode.
-	 *
-	 * Another thing to consider is that if there are a number of waveforms on
-	 * the canvas that are the width of the canvas then we don't want to have to
-	 * draw the images for them all at once as it will cause a spike in render
-	 * time, or in threaded rendering mode it will mean all the draw requests will
-	 * the queued during the same sample/expose event. This issue can be
-	 * alleviated by using an element of randomness in selecting the image width.
-	 *
-	 * If the value of samples per pixel is less than 1/10th of a second, use
-	 * 1/10th of a second instead.
+	return std::max ((samplecnt_t) 1, (samplecnt_t) floor (tile_width_pixels () * _props->samples_per_pixel));
+}
+
+WaveViewProperties
+WaveView::tile_properties (samplepos_t n) const
+{
+	/* Tiles are aligned to the source, not the region, so that regions
+	 * using the same source can share them. Each tile is one pixel wider
+	 * than the grid so that there is no gap between neighbouring tiles
+	 * when their origins are rounded to device pixels.
 	 */
 
-	samplecnt_t canvas_width_samples = _canvas->visible_area().width() * _props->samples_per_pixel;
-	const samplecnt_t one_tenth_of_second = _region->session().sample_rate() / 10;
+	samplecnt_t const tile_samples = tile_width_samples ();
 
-	/* If zoomed in where a canvas item interects with the canvas area but
-	 * stretches for many pages either side, to avoid having draw all images when
-	 * the canvas scrolls by a page width the multiplier would have to be a
-	 * randomized amount centered around 3 times the visible canvas width, but
-	 * for other operations like zooming or even with a stationary playhead it is
-	 * a lot of extra drawing that can affect performance.
-	 *
-	 * So without making things too complicated with different widths for
-	 * different operations, try to use a width that is a balance and will work
-	 * well for scrolling(non-page width) so all the images aren't redrawn at the
-	 * same time but also faster for sequential zooming operations.
-	 *
-	 * Canvas items that don't intersect with the edges of the visible canvas
-	 * will of course only draw images that are the pixel width of the item.
-	 *
-	 * It is a perhaps a coincidence that these values are centered roughly
-	 * around the golden ratio but they did work well in my testing.
-	 */
-	const double min_multiplier = 1.4;
-	const double max_multiplier = 1.8;
+	WaveViewProperties props = *_props;
+	props.set_sample_offsets (n * tile_samples, (n + 1) * tile_samples + (samplecnt_t) ceil (_props->samples_per_pixel));
+	return props;
+}
 
-	/**
-	 * A combination of high resolution screens, high samplerates and high
-	 * zoom levels(1 sample per pixel) can cause 1/10 of a second(in
-	 * pixels) to exceed the cairo image size limit.
-	 */
-	const double cairo_image_limit = 32767.0;
-	const double max_image_width = cairo_image_limit / max_multiplier;
+boost::shared_ptr<WaveViewImage>
+WaveView::lookup_tile (WaveViewProperties const& props) const
+{
+	for (Tiles::const_iterator i = _tiles.begin (); i != _tiles.end (); ++i) {
+		if ((*i)->contains_image_with_properties (props)) {
+			return *i;
+		}
+	}
 
-	samplecnt_t max_width_samples = floor (max_image_width / _props->samples_per_pixel);
+	return get_cache_group ()->lookup_image (props);
+}
 
-	const samplecnt_t one_tenth_of_second_limited = std::min (one_tenth_of_second, max_width_samples);
+boost::shared_ptr<WaveViewImage>
+WaveView::render_tile (WaveViewProperties const& props, boost::shared_ptr<WaveViewImage> pending) const
+{
+	if (pending) {
+		/* a worker thread may be about to draw the same tile, but the image
+		 * cannot be shared while it does so.
+		 */
+		boost::shared_ptr<WaveViewDrawRequest> request = pending->request.lock ();
+		if (request) {
+			request->cancel ();
+		}
+	}
 
-	samplecnt_t new_sample_count = std::max (canvas_width_samples, one_tenth_of_second_limited);
+	boost::shared_ptr<WaveViewDrawRequest> const request = create_draw_request (props);
 
-	const double multiplier = g_random_double_range (min_multiplier, max_multiplier);
+	process_draw_request (request);
 
-	return new_sample_count * multiplier;
-}
+	if (!request->finished ()) {
+		return boost::shared_ptr<WaveViewImage> ();
+	}
 
-void
-WaveView::set_image (boost::shared_ptr<WaveViewImage> img) const
-{
-	get_cache_group ()->add_image (img);
-	_image = img;
+	return request->image;
 }
 
 void
@@ -1049,141 +1037,112 @@ WaveView::render (Rect const & area, Cairo::RefPtr<Cairo::Context> context) cons
 
 	assert (required_props.is_valid());
 
-	boost::shared_ptr<WaveViewImage> image_to_draw;
-
-	if (current_request) {
-		if (!current_request->image->props.is_equivalent (required_props)) {
-			// The WaveView properties may have been updated during recording between
-			// prepare_for_render and render calls and the new required props have
-			// different end sample value.
-			current_request->cancel ();
-			current_request.reset ();
-		} else if (current_request->finished ()) {
-			image_to_draw = current_request->image;
-			current_request.reset ();
-		}
-	} else {
-		// No current Request
+	if (required_props.get_length_samples () == 0) {
+		return;
 	}
 
-	if (!image_to_draw && _image) {
-		if (_image->props.is_equivalent (required_props)) {
-			// Image contains required properties
-			image_to_draw = _image;
-		} else {
-			// Image does not contain properties required
-		}
-	}
+	samplecnt_t const tile_samples = tile_width_samples ();
+	samplepos_t const first_tile = required_props.get_sample_start () / tile_samples;
+	samplepos_t const last_tile = (required_props.get_sample_end () - 1) / tile_samples;
 
-	if (!image_to_draw) {
-		image_to_draw = get_cache_group ()->lookup_image (required_props);
-		if (image_to_draw && !image_to_draw->finished ()) {
-			// Found equivalent but unfinished Image in cache
-			image_to_draw.reset ();
-		}
-	}
+	Tiles tiles;
+	bool missing = false;
 
-	if (!image_to_draw) {
-		// No existing image to draw
+	for (samplepos_t n = first_tile; n <= last_tile; ++n) {
 
-		boost::shared_ptr<WaveViewDrawRequest> const request = create_draw_request (required_props);
+		/* the part of the draw area covered by this tile. Both edges are
+		 * rounded to an exact pixel in device space the same way as the
+		 * image origin, so that neighbouring tiles neither overlap nor
+		 * leave a gap.
+		 */
 
-		if (draw_image_in_gui_thread ()) {
-			// now that we have to draw something, draw more than required.
-			request->image->props.set_width_samples (optimal_image_width_samples ());
+		double tile_x0 = self.x0 + (n * tile_samples - _props->region_start) / _props->samples_per_pixel;
+		double tile_x1 = self.x0 + ((n + 1) * tile_samples - _props->region_start) / _props->samples_per_pixel;
+		double y = self.y0;
 
-			process_draw_request (request);
+		context->user_to_device (tile_x0, y);
+		tile_x0 = floor (tile_x0);
+		context->device_to_user (tile_x0, y);
 
-			image_to_draw = request->image;
+		y = self.y0;
+		context->user_to_device (tile_x1, y);
+		tile_x1 = floor (tile_x1);
+		context->device_to_user (tile_x1, y);
 
-		} else if (current_request) {
-			if (current_request->finished ()) {
-				// There is a chance the request is now finished since checking above
-				image_to_draw = current_request->image;
-				current_request.reset ();
-			} else if (_canvas->get_microseconds_since_render_start () < 15000) {
-				current_request->cancel ();
-				current_request.reset ();
+		const double draw_start_pixel = max (draw.x0, tile_x0);
+		const double draw_end_pixel = min (draw.x1, tile_x1);
 
-				// Drawing image in GUI thread as we have time
+		if (draw_end_pixel <= draw_start_pixel) {
+			continue;
+		}
 
-				// now that we have to draw something, draw more than required.
-				request->image->props.set_width_samples (optimal_image_width_samples ());
+		WaveViewProperties const tile_props = tile_properties (n);
 
-				process_draw_request (request);
+		boost::shared_ptr<WaveViewImage> image_to_draw = lookup_tile (tile_props);
 
-				image_to_draw = request->image;
+		if (!image_to_draw || !image_to_draw->finished ()) {
+			// No existing image to draw
+
+			if (draw_image_in_gui_thread ()) {
+				image_to_draw = render_tile (tile_props, image_to_draw);
+			} else if (image_to_draw && !image_to_draw->request.expired () &&
+			           _canvas->get_microseconds_since_render_start () < 15000) {
+				// Drawing image in GUI thread as we have time
+				image_to_draw = render_tile (tile_props, image_to_draw);
 			} else {
-				// Waiting for current request to finish
-				redraw ();
-				return;
+				// Defer the rendering to another thread or perhaps render pass if
+				// a thread cannot generate it in time.
+				queue_draw_request (tile_props, image_to_draw);
+				image_to_draw.reset ();
 			}
-		} else {
-			// Defer the rendering to another thread or perhaps render pass if
-			// a thread cannot generate it in time.
-			queue_draw_request (request);
-			redraw ();
-			return;
 		}
-	}
 
-	/* reset this so that future missing images can be generated in a worker thread. */
-	_draw_image_in_gui_thread = false;
-
-	assert (image_to_draw);
-
-	/* compute the first pixel of the image that should be used when we
-	 * render the specified range.
-	 */
-
-	double image_origin_in_self_coordinates =
-	    (image_to_draw->props.get_sample_start () - _props->region_start) / _props->samples_per_pixel;
+		if (!image_to_draw) {
+			missing = true;
+			continue;
+		}
 
-	/* the image may only be a best-effort ... it may not span the entire
-	 * range requested, though it is guaranteed to cover the start. So
-	 * determine how many pixels we can actually draw.
-	 */
+		if (find (_tiles.begin (), _tiles.end (), image_to_draw) == _tiles.end ()) {
+			get_cache_group ()->add_image (image_to_draw);
+		}
 
-	const double draw_start_pixel = draw.x0;
-	const double draw_end_pixel = draw.x1;
+		tiles.push_back (image_to_draw);
 
-	double draw_width_pixels = draw_end_pixel - draw_start_pixel;
+		context->rectangle (draw_start_pixel, draw.y0, draw_end_pixel - draw_start_pixel, draw.height());
 
-	if (image_to_draw != _image) {
+		/* round image origin position to an exact pixel in device space to
+		 * avoid blurring
+		 */
 
-		/* the image is guaranteed to start at or before
-		 * draw_start. But if it starts before draw_start, that reduces
-		 * the maximum available width we can render with.
-		 *
-		 * so .. clamp the draw width to the smaller of what we need to
-		 * draw or the available width of the image.
+		double x = self.x0 + (image_to_draw->props.get_sample_start () - _props->region_start) / _props->samples_per_pixel;
+		y = self.y0;
+		context->user_to_device (x, y);
+		x = floor (x);
+		y = floor (y);
+		context->device_to_user (x, y);
+
+		/* the coordinates specify where in "user coordinates" (i.e. what we
+		 * generally call "canvas coordinates" in this code) the image origin
+		 * will appear. So specifying (10,10) will put the upper left corner of
+		 * the image at (10,10) in user space.
 		 */
-		draw_width_pixels = min ((double)image_to_draw->cairo_image->get_width (), draw_width_pixels);
 
-		set_image (image_to_draw);
+		context->set_source (image_to_draw->cairo_image, x, y);
+		context->fill ();
 	}
 
-	context->rectangle (draw_start_pixel, draw.y0, draw_width_pixels, draw.height());
-
-	/* round image origin position to an exact pixel in device space to
-	 * avoid blurring
-	 */
+	/* reset this so that future missing images can be generated in a worker thread. */
+	_draw_image_in_gui_thread = false;
 
-	double x  = self.x0 + image_origin_in_self_coordinates;
-	double y  = self.y0;
-	context->user_to_device (x, y);
-	x = floor (x);
-	y = floor (y);
-	context->device_to_user (x, y);
-
-	/* the coordinates specify where in "user coordinates" (i.e. what we
-	 * generally call "canvas coordinates" in this code) the image origin
-	 * will appear. So specifying (10,10) will put the upper left corner of
-	 * the image at (10,10) in user space.
-	 */
+	if (!tiles.empty ()) {
+		_tiles.swap (tiles);
+		_rendered = true;
+	}
 
-	context->set_source (image_to_draw->cairo_image, x, y);
-	context->fill ();
+	if (missing) {
+		// Waiting for worker threads to draw the remaining tiles
+		redraw ();
+	}
 }
 
 void
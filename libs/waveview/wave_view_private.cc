@@ -99,6 +99,13 @@ WaveViewCacheGroup::add_image (boost::shared_ptr<WaveViewImage> image)
 			(*it)->timestamp = g_get_monotonic_time ();
 			return;
 		} else if ((*it)->props.is_equivalent (image->props)) {
+			if (!(*it)->finished () && (image->finished () || (*it)->region.expired ())) {
+				// Replacing unfinished equivalent Image, it was drawn elsewhere
+				// or can not be drawn since its region is gone
+				_parent_cache.decrease_size ((*it)->size_in_bytes ());
+				*it = image;
+				_parent_cache.increase_size (image->size_in_bytes ());
+			}
 			// Equivalent Image already in cache, updating timestamp
 			(*it)->timestamp = g_get_monotonic_time ();
 			return;
@@ -254,7 +261,9 @@ WaveViewCache::set_image_cache_threshold (uint64_t sz)
 
 /*-------------------------------------------------*/
 
-WaveViewDrawRequest::WaveViewDrawRequest () : stop (0)
+WaveViewDrawRequest::WaveViewDrawRequest ()
+	: stop (0)
+	, wanted (now_ms ())
 {
 
 }
@@ -305,9 +314,34 @@ WaveViewDrawRequestQueue::dequeue (bool block)
 
 	boost::shared_ptr<WaveViewDrawRequest> req;
 
-	if (!_queue.empty()) {
-		req = _queue.front ();
-		_queue.pop_front ();
+	/* Pick the request that was most recently wanted, the oldest of those
+	 * if there are several. Requests of WaveViews that are no longer
+	 * rendered (scrolled out of view, zoomed, removed) are not touched
+	 * anymore and are dropped here instead of being drawn.
+	 */
+	const gint now = WaveViewDrawRequest::now_ms ();
+	DrawRequestQueueType::iterator best = _queue.end ();
+
+	for (DrawRequestQueueType::iterator i = _queue.begin (); i != _queue.end ();) {
+		if (!*i) {
+			// wake up request, handled below
+			best = i;
+			break;
+		}
+		if ((*i)->stopped () || (*i)->age (now) > max_age ()) {
+			(*i)->cancel ();
+			i = _queue.erase (i);
+			continue;
+		}
+		if (best == _queue.end () || (*i)->age (now) < (*best)->age (now)) {
+			best = i;
+		}
+		++i;
+	}
+
+	if (best != _queue.end ()) {
+		req = *best;
+		_queue.erase (best);
 	} else {
 		// Queue empty, returning empty DrawRequest
 	}
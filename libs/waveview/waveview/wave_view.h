@@ -21,6 +21,8 @@
 #ifndef _WAVEVIEW_WAVE_VIEW_H_
 #define _WAVEVIEW_WAVE_VIEW_H_
 
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -70,6 +72,10 @@ public:
 	   never cleared until something explicitly marks the cache invalid
 	   (such as a change in samples_per_pixel, the log scaling, rectified or
 	   other view parameters).
+
+	   The sections are fixed size tiles on a grid that starts at the
+	   first sample of the source, so that the same tile can be used by
+	   all regions that share the source.
 	*/
 
 	WaveView (ArdourCanvas::Canvas*, boost::shared_ptr<ARDOUR::AudioRegion>);
@@ -165,7 +171,10 @@ private:
 
 	boost::scoped_ptr<WaveViewProperties> _props;
 
-	mutable boost::shared_ptr<WaveViewImage> _image;
+	typedef std::vector<boost::shared_ptr<WaveViewImage> > Tiles;
+
+	/** the tiles used by the most recent call to render() */
+	mutable Tiles _tiles;
 
 	mutable boost::shared_ptr<WaveViewCacheGroup> _cache_group;
 
@@ -186,9 +195,11 @@ private:
 	ARDOUR::samplepos_t region_end () const;
 
 	/**
-	 * _image stays non-null after the first time it is set
+	 * _rendered stays true after the first time a tile was drawn
 	 */
-	bool rendered () const { return _image.get(); }
+	bool rendered () const { return _rendered; }
+
+	mutable bool _rendered;
 
 	bool draw_image_in_gui_thread () const;
 
@@ -205,8 +216,6 @@ private:
 
 	void init();
 
-	mutable boost::shared_ptr<WaveViewDrawRequest> current_request;
-
 	PBD::ScopedConnectionList invalidation_connection;
 
 	static double _global_gradient_depth;
@@ -238,9 +247,19 @@ private:
 	                        boost::shared_ptr<WaveViewDrawRequest>);
 	static void draw_absent_image (Cairo::RefPtr<Cairo::ImageSurface>&, ARDOUR::PeakData*, int);
 
-	ARDOUR::samplecnt_t optimal_image_width_samples () const;
+	/** width of a tile in pixels, tiles at the end of a region may be shorter */
+	static double tile_width_pixels () { return 256.0; }
 
-	void set_image (boost::shared_ptr<WaveViewImage> img) const;
+	ARDOUR::samplecnt_t tile_width_samples () const;
+
+	/** @return the properties of tile @a n at the current zoom level, clamped to the region */
+	WaveViewProperties tile_properties (ARDOUR::samplepos_t n) const;
+
+	/** @return a finished or pending image for the tile or null */
+	boost::shared_ptr<WaveViewImage> lookup_tile (WaveViewProperties const&) const;
+
+	boost::shared_ptr<WaveViewImage> render_tile (WaveViewProperties const&,
+	                                              boost::shared_ptr<WaveViewImage> pending) const;
 
 	// @return true if item area intersects with draw area
 	bool get_item_and_draw_rect_in_window_coords (ArdourCanvas::Rect const& canvas_rect,
@@ -249,7 +268,11 @@ private:
 
 	boost::shared_ptr<WaveViewDrawRequest> create_draw_request (WaveViewProperties const&) const;
 
-	void queue_draw_request (boost::shared_ptr<WaveViewDrawRequest> const&) const;
+	/** Queue the image for @a props to be drawn by a worker thread, or move an
+	 * already queued request ahead of requests for tiles that are no longer
+	 * being displayed.
+	 */
+	void queue_draw_request (WaveViewProperties const&, boost::shared_ptr<WaveViewImage> image) const;
 
 	static void process_draw_request (boost::shared_ptr<WaveViewDrawRequest>);
 
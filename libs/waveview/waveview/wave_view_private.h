@@ -19,7 +19,7 @@
 #ifndef _WAVEVIEW_WAVE_VIEW_PRIVATE_H_
 #define _WAVEVIEW_WAVE_VIEW_PRIVATE_H_
 
-#include <deque>
+#include <list>
 
 #include "waveview/wave_view.h"
 
@@ -163,6 +163,8 @@ public: // methods
 	}
 };
 
+struct WaveViewDrawRequest;
+
 struct WaveViewImage {
 public: // ctors
 	WaveViewImage (boost::shared_ptr<const ARDOUR::AudioRegion> const& region_ptr,
@@ -176,6 +178,9 @@ public: // member variables
 	Cairo::RefPtr<Cairo::ImageSurface> cairo_image;
 	uint64_t timestamp;
 
+	/** the queued request that will draw this image, GUI thread only */
+	boost::weak_ptr<WaveViewDrawRequest> request;
+
 public: // methods
 	bool finished() { return static_cast<bool>(cairo_image); }
 
@@ -206,6 +211,14 @@ public:
 	void cancel() { g_atomic_int_set (&stop, 1); }
 	bool finished() { return image->finished(); }
 
+	/** mark the request as still wanted by a visible WaveView */
+	void touch () { g_atomic_int_set (&wanted, now_ms ()); }
+
+	/** @return milliseconds since the request was last wanted */
+	gint age (gint now) const { return now - g_atomic_int_get (const_cast<gint*>(&wanted)); }
+
+	static gint now_ms () { return (gint) (g_get_monotonic_time () / 1000); }
+
 	boost::shared_ptr<WaveViewImage> image;
 
 	bool is_valid () {
@@ -214,6 +227,7 @@ public:
 
 private:
 	gint stop; /* intended for atomic access */
+	gint wanted; /* intended for atomic access */
 };
 
 class WaveViewCache;
@@ -234,7 +248,7 @@ public:
 
 	bool full () const { return _cached_images.size() > max_size(); }
 
-	static uint32_t max_size () { return 16; }
+	static uint32_t max_size () { return 128; }
 
 	void clear_cache ();
 
@@ -293,9 +307,15 @@ public:
 
 	void enqueue (boost::shared_ptr<WaveViewDrawRequest>&);
 
-	// @return valid request or null if non-blocking or no request is available
+	/** @return the most recently wanted request or null if non-blocking or no
+	 * request is available. Requests that have not been wanted for
+	 * max_age() are cancelled and dropped, as their WaveView is no longer
+	 * rendered.
+	 */
 	boost::shared_ptr<WaveViewDrawRequest> dequeue (bool block);
 
+	static gint max_age () { return 500; /* ms */ }
+
 	void wake_up ();
 
 private:
@@ -303,7 +323,7 @@ private:
 	mutable Glib::Threads::Mutex _queue_mutex;
 	Glib::Threads::Cond _cond;
 
-	typedef std::deque<boost::shared_ptr<WaveViewDrawRequest> > DrawRequestQueueType;
+	typedef std::list<boost::shared_ptr<WaveViewDrawRequest> > DrawRequestQueueType;
 	DrawRequestQueueType _queue;
 };
 
@@ -990,7 +990,7 @@ ArdourButton::watch ()
 		warning << _("button cannot watch state of non-existing Controllable\n") << endmsg;
 		return;
 	}
-	c->Changed.connect (watch_connection, invalidator(*this), boost::bind (&ArdourButton::controllable_changed, this), gui_context());
+	c->Changed.connect_coalesced (watch_connection, invalidator(*this), boost::bind (&ArdourButton::controllable_changed, this), gui_context());
 }
 
 void